@@ -201,7 +201,8 @@ def run_cli():
 
     if args.accuracy_graph:
         for g in graphs[2:]:
-            draw_accuracy_graph(g)
+            if g['type'] in ('perf_test', 'error_test'):
+                draw_accuracy_graph(g)
 
 
 if __name__ == "__main__":
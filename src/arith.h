@@ -0,0 +1,37 @@
+#ifndef ARITH_H
+#define ARITH_H
+
+// elementwise math on half buffers. the halves are decoded to float, the math is done
+// in float and the result is rounded back to half once. a float has more than twice
+// the bits of a half, so add and mul give the correctly rounded half result, axpy and
+// lerp match the same expression done on float buffers.
+#define F16_OP_AXPY 0 // s * a + b, axpy passes x as a and y as both b and the result
+#define F16_OP_ADD  1 // a + b
+#define F16_OP_MUL  2 // a * b
+#define F16_OP_LERP 3 // a + s * (b - a)
+
+static inline float f16_arith_f32(float a, float b, float s, const int op)
+{
+    switch (op) {
+        case F16_OP_AXPY: return s * a + b;
+        case F16_OP_ADD:  return a + b;
+        case F16_OP_MUL:  return a * b;
+        default:          return a + s * (b - a);
+    }
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+
+static inline __m128 f16_arith_sse2(__m128 a, __m128 b, __m128 s, const int op)
+{
+    switch (op) {
+        case F16_OP_AXPY: return _mm_add_ps(_mm_mul_ps(s, a), b);
+        case F16_OP_ADD:  return _mm_add_ps(a, b);
+        case F16_OP_MUL:  return _mm_mul_ps(a, b);
+        default:          return _mm_add_ps(a, _mm_mul_ps(s, _mm_sub_ps(b, a)));
+    }
+}
+#endif
+
+#endif // ARITH_H
@@ -0,0 +1,61 @@
+#include "arith_sse2.h"
+#include <immintrin.h>
+#include "../ryg_sse2/sse2_cvtph_ps.h"
+#include "../maratyszcza_sse2/cvtps_ph_sse2.h"
+
+// decodes with the ryg_sse2 routine and encodes with the maratyszcza sse2 one,
+// the floats never leave registers
+
+static inline __m128i arith4(const uint16_t *a, const uint16_t *b, __m128 s, const int op)
+{
+    __m128 pa = sse2_cvtph_ps(_mm_loadl_epi64((const __m128i*)a));
+    __m128 pb = sse2_cvtph_ps(_mm_loadl_epi64((const __m128i*)b));
+    return cvtps_ph_sse2(f16_arith_sse2(pa, pb, s, op), _MM_FROUND_TO_NEAREST_INT);
+}
+
+static inline void arith_buffer(uint16_t *a, uint16_t *b, uint16_t *result, int data_size, float scale, const int op)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    __m128 s = _mm_set1_ps(scale);
+
+    for (int i = 0; i < size; i+=4) {
+        _mm_storel_epi64((__m128i*)(result + i), arith4(a + i, b + i, s, op));
+    }
+
+    if (remainder) {
+        uint16_t a_buf[4] = {0};
+        uint16_t b_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            a_buf[i] = a[size + i];
+            b_buf[i] = b[size + i];
+        }
+
+        _mm_storel_epi64((__m128i*)&out_buf[0], arith4(a_buf, b_buf, s, op));
+
+        for (int i = 0; i < remainder; i++) {
+            result[size + i] = out_buf[i];
+        }
+    }
+}
+
+void f16_axpy_buffer_sse2(uint16_t *x, uint16_t *y, int data_size, float a)
+{
+    arith_buffer(x, y, y, data_size, a, F16_OP_AXPY);
+}
+
+void f16_add_buffer_sse2(uint16_t *a, uint16_t *b, uint16_t *result, int data_size)
+{
+    arith_buffer(a, b, result, data_size, 0.0f, F16_OP_ADD);
+}
+
+void f16_mul_buffer_sse2(uint16_t *a, uint16_t *b, uint16_t *result, int data_size)
+{
+    arith_buffer(a, b, result, data_size, 0.0f, F16_OP_MUL);
+}
+
+void f16_lerp_buffer_sse2(uint16_t *a, uint16_t *b, uint16_t *result, int data_size, float t)
+{
+    arith_buffer(a, b, result, data_size, t, F16_OP_LERP);
+}
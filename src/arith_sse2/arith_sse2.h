@@ -0,0 +1,8 @@
+#include <stdint.h>
+#include "../arith.h"
+
+// elementwise math with halves in and out using only sse2, see hardware.h
+void f16_axpy_buffer_sse2(uint16_t *x, uint16_t *y, int data_size, float a);
+void f16_add_buffer_sse2(uint16_t *a, uint16_t *b, uint16_t *result, int data_size);
+void f16_mul_buffer_sse2(uint16_t *a, uint16_t *b, uint16_t *result, int data_size);
+void f16_lerp_buffer_sse2(uint16_t *a, uint16_t *b, uint16_t *result, int data_size, float t);
@@ -0,0 +1,203 @@
+#include "autotune.h"
+#include "common.h"
+#include "platform_info.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define MAX_LINE 1024
+
+// elements converted per kernel per size class while timing
+#define AUTOTUNE_ELEMENTS (1 << 22)
+#define AUTOTUNE_MIN_RUNS 3
+
+const int autotune_sizes[AUTOTUNE_SIZE_CLASSES] = {1024, 16384, 262144, 1920*1080*4};
+
+int autotune_size_class(int data_size)
+{
+    for (int i = 0; i < AUTOTUNE_SIZE_CLASSES - 1; i++) {
+        if (data_size <= autotune_sizes[i])
+            return i;
+    }
+    return AUTOTUNE_SIZE_CLASSES - 1;
+}
+
+void autotune_key(char *key, size_t key_size, const char *cpu, const char *build, const char **names, int count)
+{
+    uint32_t hash = 2166136261u;
+
+    // fnv-1a, the terminators keep "ab","c" apart from "a","bc"
+    for (int i = 0; i < count; i++) {
+        const char *p = names[i] ? names[i] : "";
+        do {
+            hash = (hash ^ (uint8_t)*p) * 16777619u;
+        } while (*p++);
+    }
+
+    snprintf(key, key_size, "%s build %s kernels %08x", cpu, build, hash);
+
+    // '|' separates the fields of a cache line
+    for (char *p = key; *p; p++) {
+        if (*p == '|')
+            *p = ' ';
+    }
+}
+
+static int find_kernel(const char **names, int count, const char *name)
+{
+    for (int i = 0; i < count; i++) {
+        if (names[i] && !strcmp(names[i], name))
+            return i;
+    }
+    return -1;
+}
+
+// cache lines look like "key|direction|size|kernel name"
+static int parse_line(char *line, char **key, char **direction, int *size, char **name)
+{
+    char *fields[4];
+
+    line[strcspn(line, "\r\n")] = 0;
+    fields[0] = line;
+
+    for (int i = 1; i < 4; i++) {
+        char *p = strchr(fields[i - 1], '|');
+        if (!p)
+            return -1;
+        *p = 0;
+        fields[i] = p + 1;
+    }
+
+    *key = fields[0];
+    *direction = fields[1];
+    *size = atoi(fields[2]);
+    *name = fields[3];
+    return 0;
+}
+
+int autotune_load(Autotune *tune, const char *cache_path, const char *key, const char *direction,
+                  const char **names, int count)
+{
+    char line[MAX_LINE];
+    int found = 0;
+    FILE *f = fopen(cache_path, "rb");
+    if (!f)
+        return -1;
+
+    tune->from_cache = 1;
+    for (int i = 0; i < AUTOTUNE_SIZE_CLASSES; i++) {
+        tune->winners[i] = -1;
+        tune->seconds[i] = 0.0;
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        char *k, *d, *name;
+        int size;
+        if (parse_line(line, &k, &d, &size, &name) || strcmp(k, key) || strcmp(d, direction))
+            continue;
+
+        for (int i = 0; i < AUTOTUNE_SIZE_CLASSES; i++) {
+            if (autotune_sizes[i] == size && tune->winners[i] < 0) {
+                tune->winners[i] = find_kernel(names, count, name);
+                found += tune->winners[i] >= 0;
+            }
+        }
+    }
+    fclose(f);
+
+    // a kernel may have been renamed or removed since the cache was written
+    return found == AUTOTUNE_SIZE_CLASSES ? 0 : -1;
+}
+
+int autotune_save(const Autotune *tune, const char *cache_path, const char *key, const char *direction,
+                  const char **names)
+{
+    char line[MAX_LINE];
+    char copy[MAX_LINE];
+    char *kept = NULL;
+    size_t kept_size = 0;
+    FILE *f;
+
+    // keep entries from other machines and directions
+    f = fopen(cache_path, "rb");
+    if (f) {
+        while (fgets(line, sizeof(line), f)) {
+            char *k, *d, *name;
+            int size;
+            strcpy(copy, line);
+            if (parse_line(copy, &k, &d, &size, &name) || (!strcmp(k, key) && !strcmp(d, direction)))
+                continue;
+
+            size_t len = strlen(line);
+            char *p = (char*)realloc(kept, kept_size + len + 1);
+            if (!p)
+                break;
+            kept = p;
+            memcpy(kept + kept_size, line, len + 1);
+            kept_size += len;
+        }
+        fclose(f);
+    }
+
+    f = fopen(cache_path, "wb");
+    if (!f) {
+        free(kept);
+        return -1;
+    }
+
+    if (kept)
+        fputs(kept, f);
+
+    for (int i = 0; i < AUTOTUNE_SIZE_CLASSES; i++) {
+        fprintf(f, "%s|%s|%d|%s\n", key, direction, autotune_sizes[i], names[tune->winners[i]]);
+    }
+
+    fclose(f);
+    free(kept);
+    return 0;
+}
+
+static double time_kernel(autotune_run_func run, void *ctx, int kernel, int size)
+{
+    uint64_t freq = get_timer_frequency();
+    int runs = MAX(AUTOTUNE_MIN_RUNS, AUTOTUNE_ELEMENTS / size);
+    double best = INFINITY;
+
+    // warm up
+    run(ctx, kernel, size);
+
+    for (int i = 0; i < runs; i++) {
+        uint64_t start = get_timer();
+        run(ctx, kernel, size);
+        double elapse = (double)(get_timer() - start) / (double)freq;
+        best = MIN(best, elapse);
+    }
+    return best;
+}
+
+int autotune_measure(Autotune *tune, const char **names, int count, autotune_run_func run, void *ctx)
+{
+    tune->from_cache = 0;
+    for (int i = 0; i < AUTOTUNE_SIZE_CLASSES; i++) {
+        tune->winners[i] = -1;
+        tune->seconds[i] = INFINITY;
+
+        for (int j = 0; j < count; j++) {
+            if (!names[j])
+                continue;
+
+            double elapse = time_kernel(run, ctx, j, autotune_sizes[i]);
+            if (elapse < tune->seconds[i]) {
+                tune->seconds[i] = elapse;
+                tune->winners[i] = j;
+            }
+        }
+
+        if (tune->winners[i] < 0)
+            return -1;
+    }
+
+    return 0;
+}
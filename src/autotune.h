@@ -0,0 +1,38 @@
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <stddef.h>
+
+#define AUTOTUNE_SIZE_CLASSES 4
+#define AUTOTUNE_DEFAULT_CACHE "f16_autotune.cache"
+
+extern const int autotune_sizes[AUTOTUNE_SIZE_CLASSES];
+
+// converts size elements with the kernel at index kernel
+typedef void (*autotune_run_func)(void *ctx, int kernel, int size);
+
+typedef struct Autotune {
+    int winners[AUTOTUNE_SIZE_CLASSES];
+    double seconds[AUTOTUNE_SIZE_CLASSES]; // 0 if the winner came from the cache
+    int from_cache;
+} Autotune;
+
+// the cache key for cpu, with a hash of the kernel names in order and the build
+// appended, so a cache written by another kernel set or build is measured again
+void autotune_key(char *key, size_t key_size, const char *cpu, const char *build, const char **names, int count);
+
+// reloads the fastest kernel per size class for key from cache_path.
+// returns 0 if every size class had a winner that is still in names
+int autotune_load(Autotune *tune, const char *cache_path, const char *key, const char *direction,
+                  const char **names, int count);
+
+// micro benchmarks every kernel with a name at each size class. returns 0 on success
+int autotune_measure(Autotune *tune, const char **names, int count, autotune_run_func run, void *ctx);
+
+// stores the winners, keeping cache entries for other keys and directions
+int autotune_save(const Autotune *tune, const char *cache_path, const char *key, const char *direction,
+                  const char **names);
+
+int autotune_size_class(int data_size);
+
+#endif // AUTOTUNE_H
@@ -0,0 +1,57 @@
+#include "bf16.h"
+
+typedef union {
+        uint32_t i;
+        float    f;
+} int_float;
+
+static inline uint16_t to_bf16_round(uint32_t u)
+{
+    if ((u & 0x7FFFFFFF) > 0x7F800000)
+        return (uint16_t)(u >> 16) | 0x0040;
+
+    // a carry out of the mantissa moves into the exponent, up to inf
+    return (uint16_t)((u + 0x7FFF + ((u >> 16) & 1)) >> 16);
+}
+
+uint16_t f32_to_bf16_truncate(float f)
+{
+    int_float value;
+    value.f = f;
+    return (uint16_t)(value.i >> 16);
+}
+
+void f32_to_bf16_buffer_truncate(uint32_t *data, uint16_t *result, int data_size)
+{
+    for (int i =0; i < data_size; i++) {
+        result[i] = (uint16_t)(data[i] >> 16);
+    }
+}
+
+uint16_t f32_to_bf16_round(float f)
+{
+    int_float value;
+    value.f = f;
+    return to_bf16_round(value.i);
+}
+
+void f32_to_bf16_buffer_round(uint32_t *data, uint16_t *result, int data_size)
+{
+    for (int i =0; i < data_size; i++) {
+        result[i] = to_bf16_round(data[i]);
+    }
+}
+
+float bf16_to_f32_scalar(uint16_t h)
+{
+    int_float value;
+    value.i = (uint32_t)h << 16;
+    return value.f;
+}
+
+void bf16_to_f32_buffer_scalar(uint16_t *data, uint32_t *result, int data_size)
+{
+    for (int i =0; i < data_size; i++) {
+        result[i] = (uint32_t)data[i] << 16;
+    }
+}
@@ -0,0 +1,19 @@
+#ifndef BF16_H
+#define BF16_H
+
+#include <stdint.h>
+
+// bfloat16 is the top 16 bits of a float32
+
+// drops the low 16 bits, nans with only low payload bits become inf
+uint16_t f32_to_bf16_truncate(float f);
+void f32_to_bf16_buffer_truncate(uint32_t *data, uint16_t *result, int data_size);
+
+// round to nearest even, nans keep their top payload bits and are made quiet
+uint16_t f32_to_bf16_round(float f);
+void f32_to_bf16_buffer_round(uint32_t *data, uint16_t *result, int data_size);
+
+float bf16_to_f32_scalar(uint16_t h);
+void bf16_to_f32_buffer_scalar(uint16_t *data, uint32_t *result, int data_size);
+
+#endif // BF16_H
@@ -0,0 +1,85 @@
+#include "bf16_avx2.h"
+#include <immintrin.h>
+
+// same as round_bf16_sse2 in bf16_sse2.c
+static inline __m256i round_bf16_avx2(__m256i u)
+{
+    __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(u, 16), _mm256_set1_epi32(1));
+    __m256i rounded = _mm256_add_epi32(u, _mm256_add_epi32(lsb, _mm256_set1_epi32(0x7FFF)));
+    __m256i abs = _mm256_and_si256(u, _mm256_set1_epi32(0x7FFFFFFF));
+    __m256i nan_mask = _mm256_cmpgt_epi32(abs, _mm256_set1_epi32(0x7F800000));
+    __m256i quiet_nan = _mm256_or_si256(u, _mm256_set1_epi32(0x00400000));
+
+    return _mm256_blendv_epi8(rounded, quiet_nan, nan_mask);
+}
+
+static inline __m256i cvtps_pbh_avx2(__m256i lo, __m256i hi)
+{
+    lo = _mm256_srai_epi32(round_bf16_avx2(lo), 16);
+    hi = _mm256_srai_epi32(round_bf16_avx2(hi), 16);
+    // lane fix up as in lut_avx2.c
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+uint16_t f32_to_bf16_avx2(float f)
+{
+    union { uint32_t i; float f; } value;
+    value.f = f;
+    return (uint16_t)_mm256_cvtsi256_si32(cvtps_pbh_avx2(_mm256_set1_epi32(value.i), _mm256_setzero_si256()));
+}
+
+void f32_to_bf16_buffer_avx2(uint32_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 16 * 16;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=16) {
+        __m256i lo = _mm256_loadu_si256((const __m256i*)data);
+        __m256i hi = _mm256_loadu_si256((const __m256i*)data + 1);
+        _mm256_storeu_si256((__m256i*)result, cvtps_pbh_avx2(lo, hi));
+
+        data += 16;
+        result += 16;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[16] = {0};
+        uint16_t out_buf[16] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        __m256i lo = _mm256_loadu_si256((const __m256i*)&in_buf[0]);
+        __m256i hi = _mm256_loadu_si256((const __m256i*)&in_buf[8]);
+        _mm256_storeu_si256((__m256i*)&out_buf[0], cvtps_pbh_avx2(lo, hi));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+float bf16_to_f32_avx2(uint16_t h)
+{
+    union { uint32_t i; float f; } value;
+    value.i = (uint32_t)h << 16;
+    return value.f;
+}
+
+void bf16_to_f32_buffer_avx2(uint16_t *data, uint32_t *result, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        __m256i h = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)data));
+        _mm256_storeu_si256((__m256i*)result, _mm256_slli_epi32(h, 16));
+
+        data += 8;
+        result += 8;
+    }
+
+    for (int i = 0; i < remainder; i++) {
+        result[i] = (uint32_t)data[i] << 16;
+    }
+}
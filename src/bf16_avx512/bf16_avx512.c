@@ -0,0 +1,43 @@
+#include "bf16_avx512.h"
+#include <immintrin.h>
+
+static inline __m256i cvtps_pbh_avx512(const uint32_t *data)
+{
+    return (__m256i)_mm512_cvtneps_pbh(_mm512_loadu_ps((const float*)data));
+}
+
+uint16_t f32_to_bf16_avx512(float f)
+{
+    uint32_t in_buf[16] = {0};
+    union { uint32_t i; float f; } value;
+    value.f = f;
+    in_buf[0] = value.i;
+    return (uint16_t)_mm256_cvtsi256_si32(cvtps_pbh_avx512(in_buf));
+}
+
+void f32_to_bf16_buffer_avx512(uint32_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 16 * 16;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=16) {
+        _mm256_storeu_si256((__m256i*)result, cvtps_pbh_avx512(data));
+
+        data += 16;
+        result += 16;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[16] = {0};
+        uint16_t out_buf[16] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        _mm256_storeu_si256((__m256i*)&out_buf[0], cvtps_pbh_avx512(in_buf));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
@@ -0,0 +1,5 @@
+#include <stdint.h>
+
+// vcvtneps2bf16, nearest even but denormal inputs and outputs are flushed to zero
+uint16_t f32_to_bf16_avx512(float f);
+void f32_to_bf16_buffer_avx512(uint32_t *data, uint16_t *result, int data_size);
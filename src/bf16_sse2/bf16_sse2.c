@@ -0,0 +1,85 @@
+#include "bf16_sse2.h"
+#include <emmintrin.h>
+
+// rounded but still in the top 16 bits of each lane
+static inline __m128i round_bf16_sse2(__m128i u)
+{
+    __m128i lsb = _mm_and_si128(_mm_srli_epi32(u, 16), _mm_set1_epi32(1));
+    __m128i rounded = _mm_add_epi32(u, _mm_add_epi32(lsb, _mm_set1_epi32(0x7FFF)));
+    __m128i abs = _mm_and_si128(u, _mm_set1_epi32(0x7FFFFFFF));
+    __m128i nan_mask = _mm_cmpgt_epi32(abs, _mm_set1_epi32(0x7F800000));
+    __m128i quiet_nan = _mm_or_si128(u, _mm_set1_epi32(0x00400000));
+
+    return _mm_or_si128(_mm_and_si128(nan_mask, quiet_nan), _mm_andnot_si128(nan_mask, rounded));
+}
+
+// the arithmetic shift keeps each lane in int16 range so the signed pack is exact
+static inline __m128i cvtps_pbh_sse2(__m128i lo, __m128i hi)
+{
+    lo = _mm_srai_epi32(round_bf16_sse2(lo), 16);
+    hi = _mm_srai_epi32(round_bf16_sse2(hi), 16);
+    return _mm_packs_epi32(lo, hi);
+}
+
+uint16_t f32_to_bf16_sse2(float f)
+{
+    union { uint32_t i; float f; } value;
+    value.f = f;
+    return (uint16_t)_mm_cvtsi128_si32(cvtps_pbh_sse2(_mm_set1_epi32(value.i), _mm_setzero_si128()));
+}
+
+void f32_to_bf16_buffer_sse2(uint32_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        __m128i lo = _mm_loadu_si128((const __m128i*)data);
+        __m128i hi = _mm_loadu_si128((const __m128i*)data + 1);
+        _mm_storeu_si128((__m128i*)result, cvtps_pbh_sse2(lo, hi));
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[8] = {0};
+        uint16_t out_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        __m128i lo = _mm_loadu_si128((const __m128i*)&in_buf[0]);
+        __m128i hi = _mm_loadu_si128((const __m128i*)&in_buf[4]);
+        _mm_storeu_si128((__m128i*)&out_buf[0], cvtps_pbh_sse2(lo, hi));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+float bf16_to_f32_sse2(uint16_t h)
+{
+    return _mm_cvtss_f32(_mm_castsi128_ps(_mm_unpacklo_epi16(_mm_setzero_si128(), _mm_set1_epi16(h))));
+}
+
+void bf16_to_f32_buffer_sse2(uint16_t *data, uint32_t *result, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+    __m128i zero = _mm_setzero_si128();
+
+    for (int i = 0; i < size; i+=8) {
+        __m128i h = _mm_loadu_si128((const __m128i*)data);
+        _mm_storeu_si128((__m128i*)result, _mm_unpacklo_epi16(zero, h));
+        _mm_storeu_si128((__m128i*)result + 1, _mm_unpackhi_epi16(zero, h));
+
+        data += 8;
+        result += 8;
+    }
+
+    for (int i = 0; i < remainder; i++) {
+        result[i] = (uint32_t)data[i] << 16;
+    }
+}
@@ -0,0 +1,8 @@
+#include <stdint.h>
+
+// same results as f32_to_bf16_round
+uint16_t f32_to_bf16_sse2(float f);
+void f32_to_bf16_buffer_sse2(uint32_t *data, uint16_t *result, int data_size);
+
+float bf16_to_f32_sse2(uint16_t h);
+void bf16_to_f32_buffer_sse2(uint16_t *data, uint32_t *result, int data_size);
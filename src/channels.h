@@ -0,0 +1,49 @@
+#ifndef CHANNELS_H
+#define CHANNELS_H
+
+#include <stdint.h>
+
+// channel masks for the f32_to_f16_channels_* kernels. the input is rgba
+// interleaved floats, the output only has the selected channels, still in rgba order
+#define F16_CHANNEL_R 1
+#define F16_CHANNEL_G 2
+#define F16_CHANNEL_B 4
+#define F16_CHANNEL_A 8
+#define F16_CHANNELS_RGB  (F16_CHANNEL_R | F16_CHANNEL_G | F16_CHANNEL_B)
+#define F16_CHANNELS_RGBA (F16_CHANNELS_RGB | F16_CHANNEL_A)
+
+static inline int f16_channel_count(int mask)
+{
+    return (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+}
+
+// X(mask, a, b, c, d) for every mask but 0 and rgba. a..d are the lanes of a pixel's
+// 4 halves to move to the front, the unused ones repeat the last channel
+#define F16_CHANNEL_SHUFFLES(X) \
+    X(1,  0, 0, 0, 0)           \
+    X(2,  1, 1, 1, 1)           \
+    X(3,  0, 1, 1, 1)           \
+    X(4,  2, 2, 2, 2)           \
+    X(5,  0, 2, 2, 2)           \
+    X(6,  1, 2, 2, 2)           \
+    X(7,  0, 1, 2, 2)           \
+    X(8,  3, 3, 3, 3)           \
+    X(9,  0, 3, 3, 3)           \
+    X(10, 1, 3, 3, 3)           \
+    X(11, 0, 1, 3, 3)           \
+    X(12, 2, 3, 3, 3)           \
+    X(13, 0, 2, 3, 3)           \
+    X(14, 1, 2, 3, 3)
+
+// packs the selected channels out of rgba halves
+static inline void f16_pack_channels(const uint16_t *data, uint16_t *result, int pixels, int mask)
+{
+    for (int i = 0; i < pixels; i++) {
+        for (int c = 0; c < 4; c++) {
+            if (mask & (1 << c))
+                *result++ = data[i * 4 + c];
+        }
+    }
+}
+
+#endif // CHANNELS_H
@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <assert.h>
+#include <string.h>
 
 #include "hardware/hardware.h"
 
@@ -79,4 +80,56 @@ void randomize_buffer_u16(uint16_t *data, size_t size, int real_only)
         }
     }
     printf("\r");
-}
\ No newline at end of file
+}
+
+void randomize_buffer_f64(uint64_t *data, size_t size)
+{
+    union { uint64_t u; double d; } v;
+
+    for (size_t i =0; i < size; i++) {
+        int_float f;
+        f.u = rand_u32_real() | (rand() & 1) << 31;
+        v.d = f.f;
+        v.u ^= rand_u32() & 0x1FFFFFFF;
+        data[i] = v.u;
+
+        if ((i % 20000000) == 0){
+            printf("\rrandomizing buffers: %4.1f%%", 100.0 * i/(double)size);
+            fflush(stdout);
+        }
+    }
+    printf("\r");
+}
+
+void guard_fill(void *data, size_t elem_size, int count)
+{
+    for (int i = 0; i < count; i++) {
+        switch (elem_size) {
+            case 1:  ((uint8_t*)data)[i] = GUARD_FILL_U8; break;
+            case 2:  ((uint16_t*)data)[i] = GUARD_FILL_U16; break;
+            default: ((uint32_t*)data)[i] = GUARD_FILL_U32; break;
+        }
+    }
+}
+
+uint32_t guard_check(const void *data, size_t elem_size, int count)
+{
+    uint32_t errors = 0;
+
+    for (int i = 0; i < count; i++) {
+        switch (elem_size) {
+            case 1:  errors += ((const uint8_t*)data)[i] != GUARD_FILL_U8; break;
+            case 2:  errors += ((const uint16_t*)data)[i] != GUARD_FILL_U16; break;
+            default: errors += ((const uint32_t*)data)[i] != GUARD_FILL_U32; break;
+        }
+    }
+    return errors;
+}
+
+void *alloc_perf_buffer(size_t size)
+{
+    void *p = malloc(size);
+    if (p)
+        memset(p, 0, size);
+    return p;
+}
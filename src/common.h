@@ -17,7 +17,30 @@ typedef union {
         float    f;
 } int_float;
 
+// the output checks write GUARD_COUNT elements past the end and check them after the
+// kernel ran, the fill is picked by element size so a kernel is unlikely to store it
+#define GUARD_COUNT 4
+#define GUARD_FILL_U8  0xA5
+#define GUARD_FILL_U16 0xA5A5
+#define GUARD_FILL_U32 0xDEADBEEF
+
+// the checks run every size from 0 to sizes_small, so each tail meets the start of
+// the buffer, then size_large. n goes from 0 to TAIL_TEST_COUNT(sizes_small) - 1
+#define TAIL_TEST_COUNT(sizes_small) ((sizes_small) + 2)
+#define TAIL_TEST_SIZE(n, sizes_small, size_large) ((n) <= (sizes_small) ? (n) : (size_large))
+
+// elem_size is 1, 2 or 4 bytes. guard_check returns how many of the count
+// elements no longer hold the fill
+void guard_fill(void *data, size_t elem_size, int count);
+uint32_t guard_check(const void *data, size_t elem_size, int count);
+
+// malloc for a buffer the perf runs write to, with its pages faulted in so the
+// first run doesn't pay for them. NULL if it fails
+void *alloc_perf_buffer(size_t size);
+
 void randomize_buffer_u32(uint32_t *data, size_t size, int real_only);
 void randomize_buffer_u16(uint16_t *data, size_t size, int real_only);
+// doubles inside the half range, with low bits a float would drop
+void randomize_buffer_f64(uint64_t *data, size_t size);
 
 #endif // COMMON_H
\ No newline at end of file
@@ -0,0 +1,124 @@
+#ifndef CONVERT_STATS_H
+#define CONVERT_STATS_H
+
+#include <stdint.h>
+#include <math.h>
+
+// what happened to the float32 values of one *_stats buffer conversion,
+// the classes use the same boundaries as test_hardware_accuracy
+typedef struct F16ConvertStats {
+    uint32_t nan;       // abs > 0x7f800000
+    uint32_t inf;       // +/-inf going in
+    uint32_t overflow;  // finite but abs > 0x477fefff, rounds to +/-inf
+    uint32_t underflow; // not zero but abs <= 0x33000000, rounds to +/-0
+    float min;          // smallest and largest finite value,
+    float max;          // INFINITY and -INFINITY if there were none
+} F16ConvertStats;
+
+static inline void f16_stats_init(F16ConvertStats *stats)
+{
+    stats->nan = 0;
+    stats->inf = 0;
+    stats->overflow = 0;
+    stats->underflow = 0;
+    stats->min = INFINITY;
+    stats->max = -INFINITY;
+}
+
+static inline void f16_stats_add(F16ConvertStats *stats, uint32_t v)
+{
+    union { uint32_t u; float f; } value;
+    uint32_t abs = v & 0x7FFFFFFF;
+
+    value.u = v;
+
+    if (abs > 0x7F800000) {
+        stats->nan++;
+    } else if (abs == 0x7F800000) {
+        stats->inf++;
+    } else {
+        stats->overflow += abs > 0x477FEFFF;
+        stats->underflow += abs != 0 && abs <= 0x33000000;
+        if (value.f < stats->min)
+            stats->min = value.f;
+        if (value.f > stats->max)
+            stats->max = value.f;
+    }
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+
+// per lane counters, the compare masks are -1 so subtracting them counts
+typedef struct F16StatsSSE2 {
+    __m128i nan;
+    __m128i inf;
+    __m128i overflow;
+    __m128i underflow;
+    __m128 min;
+    __m128 max;
+} F16StatsSSE2;
+
+static inline void f16_stats_sse2_init(F16StatsSSE2 *acc)
+{
+    acc->nan = _mm_setzero_si128();
+    acc->inf = _mm_setzero_si128();
+    acc->overflow = _mm_setzero_si128();
+    acc->underflow = _mm_setzero_si128();
+    acc->min = _mm_set1_ps(INFINITY);
+    acc->max = _mm_set1_ps(-INFINITY);
+}
+
+static inline void f16_stats_sse2_add(F16StatsSSE2 *acc, __m128 ps)
+{
+    __m128i abs = _mm_and_si128(_mm_castps_si128(ps), _mm_set1_epi32(0x7FFFFFFF));
+    __m128i inf_mask = _mm_cmpeq_epi32(abs, _mm_set1_epi32(0x7F800000));
+    __m128i nan_mask = _mm_cmpgt_epi32(abs, _mm_set1_epi32(0x7F800000));
+    __m128i finite_mask = _mm_cmplt_epi32(abs, _mm_set1_epi32(0x7F800000));
+    __m128i big_mask = _mm_cmpgt_epi32(abs, _mm_set1_epi32(0x477FEFFF));
+    __m128i tiny_mask = _mm_cmplt_epi32(abs, _mm_set1_epi32(0x33000001));
+    __m128i zero_mask = _mm_cmpeq_epi32(abs, _mm_setzero_si128());
+    __m128 finite = _mm_castsi128_ps(finite_mask);
+
+    acc->nan = _mm_sub_epi32(acc->nan, nan_mask);
+    acc->inf = _mm_sub_epi32(acc->inf, inf_mask);
+    acc->overflow = _mm_sub_epi32(acc->overflow, _mm_and_si128(big_mask, finite_mask));
+    acc->underflow = _mm_sub_epi32(acc->underflow, _mm_andnot_si128(zero_mask, tiny_mask));
+
+    // non finite lanes are swapped for a value that can't win
+    acc->min = _mm_min_ps(acc->min, _mm_or_ps(_mm_and_ps(finite, ps), _mm_andnot_ps(finite, _mm_set1_ps(INFINITY))));
+    acc->max = _mm_max_ps(acc->max, _mm_or_ps(_mm_and_ps(finite, ps), _mm_andnot_ps(finite, _mm_set1_ps(-INFINITY))));
+}
+
+static inline uint32_t f16_stats_sse2_hsum(__m128i v)
+{
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (uint32_t)_mm_cvtsi128_si32(v);
+}
+
+// folds the lanes into stats, which must already be initialized
+static inline void f16_stats_sse2_finish(const F16StatsSSE2 *acc, F16ConvertStats *stats)
+{
+    float lanes[4];
+
+    stats->nan += f16_stats_sse2_hsum(acc->nan);
+    stats->inf += f16_stats_sse2_hsum(acc->inf);
+    stats->overflow += f16_stats_sse2_hsum(acc->overflow);
+    stats->underflow += f16_stats_sse2_hsum(acc->underflow);
+
+    _mm_storeu_ps(lanes, acc->min);
+    for (int i = 0; i < 4; i++) {
+        if (lanes[i] < stats->min)
+            stats->min = lanes[i];
+    }
+
+    _mm_storeu_ps(lanes, acc->max);
+    for (int i = 0; i < 4; i++) {
+        if (lanes[i] > stats->max)
+            stats->max = lanes[i];
+    }
+}
+#endif
+
+#endif // CONVERT_STATS_H
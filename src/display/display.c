@@ -0,0 +1,168 @@
+#include "display.h"
+#include "../threads.h"
+#include "../static_table/static_table.h"
+#include <string.h>
+
+#define DISPLAY_MAX_THREADS 64
+
+uint8_t f16_display_srgb8[F16_DISPLAY_SIZE + F16_DISPLAY_PAD];
+static int display_ready = 0;
+
+typedef union {
+        uint32_t i;
+        float    f;
+} int_float;
+
+typedef union {
+        uint64_t i;
+        double   d;
+} int_double;
+
+// a^(1/n) for a > 0. the exponent divided by n gets within a few percent
+// and newton's method doubles the correct bits from there
+static double root(double a, int n)
+{
+    const uint64_t one = UINT64_C(0x3FF0000000000000);
+    int_double y;
+
+    y.d = a;
+    y.i = (uint64_t)((int64_t)(y.i - one) / n) + one;
+
+    for (int i = 0; i < 6; i++) {
+        double p = y.d;
+        for (int j = 2; j < n; j++) {
+            p *= y.d;
+        }
+        y.d = ((n - 1) * y.d + a / p) / n;
+    }
+    return y.d;
+}
+
+double f16_srgb_encode(double linear)
+{
+    if (linear <= 0.0031308)
+        return linear * 12.92;
+
+    // linear^(1/2.4) is the 12th root of linear^5
+    double l2 = linear * linear;
+    return 1.055 * root(l2 * l2 * linear, 12) - 0.055;
+}
+
+double f16_srgb_decode(double encoded)
+{
+    if (encoded <= 0.04045)
+        return encoded / 12.92;
+
+    // x^2.4 is x^2 times the 5th root of x^2
+    double x = (encoded + 0.055) / 1.055;
+    return x * x * root(x * x, 5);
+}
+
+// rounding to the nearest code is the same as counting the codes whose
+// halfway point below them the value has reached, found here in linear light
+void f16_display_init(void)
+{
+    double threshold[255];
+
+    if (display_ready)
+        return;
+
+    for (int k = 0; k < 255; k++) {
+        threshold[k] = f16_srgb_decode((k + 0.5) / 255.0);
+    }
+
+    for (int i = 0; i < F16_DISPLAY_SIZE; i++) {
+        int_float v;
+        int lo = 0;
+        int hi = 255;
+
+        v.i = f16_to_f32_static_table[i];
+        // nan fails every compare and ends up at 0 with the negatives
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if ((double)v.f >= threshold[mid])
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        f16_display_srgb8[i] = (uint8_t)lo;
+    }
+    memset(&f16_display_srgb8[F16_DISPLAY_SIZE], 0, F16_DISPLAY_PAD);
+
+    display_ready = 1;
+}
+
+void f16_to_srgb8_buffer(uint16_t *data, uint8_t *result, int data_size)
+{
+    const uint8_t *table = f16_display_srgb8;
+
+    for (int i = 0; i < data_size; i++) {
+        result[i] = table[data[i]];
+    }
+}
+
+typedef struct DisplayBand {
+    f16_to_u8_buffer_func func;
+    uint16_t *data;
+    int data_stride;
+    uint8_t *result;
+    int result_stride;
+    int width;
+    int y;
+    int height;
+} DisplayBand;
+
+static void apply_band(void *arg)
+{
+    DisplayBand *b = (DisplayBand*)arg;
+
+    for (int y = b->y; y < b->y + b->height; y++) {
+        b->func((uint16_t*)((uint8_t*)b->data + (size_t)y * b->data_stride),
+                b->result + (size_t)y * b->result_stride, b->width);
+    }
+}
+
+void f16_to_srgb8_rows(f16_to_u8_buffer_func func, uint16_t *data, int data_stride, uint8_t *result, int result_stride,
+                       int width, int height, int threads)
+{
+    Thread workers[DISPLAY_MAX_THREADS];
+    DisplayBand bands[DISPLAY_MAX_THREADS];
+    int started[DISPLAY_MAX_THREADS] = {0};
+    int rows;
+
+    if (threads < 1)
+        threads = 1;
+    if (threads > DISPLAY_MAX_THREADS)
+        threads = DISPLAY_MAX_THREADS;
+    if (threads > height)
+        threads = height > 0 ? height : 1;
+
+    // whole rows per thread, the first height % threads bands get one more
+    rows = height / threads;
+    for (int t = 0, y = 0; t < threads; t++) {
+        int h = rows + (t < height % threads);
+
+        bands[t].func = func;
+        bands[t].data = data;
+        bands[t].data_stride = data_stride;
+        bands[t].result = result;
+        bands[t].result_stride = result_stride;
+        bands[t].width = width;
+        bands[t].y = y;
+        bands[t].height = h;
+        y += h;
+    }
+
+    // if a thread can't be started its band is done here instead
+    for (int t = 0; t < threads - 1; t++) {
+        started[t] = thread_create(&workers[t], apply_band, &bands[t]) == 0;
+        if (!started[t])
+            apply_band(&bands[t]);
+    }
+    apply_band(&bands[threads - 1]);
+
+    for (int t = 0; t < threads - 1; t++) {
+        if (started[t])
+            thread_join(&workers[t]);
+    }
+}
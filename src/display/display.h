@@ -0,0 +1,31 @@
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include <stdint.h>
+
+// halves to 8 bit srgb for display through a table with an entry for every half,
+// like half2float_table.h but 64KB of bytes. nan and anything <= 0 give 0, anything
+// >= 1 gives 255, in between the srgb curve is rounded to the nearest code
+
+#define F16_DISPLAY_SIZE (UINT16_MAX + 1)
+// the avx2 gather reads 32 bits at each entry, the last entries read into the pad
+#define F16_DISPLAY_PAD 3
+
+extern uint8_t f16_display_srgb8[F16_DISPLAY_SIZE + F16_DISPLAY_PAD];
+
+typedef void (*f16_to_u8_buffer_func)(uint16_t *data, uint8_t *result, int data_size);
+
+// builds the table, it is only built once
+void f16_display_init(void);
+
+// the srgb transfer curve on [0, 1] in double without libm, the table is built from these
+double f16_srgb_encode(double linear);
+double f16_srgb_decode(double encoded);
+
+void f16_to_srgb8_buffer(uint16_t *data, uint8_t *result, int data_size);
+
+// splits the rows of an image over threads, width is in halves and strides are in bytes
+void f16_to_srgb8_rows(f16_to_u8_buffer_func func, uint16_t *data, int data_stride, uint8_t *result, int result_stride,
+                       int width, int height, int threads);
+
+#endif // DISPLAY_H
@@ -0,0 +1,49 @@
+#include "display_avx2.h"
+#include <immintrin.h>
+
+// the byte table is gathered 32 bits at a time from each index, the top
+// 3 bytes of each lane belong to the next entries and are masked off
+
+static inline __m256i gather8(const uint8_t *table, const uint16_t *data)
+{
+    __m256i index = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)data));
+    __m256i v = _mm256_i32gather_epi32((const int*)table, index, 1);
+    return _mm256_and_si256(v, _mm256_set1_epi32(0xFF));
+}
+
+static inline __m128i lookup16(const uint8_t *table, const uint16_t *data)
+{
+    __m256i lo = gather8(table, data);
+    __m256i hi = gather8(table, data + 8);
+    // lane fix up as in lut_avx2.c, the pack interleaves lo and hi per 128 bits
+    __m256i v = _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm_packus_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+}
+
+void f16_to_srgb8_buffer_avx2(uint16_t *data, uint8_t *result, int data_size)
+{
+    const uint8_t *table = f16_display_srgb8;
+    int size = data_size / 16 * 16;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=16) {
+        _mm_storeu_si128((__m128i*)result, lookup16(table, data));
+
+        data += 16;
+        result += 16;
+    }
+
+    if (remainder) {
+        uint16_t in_buf[16] = {0};
+        uint8_t out_buf[16] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        _mm_storeu_si128((__m128i*)&out_buf[0], lookup16(table, in_buf));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#include "display_sse41.h"
+#include <smmintrin.h>
+
+// sse4.1 has no gather, each half is pulled out with pextrw and its
+// table byte put in place with pinsrb, 16 at a time for one full store
+
+#define INSERT(v, index, i) _mm_insert_epi8(v, table[_mm_extract_epi16(index, (i) & 7)], i)
+
+static inline __m128i lookup16(const uint8_t *table, const uint16_t *data)
+{
+    __m128i lo = _mm_loadu_si128((const __m128i*)data);
+    __m128i hi = _mm_loadu_si128((const __m128i*)(data + 8));
+    __m128i v = _mm_setzero_si128();
+
+    v = INSERT(v, lo, 0);  v = INSERT(v, lo, 1);  v = INSERT(v, lo, 2);  v = INSERT(v, lo, 3);
+    v = INSERT(v, lo, 4);  v = INSERT(v, lo, 5);  v = INSERT(v, lo, 6);  v = INSERT(v, lo, 7);
+    v = INSERT(v, hi, 8);  v = INSERT(v, hi, 9);  v = INSERT(v, hi, 10); v = INSERT(v, hi, 11);
+    v = INSERT(v, hi, 12); v = INSERT(v, hi, 13); v = INSERT(v, hi, 14); v = INSERT(v, hi, 15);
+    return v;
+}
+
+void f16_to_srgb8_buffer_sse41(uint16_t *data, uint8_t *result, int data_size)
+{
+    const uint8_t *table = f16_display_srgb8;
+    int size = data_size / 16 * 16;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=16) {
+        _mm_storeu_si128((__m128i*)result, lookup16(table, data));
+
+        data += 16;
+        result += 16;
+    }
+
+    if (remainder) {
+        uint16_t in_buf[16] = {0};
+        uint8_t out_buf[16] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        _mm_storeu_si128((__m128i*)&out_buf[0], lookup16(table, in_buf));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
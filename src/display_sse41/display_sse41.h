@@ -0,0 +1,5 @@
+#include <stdint.h>
+#include "../display/display.h"
+
+// f16_to_srgb8_buffer with the table bytes inserted into a vector
+void f16_to_srgb8_buffer_sse41(uint16_t *data, uint8_t *result, int data_size);
@@ -0,0 +1,398 @@
+#include <string.h>
+
+#include "f16_registry.h"
+
+#include "hardware/hardware.h"
+#include "table/table.h"
+#include "table_round/table_round.h"
+#include "static_table/static_table.h"
+#include "no_table/no_table.h"
+#include "cpython/cpython.h"
+#include "numpy/numpy.h"
+#include "imath/imath.h"
+#include "tursa/tursa.h"
+#include "ryg/ryg.h"
+#include "maratyszcza/maratyszcza.h"
+#include "maratyszcza_nanfix/maratyszcza_nanfix.h"
+#include "stochastic/stochastic.h"
+#include "lut/lut.h"
+#include "display/display.h"
+#include "integer/integer.h"
+#include "representable/representable.h"
+#include "f64/f64.h"
+#include "bf16/bf16.h"
+
+#if defined(HAVE_VECTOR_EXT)
+#include "maratyszcza_vec/maratyszcza_vec.h"
+#include "ryg_vec/ryg_vec.h"
+#endif
+
+#if defined(ARCH_X86)
+#include "maratyszcza_sse2/maratyszcza_sse2.h"
+#include "ryg_sse2/ryg_sse2.h"
+#include "arith_sse2/arith_sse2.h"
+#include "maratyszcza_sse41/maratyszcza_sse41.h"
+#include "ryg_sse41/ryg_sse41.h"
+#include "stochastic_sse2/stochastic_sse2.h"
+#include "stochastic_avx2/stochastic_avx2.h"
+#include "f64_avx2/f64_avx2.h"
+#include "bf16_sse2/bf16_sse2.h"
+#include "bf16_avx2/bf16_avx2.h"
+#include "bf16_avx512/bf16_avx512.h"
+#include "lut_avx2/lut_avx2.h"
+#include "lut_avx512/lut_avx512.h"
+#include "display_sse41/display_sse41.h"
+#include "display_avx2/display_avx2.h"
+#include "integer_sse2/integer_sse2.h"
+#include "integer_avx2/integer_avx2.h"
+#include "representable_sse2/representable_sse2.h"
+#endif
+
+#if defined(ARCH_X86) || defined(__aarch64__)
+// aarch64 converts 8 per iteration, f16c 4
+#if defined(__aarch64__)
+#define HW_VECTOR_WIDTH 8
+#else
+#define HW_VECTOR_WIDTH 4
+#endif
+#define HW_F64_VECTOR_WIDTH 4
+#define HW_INPLACE_VECTOR_WIDTH 4
+#define HW_IMAGE_VECTOR_WIDTH 4
+#define HW_CHANNEL_VECTOR_WIDTH 2
+#define HW_SCALE_BIAS_VECTOR_WIDTH 4
+#define HW_REDUCE_VECTOR_WIDTH 4
+#define HW_ARITH_VECTOR_WIDTH 4
+#define HW_INTEGER_VECTOR_WIDTH 8
+#define HW_REPRESENTABLE_VECTOR_WIDTH 8
+#else
+#define HW_VECTOR_WIDTH 1
+#define HW_F64_VECTOR_WIDTH 1
+#define HW_INPLACE_VECTOR_WIDTH 1
+#define HW_IMAGE_VECTOR_WIDTH 1
+#define HW_CHANNEL_VECTOR_WIDTH 1
+#define HW_SCALE_BIAS_VECTOR_WIDTH 1
+#define HW_REDUCE_VECTOR_WIDTH 1
+#define HW_ARITH_VECTOR_WIDTH 1
+#define HW_INTEGER_VECTOR_WIDTH 1
+#define HW_REPRESENTABLE_VECTOR_WIDTH 1
+#endif
+
+#define F32_TO_F16(name, suffix, init, cpu_flags, rounding, nan, width) \
+    { name, F16_F32_TO_F16, f32_to_f16_##suffix, f32_to_f16_buffer_##suffix, NULL, NULL, init, cpu_flags, rounding, nan, width, NULL, NULL, NULL, NULL }
+
+// kernels that also have f32_to_f16_*_mode, f32_to_f16_buffer_*_special and _stats functions
+#define F32_TO_F16_MODE(name, suffix, init, cpu_flags, rounding, nan, width) \
+    { name, F16_F32_TO_F16, f32_to_f16_##suffix, f32_to_f16_buffer_##suffix, NULL, NULL, init, cpu_flags, rounding, nan, width, \
+      f32_to_f16_##suffix##_mode, f32_to_f16_buffer_##suffix##_mode, f32_to_f16_buffer_##suffix##_special, \
+      f32_to_f16_buffer_##suffix##_stats }
+
+#define F16_TO_F32(name, suffix, init, cpu_flags, width) \
+    { name, F16_F16_TO_F32, NULL, NULL, f16_to_f32_##suffix, f16_to_f32_buffer_##suffix, init, cpu_flags, F16_ROUND_EXACT, F16_NAN_HARDWARE, width, NULL, NULL, NULL, NULL }
+
+#define F32_TO_BF16(name, suffix, cpu_flags, rounding, nan, width) \
+    { name, F16_F32_TO_BF16, f32_to_bf16_##suffix, f32_to_bf16_buffer_##suffix, NULL, NULL, NULL, cpu_flags, rounding, nan, width, NULL, NULL, NULL, NULL }
+
+#define BF16_TO_F32(name, suffix, cpu_flags, width) \
+    { name, F16_BF16_TO_F32, NULL, NULL, bf16_to_f32_##suffix, bf16_to_f32_buffer_##suffix, NULL, cpu_flags, F16_ROUND_EXACT, F16_NAN_HARDWARE, width, NULL, NULL, NULL, NULL }
+
+// the count and select of a feature kernel list, see F16_KERNEL_LIST
+#define KERNEL_LIST_SELECT(type, list)                                                    \
+    const size_t list##_kernel_count = sizeof(list##_kernels) / sizeof(list##_kernels[0]); \
+                                                                                          \
+    size_t list##_kernel_select(unsigned int cpu_flags, const type **out, size_t max)     \
+    {                                                                                     \
+        size_t count = 0;                                                                 \
+        for (size_t i = 0; i < list##_kernel_count && count < max; i++) {                 \
+            if (f16_cpu_supported(list##_kernels[i].cpu_flags, cpu_flags))                \
+                out[count++] = &list##_kernels[i];                                        \
+        }                                                                                 \
+        return count;                                                                     \
+    }
+
+// benchmarks and accuracy reports list kernels in this order
+const F16Kernel f16_kernels[] =
+{
+    F32_TO_F16_MODE("hardware",            hw,                 NULL,             F16_CPU_F16C,  F16_ROUND_NEAREST_EVEN,   F16_NAN_HARDWARE, HW_VECTOR_WIDTH),
+#if defined(__aarch64__)
+    { "hardware scalar", F16_F32_TO_F16, f32_to_f16_hw, f32_to_f16_buffer_hw_scalar, NULL, NULL,
+      NULL, 0, F16_ROUND_NEAREST_EVEN, F16_NAN_HARDWARE, 1, NULL, NULL, NULL, NULL },
+#endif
+    F32_TO_F16("table no rounding",        table,              init_tables,      0,             F16_ROUND_TRUNCATE,       F16_NAN_UNSAFE,   1),
+    F32_TO_F16_MODE("table rounding",      table_round,        init_table_round, 0,             F16_ROUND_NEAREST_EVEN,   F16_NAN_HARDWARE, 1),
+    F32_TO_F16("no table",                 no_table,           NULL,             0,             F16_ROUND_NEAREST_EVEN,   F16_NAN_HARDWARE, 1),
+    F32_TO_F16("imath half",               imath,              NULL,             0,             F16_ROUND_NEAREST_EVEN,   F16_NAN_QUIET,    1),
+    F32_TO_F16("cpython",                  cpython,            NULL,             0,             F16_ROUND_NEAREST_APPROX, F16_NAN_QUIET,    1),
+    F32_TO_F16("numpy",                    numpy,              NULL,             0,             F16_ROUND_NEAREST_EVEN,   F16_NAN_QUIET,    1),
+    F32_TO_F16("tursa",                    tursa,              NULL,             0,             F16_ROUND_NEAREST_APPROX, F16_NAN_QUIET,    1),
+    F32_TO_F16("ryg",                      ryg,                NULL,             0,             F16_ROUND_NEAREST_EVEN,   F16_NAN_QUIET,    1),
+#if defined(ARCH_X86)
+    F32_TO_F16_MODE("ryg_sse2",            ryg_sse2,           NULL,             0,             F16_ROUND_NEAREST_EVEN,   F16_NAN_HARDWARE, 4),
+    F32_TO_F16("ryg_sse41",                ryg_sse41,          NULL,             F16_CPU_SSE41, F16_ROUND_NEAREST_EVEN,   F16_NAN_HARDWARE, 4),
+#endif
+    F32_TO_F16("maratyszcza",              maratyszcza,        NULL,             0,             F16_ROUND_NEAREST_EVEN,   F16_NAN_QUIET,    1),
+    F32_TO_F16("maratyszcza nan fix",      maratyszcza_nanfix, NULL,             0,             F16_ROUND_NEAREST_EVEN,   F16_NAN_HARDWARE, 1),
+#if defined(ARCH_X86)
+    F32_TO_F16_MODE("maratyszcza sse2",    maratyszcza_sse2,   NULL,             0,             F16_ROUND_NEAREST_EVEN,   F16_NAN_HARDWARE, 4),
+    F32_TO_F16("maratyszcza sse41",        maratyszcza_sse41,  NULL,             F16_CPU_SSE41, F16_ROUND_NEAREST_EVEN,   F16_NAN_HARDWARE, 4),
+#endif
+#if defined(HAVE_VECTOR_EXT)
+    F32_TO_F16("maratyszcza vec",          maratyszcza_vec,    NULL,             0,             F16_ROUND_NEAREST_EVEN,   F16_NAN_HARDWARE, VEC_LANES),
+#endif
+
+    F16_TO_F32("hardware",                 hw,                 NULL,             F16_CPU_F16C,  HW_VECTOR_WIDTH),
+#if defined(__aarch64__)
+    { "hardware scalar", F16_F16_TO_F32, NULL, NULL, f16_to_f32_hw, f16_to_f32_buffer_hw_scalar,
+      NULL, 0, F16_ROUND_EXACT, F16_NAN_HARDWARE, 1, NULL, NULL, NULL, NULL },
+#endif
+    { "static_table", F16_F16_TO_F32, NULL, NULL, f16_to_f32_static_table_func, f16_to_f32_buffer_static_table,
+      NULL, 0, F16_ROUND_EXACT, F16_NAN_HARDWARE, 1, NULL, NULL, NULL, NULL },
+    F16_TO_F32("table",                    table,              init_tables,      0,             1),
+    F16_TO_F32("imath",                    imath,              NULL,             0,             1),
+    F16_TO_F32("ryg",                      ryg,                NULL,             0,             1),
+#if defined(ARCH_X86)
+    F16_TO_F32("ryg_sse2",                 ryg_sse2,           NULL,             0,             4),
+    F16_TO_F32("ryg_sse41",                ryg_sse41,          NULL,             F16_CPU_SSE41, 4),
+#endif
+#if defined(HAVE_VECTOR_EXT)
+    F16_TO_F32("ryg_vec",                  ryg_vec,            NULL,             0,             VEC_LANES),
+#endif
+
+    F32_TO_BF16("bf16 truncate",           truncate,           0,                  F16_ROUND_TRUNCATE,       F16_NAN_UNSAFE, 1),
+    F32_TO_BF16("bf16 round",              round,              0,                  F16_ROUND_NEAREST_EVEN,   F16_NAN_QUIET,  1),
+#if defined(ARCH_X86)
+    F32_TO_BF16("bf16 sse2",               sse2,               0,                  F16_ROUND_NEAREST_EVEN,   F16_NAN_QUIET,  8),
+    F32_TO_BF16("bf16 avx2",               avx2,               F16_CPU_AVX2,       F16_ROUND_NEAREST_EVEN,   F16_NAN_QUIET,  16),
+    F32_TO_BF16("bf16 avx512",             avx512,             F16_CPU_AVX512BF16, F16_ROUND_NEAREST_APPROX, F16_NAN_QUIET,  16),
+#endif
+
+    BF16_TO_F32("bf16",                    scalar,             0,                  1),
+#if defined(ARCH_X86)
+    BF16_TO_F32("bf16 sse2",               sse2,               0,                  8),
+    BF16_TO_F32("bf16 avx2",               avx2,               F16_CPU_AVX2,       8),
+#endif
+};
+
+const size_t f16_kernel_count = sizeof(f16_kernels) / sizeof(f16_kernels[0]);
+
+const F16StochasticKernel f16_stochastic_kernels[] =
+{
+    {"stochastic",      f32_to_f16_buffer_stochastic,      0,            F16_STOCHASTIC_LANES},
+#if defined(ARCH_X86)
+    {"stochastic sse2", f32_to_f16_buffer_stochastic_sse2, 0,            F16_STOCHASTIC_LANES},
+    {"stochastic avx2", f32_to_f16_buffer_stochastic_avx2, F16_CPU_AVX2, F16_STOCHASTIC_LANES},
+#endif
+};
+
+KERNEL_LIST_SELECT(F16StochasticKernel, f16_stochastic)
+
+const F16DoubleKernel f16_double_kernels[] =
+{
+    {"f64",          f64_to_f16_buffer,          0,                           1},
+    {"f64 hardware", f64_to_f16_buffer_hw,       F16_CPU_F16C,                HW_F64_VECTOR_WIDTH},
+#if defined(ARCH_X86)
+    {"f64 ryg_sse2", f64_to_f16_buffer_ryg_sse2, 0,                           4},
+    {"f64 avx2",     f64_to_f16_buffer_avx2,     F16_CPU_AVX2 | F16_CPU_F16C, 8},
+#endif
+};
+
+KERNEL_LIST_SELECT(F16DoubleKernel, f16_double)
+
+const F16WidenKernel f16_widen_kernels[] =
+{
+    {"static_table", f16_to_f64_buffer_static_table, f16_to_i32_buffer_static_table, 0,            1},
+    {"hardware",     f16_to_f64_buffer_hw,           f16_to_i32_buffer_hw,           F16_CPU_F16C, HW_F64_VECTOR_WIDTH},
+#if defined(ARCH_X86)
+    {"ryg_sse2",     f16_to_f64_buffer_ryg_sse2,     f16_to_i32_buffer_ryg_sse2,     0,            4},
+#endif
+};
+
+KERNEL_LIST_SELECT(F16WidenKernel, f16_widen)
+
+const F16InplaceKernel f16_inplace_kernels[] =
+{
+    {"hardware",         f32_to_f16_buffer_hw_inplace,               f16_to_f32_buffer_hw_inplace,       F16_CPU_F16C, HW_INPLACE_VECTOR_WIDTH},
+#if defined(ARCH_X86)
+    {"maratyszcza sse2", f32_to_f16_buffer_maratyszcza_sse2_inplace, NULL,                               0,            4},
+    {"ryg_sse2",         f32_to_f16_buffer_ryg_sse2_inplace,         f16_to_f32_buffer_ryg_sse2_inplace, 0,            4},
+#endif
+};
+
+KERNEL_LIST_SELECT(F16InplaceKernel, f16_inplace)
+
+const F16ImageKernel f16_image_kernels[] =
+{
+    {"hardware",         f32_rgba_to_f16_planar_hw,               f16_planar_to_f32_rgba_hw,       F16_CPU_F16C, HW_IMAGE_VECTOR_WIDTH},
+#if defined(ARCH_X86)
+    {"maratyszcza sse2", f32_rgba_to_f16_planar_maratyszcza_sse2, NULL,                            0,            4},
+    {"ryg_sse2",         f32_rgba_to_f16_planar_ryg_sse2,         f16_planar_to_f32_rgba_ryg_sse2, 0,            4},
+#endif
+};
+
+KERNEL_LIST_SELECT(F16ImageKernel, f16_image)
+
+const F16ChannelKernel f16_channel_kernels[] =
+{
+    {"hardware",         f32_to_f16_channels_hw,               F16_CPU_F16C, HW_CHANNEL_VECTOR_WIDTH},
+#if defined(ARCH_X86)
+    {"maratyszcza sse2", f32_to_f16_channels_maratyszcza_sse2, 0,            2},
+#endif
+};
+
+KERNEL_LIST_SELECT(F16ChannelKernel, f16_channel)
+
+const F16ScaleBiasKernel f16_scale_bias_kernels[] =
+{
+    {"hardware",         f32_to_f16_buffer_hw_scale_bias,               f32_to_f16_buffer_hw_scale_bias4,               F16_CPU_F16C, HW_SCALE_BIAS_VECTOR_WIDTH},
+#if defined(ARCH_X86)
+    {"maratyszcza sse2", f32_to_f16_buffer_maratyszcza_sse2_scale_bias, f32_to_f16_buffer_maratyszcza_sse2_scale_bias4, 0,            4},
+#endif
+};
+
+KERNEL_LIST_SELECT(F16ScaleBiasKernel, f16_scale_bias)
+
+const F16ReduceKernel f16_reduce_kernels[] =
+{
+    {"hardware", f16_sum_buffer_hw,       f16_dot_buffer_hw,       f16_minmax_buffer_hw,       F16_CPU_F16C, HW_REDUCE_VECTOR_WIDTH},
+#if defined(ARCH_X86)
+    {"ryg_sse2", f16_sum_buffer_ryg_sse2, f16_dot_buffer_ryg_sse2, f16_minmax_buffer_ryg_sse2, 0,            4},
+#endif
+};
+
+KERNEL_LIST_SELECT(F16ReduceKernel, f16_reduce)
+
+const F16ArithKernel f16_arith_kernels[] =
+{
+    {"hardware", f16_axpy_buffer_hw,   f16_add_buffer_hw,   f16_mul_buffer_hw,   f16_lerp_buffer_hw,   F16_CPU_F16C, HW_ARITH_VECTOR_WIDTH},
+#if defined(ARCH_X86)
+    {"sse2",     f16_axpy_buffer_sse2, f16_add_buffer_sse2, f16_mul_buffer_sse2, f16_lerp_buffer_sse2, 0,            4},
+#endif
+};
+
+KERNEL_LIST_SELECT(F16ArithKernel, f16_arith)
+
+const F16LutKernel f16_lut_kernels[] =
+{
+    {"lut scalar", f16_lut_apply_f16,        f16_lut_apply_f32,        0,              1},
+#if defined(ARCH_X86)
+    {"lut avx2",   f16_lut_apply_f16_avx2,   f16_lut_apply_f32_avx2,   F16_CPU_AVX2,   8},
+    {"lut avx512", f16_lut_apply_f16_avx512, f16_lut_apply_f32_avx512, F16_CPU_AVX512, 16},
+#endif
+};
+
+KERNEL_LIST_SELECT(F16LutKernel, f16_lut)
+
+const F16DisplayKernel f16_display_kernels[] =
+{
+    {"display scalar", f16_to_srgb8_buffer,       0,             1},
+#if defined(ARCH_X86)
+    {"display sse41",  f16_to_srgb8_buffer_sse41, F16_CPU_SSE41, 16},
+    {"display avx2",   f16_to_srgb8_buffer_avx2,  F16_CPU_AVX2,  16},
+#endif
+};
+
+KERNEL_LIST_SELECT(F16DisplayKernel, f16_display)
+
+// only the gather beats the scalar table loop for u8, the others share it
+const F16IntegerKernel f16_integer_kernels[] =
+{
+    {"integer scalar", u8_to_f16_buffer,      u16_unorm_to_f16_buffer,      i16_to_f16_buffer,      0,                           1},
+    {"hardware",       u8_to_f16_buffer,      u16_unorm_to_f16_buffer_hw,   i16_to_f16_buffer_hw,   F16_CPU_F16C,                HW_INTEGER_VECTOR_WIDTH},
+#if defined(ARCH_X86)
+    {"sse2",           u8_to_f16_buffer,      u16_unorm_to_f16_buffer_sse2, i16_to_f16_buffer_sse2, 0,                           8},
+    {"avx2",           u8_to_f16_buffer_avx2, u16_unorm_to_f16_buffer_avx2, i16_to_f16_buffer_avx2, F16_CPU_AVX2 | F16_CPU_F16C, 8},
+#endif
+};
+
+KERNEL_LIST_SELECT(F16IntegerKernel, f16_integer)
+
+const F16RepresentableKernel f16_representable_kernels[] =
+{
+    {"representable scalar", f32_find_inexact_f16,      0,            1},
+    {"hardware",             f32_find_inexact_f16_hw,   F16_CPU_F16C, HW_REPRESENTABLE_VECTOR_WIDTH},
+#if defined(ARCH_X86)
+    {"sse2",                 f32_find_inexact_f16_sse2, 0,            8},
+#endif
+};
+
+KERNEL_LIST_SELECT(F16RepresentableKernel, f16_representable)
+
+unsigned int f16_cpu_flags(void)
+{
+#if defined(ARCH_X86)
+    CPUInfo info = {0};
+    get_cpu_info(&info);
+    return info.flags;
+#else
+    return 0;
+#endif
+}
+
+int f16_cpu_supported(unsigned int required, unsigned int cpu_flags)
+{
+    return (required & cpu_flags) == required;
+}
+
+int f16_kernel_supported(const F16Kernel *k, unsigned int cpu_flags)
+{
+    return f16_cpu_supported(k->cpu_flags, cpu_flags);
+}
+
+int f16_kernel_matches_hardware(const F16Kernel *k)
+{
+    return (k->rounding == F16_ROUND_NEAREST_EVEN || k->rounding == F16_ROUND_EXACT) && k->nan == F16_NAN_HARDWARE;
+}
+
+size_t f16_kernel_select(F16Direction direction, unsigned int cpu_flags, const F16Kernel **out, size_t max)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < f16_kernel_count && count < max; i++) {
+        const F16Kernel *k = &f16_kernels[i];
+        if (k->direction != direction || !f16_kernel_supported(k, cpu_flags))
+            continue;
+
+        // table modules share one init between both directions
+        int initialized = 0;
+        for (size_t j = 0; j < count; j++) {
+            if (out[j]->init == k->init)
+                initialized = 1;
+        }
+        if (k->init && !initialized)
+            k->init();
+
+        out[count++] = k;
+    }
+
+    return count;
+}
+
+const F16Kernel *f16_kernel_find(F16Direction direction, const char *name, unsigned int cpu_flags)
+{
+    for (size_t i = 0; i < f16_kernel_count; i++) {
+        const F16Kernel *k = &f16_kernels[i];
+        if (k->direction == direction && !strcmp(k->name, name))
+            return f16_kernel_supported(k, cpu_flags) ? k : NULL;
+    }
+    return NULL;
+}
+
+const char *f16_rounding_name(F16Rounding rounding)
+{
+    switch (rounding) {
+        case F16_ROUND_EXACT:          return "exact";
+        case F16_ROUND_NEAREST_EVEN:   return "nearest even";
+        case F16_ROUND_NEAREST_APPROX: return "nearest approx";
+        case F16_ROUND_TRUNCATE:       return "truncate";
+    }
+    return "unknown";
+}
+
+const char *f16_nan_name(F16NanMode nan)
+{
+    switch (nan) {
+        case F16_NAN_HARDWARE: return "hardware";
+        case F16_NAN_QUIET:    return "quiet";
+        case F16_NAN_UNSAFE:   return "unsafe";
+    }
+    return "unknown";
+}
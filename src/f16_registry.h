@@ -0,0 +1,255 @@
+#ifndef F16_REGISTRY_H
+#define F16_REGISTRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "platform_info.h"
+#include "round_mode.h"
+#include "convert_stats.h"
+
+#if defined(ARCH_X86)
+#include "x86_cpu_info.h"
+#define F16_CPU_F16C   X86_CPU_FLAG_F16C
+#define F16_CPU_SSE41  X86_CPU_FLAG_SSE4
+#define F16_CPU_AVX2   X86_CPU_FLAG_AVX2
+#define F16_CPU_AVX512 X86_CPU_FLAG_AVX512
+#define F16_CPU_AVX512BF16 X86_CPU_FLAG_AVX512BF16
+#else
+// arm builds always have their fp16 instructions, nothing to check
+#define F16_CPU_F16C   0
+#define F16_CPU_SSE41  0
+#define F16_CPU_AVX2   0
+#define F16_CPU_AVX512 0
+#define F16_CPU_AVX512BF16 0
+#endif
+
+// defined by the features that use them, see stochastic/stochastic.h and lut/lut.h
+struct F16StochasticState;
+struct F16Lut;
+
+// upper bound on kernels per direction, used to size per kernel result arrays
+#define F16_MAX_KERNELS 64
+
+typedef enum F16Direction {
+    F16_F32_TO_F16,
+    F16_F16_TO_F32,
+    // bfloat16 kernels reuse the f16 fields, the 16 bit values are bf16 instead
+    F16_F32_TO_BF16,
+    F16_BF16_TO_F32,
+} F16Direction;
+
+typedef enum F16Rounding {
+    F16_ROUND_EXACT,          // widening, every value is representable
+    F16_ROUND_NEAREST_EVEN,   // matches hardware
+    F16_ROUND_NEAREST_APPROX, // nearest, but some ties or overflows differ from hardware
+    F16_ROUND_TRUNCATE,       // mantissa bits are dropped
+} F16Rounding;
+
+typedef enum F16NanMode {
+    F16_NAN_HARDWARE,         // nan payload and sign match hardware
+    F16_NAN_QUIET,            // stays a nan but the payload can differ
+    F16_NAN_UNSAFE,           // some nans come out as +/-inf
+} F16NanMode;
+
+typedef struct F16Kernel {
+    const char *name;
+    F16Direction direction;
+    uint16_t (*f32_to_f16)(float v);
+    void (*f32_to_f16_buffer)(uint32_t *data, uint16_t *result, int data_size);
+    float (*f16_to_f32)(uint16_t h);
+    void (*f16_to_f32_buffer)(uint16_t *data, uint32_t *result, int data_size);
+    void (*init)(void);     // builds any tables, may be NULL
+    unsigned int cpu_flags; // cpu extensions needed to run the kernel
+    F16Rounding rounding;
+    F16NanMode nan;
+    int vector_width;       // elements converted per loop iteration
+    // selectable rounding, mode is one of F16_ROUND_TO_*, NULL if only nearest even
+    uint16_t (*f32_to_f16_mode)(float v, int mode);
+    void (*f32_to_f16_buffer_mode)(uint32_t *data, uint16_t *result, int data_size, int mode);
+    // nearest even with F16_SATURATE / F16_NAN_* flags fused in, NULL if not available
+    void (*f32_to_f16_buffer_special)(uint32_t *data, uint16_t *result, int data_size, int flags);
+    // nearest even that also counts nan, inf, overflow and underflow, NULL if not available
+    void (*f32_to_f16_buffer_stats)(uint32_t *data, uint16_t *result, int data_size, F16ConvertStats *stats);
+} F16Kernel;
+
+extern const F16Kernel f16_kernels[];
+extern const size_t f16_kernel_count;
+
+// true if the cpu has every extension in required. every kernel list checks support with it
+int f16_cpu_supported(unsigned int required, unsigned int cpu_flags);
+
+// the feature kernel lists below have a name, cpu_flags and vector_width like F16Kernel.
+// list_kernel_select fills out with the entries the cpu can run, in table order, and
+// returns how many there are, like f16_kernel_select
+#define F16_KERNEL_LIST(type, list)                \
+    extern const type list##_kernels[];            \
+    extern const size_t list##_kernel_count;       \
+    size_t list##_kernel_select(unsigned int cpu_flags, const type **out, size_t max)
+
+// stochastic rounding kernels carry a generator state, so they have their own list
+typedef struct F16StochasticKernel {
+    const char *name;
+    void (*f32_to_f16_buffer)(struct F16StochasticState *state, uint32_t *data, uint16_t *result, int data_size);
+    unsigned int cpu_flags;
+    int vector_width;
+} F16StochasticKernel;
+
+F16_KERNEL_LIST(F16StochasticKernel, f16_stochastic);
+
+// double to half kernels, all of them round once to nearest even
+typedef struct F16DoubleKernel {
+    const char *name;
+    void (*f64_to_f16_buffer)(uint64_t *data, uint16_t *result, int data_size);
+    unsigned int cpu_flags;
+    int vector_width;
+} F16DoubleKernel;
+
+F16_KERNEL_LIST(F16DoubleKernel, f16_double);
+
+// half to double and half to scaled int32 kernels
+typedef struct F16WidenKernel {
+    const char *name;
+    void (*f16_to_f64_buffer)(uint16_t *data, uint64_t *result, int data_size);
+    void (*f16_to_i32_buffer)(uint16_t *data, int32_t *result, int data_size, float scale);
+    unsigned int cpu_flags;
+    int vector_width;
+} F16WidenKernel;
+
+F16_KERNEL_LIST(F16WidenKernel, f16_widen);
+
+// kernels that convert over their input, data needs room for data_size uint32_t.
+// either function may be NULL if the kernel only has one direction
+typedef struct F16InplaceKernel {
+    const char *name;
+    void (*f32_to_f16_buffer_inplace)(uint32_t *data, int data_size);
+    void (*f16_to_f32_buffer_inplace)(uint16_t *data, int data_size);
+    unsigned int cpu_flags;
+    int vector_width;
+} F16InplaceKernel;
+
+F16_KERNEL_LIST(F16InplaceKernel, f16_inplace);
+
+// interleaved rgba f32 to 4 f16 planes and back in one pass, see image/image.h.
+// either function may be NULL if the kernel only has one direction
+typedef struct F16ImageKernel {
+    const char *name;
+    void (*f32_rgba_to_f16_planar)(uint32_t *data, int data_stride, uint16_t *planes[4], int plane_stride, int width, int height);
+    void (*f16_planar_to_f32_rgba)(uint16_t *planes[4], int plane_stride, uint32_t *result, int result_stride, int width, int height);
+    unsigned int cpu_flags;
+    int vector_width;       // pixels per loop iteration
+} F16ImageKernel;
+
+F16_KERNEL_LIST(F16ImageKernel, f16_image);
+
+// converts only some channels of rgba floats, mask is made of F16_CHANNEL_* from channels.h
+typedef struct F16ChannelKernel {
+    const char *name;
+    void (*f32_to_f16_channels)(uint32_t *data, uint16_t *result, int pixels, int mask);
+    unsigned int cpu_flags;
+    int vector_width;       // pixels per loop iteration
+} F16ChannelKernel;
+
+F16_KERNEL_LIST(F16ChannelKernel, f16_channel);
+
+// half(x * scale + bias) in the same pass as the conversion. the 4 version takes a
+// scale and bias per channel, element i uses scale[i % 4] and bias[i % 4]
+typedef struct F16ScaleBiasKernel {
+    const char *name;
+    void (*f32_to_f16_buffer_scale_bias)(uint32_t *data, uint16_t *result, int data_size, float scale, float bias);
+    void (*f32_to_f16_buffer_scale_bias4)(uint32_t *data, uint16_t *result, int data_size, const float scale[4], const float bias[4]);
+    unsigned int cpu_flags;
+    int vector_width;
+} F16ScaleBiasKernel;
+
+F16_KERNEL_LIST(F16ScaleBiasKernel, f16_scale_bias);
+
+// sums, dot products and min/max of half buffers without converting to a float buffer first,
+// mode is one of the F16_SUM_* values in reduce.h
+typedef struct F16ReduceKernel {
+    const char *name;
+    float (*f16_sum_buffer)(uint16_t *data, int data_size, int mode);
+    float (*f16_dot_buffer)(uint16_t *a, uint16_t *b, int data_size, int mode);
+    void (*f16_minmax_buffer)(uint16_t *data, int data_size, float *min, float *max);
+    unsigned int cpu_flags;
+    int vector_width;
+} F16ReduceKernel;
+
+F16_KERNEL_LIST(F16ReduceKernel, f16_reduce);
+
+// elementwise math with halves in and out, see arith.h
+typedef struct F16ArithKernel {
+    const char *name;
+    void (*f16_axpy_buffer)(uint16_t *x, uint16_t *y, int data_size, float a);
+    void (*f16_add_buffer)(uint16_t *a, uint16_t *b, uint16_t *result, int data_size);
+    void (*f16_mul_buffer)(uint16_t *a, uint16_t *b, uint16_t *result, int data_size);
+    void (*f16_lerp_buffer)(uint16_t *a, uint16_t *b, uint16_t *result, int data_size, float t);
+    unsigned int cpu_flags;
+    int vector_width;
+} F16ArithKernel;
+
+F16_KERNEL_LIST(F16ArithKernel, f16_arith);
+
+// applies a 65536 entry table built by f16_lut_build, see lut/lut.h
+typedef struct F16LutKernel {
+    const char *name;
+    void (*f16_lut_apply_f16)(const struct F16Lut *lut, uint16_t *data, uint16_t *result, int data_size);
+    void (*f16_lut_apply_f32)(const struct F16Lut *lut, uint16_t *data, uint32_t *result, int data_size);
+    unsigned int cpu_flags;
+    int vector_width;
+} F16LutKernel;
+
+F16_KERNEL_LIST(F16LutKernel, f16_lut);
+
+// halves to 8 bit srgb through the table built by f16_display_init, see display/display.h
+typedef struct F16DisplayKernel {
+    const char *name;
+    void (*f16_to_srgb8_buffer)(uint16_t *data, uint8_t *result, int data_size);
+    unsigned int cpu_flags;
+    int vector_width;
+} F16DisplayKernel;
+
+F16_KERNEL_LIST(F16DisplayKernel, f16_display);
+
+// 8 and 16 bit integer pixels to half, see integer/integer.h
+typedef struct F16IntegerKernel {
+    const char *name;
+    void (*u8_to_f16_buffer)(const uint16_t *table, uint8_t *data, uint16_t *result, int data_size);
+    void (*u16_unorm_to_f16_buffer)(uint16_t *data, uint16_t *result, int data_size);
+    void (*i16_to_f16_buffer)(int16_t *data, uint16_t *result, int data_size);
+    unsigned int cpu_flags;
+    int vector_width;
+} F16IntegerKernel;
+
+F16_KERNEL_LIST(F16IntegerKernel, f16_integer);
+
+// first float that does not survive a round trip through half, see representable/representable.h
+typedef struct F16RepresentableKernel {
+    const char *name;
+    int (*f32_find_inexact_f16)(uint32_t *data, int data_size);
+    unsigned int cpu_flags;
+    int vector_width;
+} F16RepresentableKernel;
+
+F16_KERNEL_LIST(F16RepresentableKernel, f16_representable);
+
+// cpu flags of the running machine, 0 on non x86
+unsigned int f16_cpu_flags(void);
+
+int f16_kernel_supported(const F16Kernel *k, unsigned int cpu_flags);
+
+// true if the kernel gives the same bits as hardware for every input: nearest even
+// (or exact when widening) with hardware nan payloads
+int f16_kernel_matches_hardware(const F16Kernel *k);
+
+// fills out with every kernel for the direction the cpu can run, in registry order,
+// runs their init functions and returns the number selected
+size_t f16_kernel_select(F16Direction direction, unsigned int cpu_flags, const F16Kernel **out, size_t max);
+
+// looks up a kernel by name, returns NULL if missing or unsupported
+const F16Kernel *f16_kernel_find(F16Direction direction, const char *name, unsigned int cpu_flags);
+
+const char *f16_rounding_name(F16Rounding rounding);
+const char *f16_nan_name(F16NanMode nan);
+
+#endif // F16_REGISTRY_H
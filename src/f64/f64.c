@@ -0,0 +1,68 @@
+#include "f64.h"
+#include "../no_table/no_table.h"
+
+typedef union {
+        uint64_t i;
+        double   d;
+} int_double;
+
+static inline uint16_t shift_round(uint64_t m, int shift)
+{
+    uint64_t q = m >> shift;
+    uint64_t rem = m & ((1ull << shift) - 1);
+    uint64_t half = 1ull << (shift - 1);
+
+    // nearest even, a carry out of the mantissa moves into the exponent
+    return (uint16_t)(q + (rem > half || (rem == half && (q & 1))));
+}
+
+static inline uint16_t to_f16(uint64_t u)
+{
+    uint16_t sign = (uint16_t)(u >> 48) & 0x8000;
+    uint64_t abs = u & 0x7FFFFFFFFFFFFFFFull;
+    uint64_t mantissa = abs & 0x000FFFFFFFFFFFFFull;
+    int e = (int)(abs >> 52) - 1023;
+
+    // nan keeps the top mantissa bits and is always quiet
+    if (abs > 0x7FF0000000000000ull)
+        return sign | 0x7E00 | (uint16_t)(mantissa >> 42);
+
+    // 65520 and up, including inf, is past the HALF_MAX tie
+    if (abs >= 0x40EFFE0000000000ull)
+        return sign | 0x7C00;
+
+    // normal, the exponent is added to the rounded mantissa so a carry bumps it
+    if (e >= -14)
+        return sign | shift_round(((uint64_t)(e + 15) << 52) | mantissa, 42);
+
+    // 2^-25 and below rounds to zero, 2^-25 itself is a tie with an even zero
+    if (e < -25)
+        return sign;
+
+    // denormal, value * 2^24 rounded to an integer
+    return sign | shift_round(mantissa | 0x0010000000000000ull, 28 - e);
+}
+
+uint16_t f64_to_f16(double d)
+{
+    int_double value;
+    value.d = d;
+    return to_f16(value.i);
+}
+
+void f64_to_f16_buffer(uint64_t *data, uint16_t *result, int data_size)
+{
+    for (int i = 0; i < data_size; i++) {
+        result[i] = to_f16(data[i]);
+    }
+}
+
+void f64_to_f16_buffer_two_pass(uint64_t *data, uint16_t *result, int data_size)
+{
+    int_double value;
+
+    for (int i = 0; i < data_size; i++) {
+        value.i = data[i];
+        result[i] = f32_to_f16_no_table((float)value.d);
+    }
+}
@@ -0,0 +1,14 @@
+#ifndef F64_H
+#define F64_H
+
+#include <stdint.h>
+
+// double to half rounded once, to nearest even, nan payloads are truncated like
+// _mm_cvtpd_ps followed by _mm_cvtps_ph
+uint16_t f64_to_f16(double d);
+void f64_to_f16_buffer(uint64_t *data, uint16_t *result, int data_size);
+
+// double to float to half, rounds twice so some values land on the wrong side of a tie
+void f64_to_f16_buffer_two_pass(uint64_t *data, uint16_t *result, int data_size);
+
+#endif // F64_H
@@ -0,0 +1,37 @@
+#include "f64_avx2.h"
+#include "../round_to_odd.h"
+#include <immintrin.h>
+
+static inline __m128i cvtpd_ph_avx2(const uint64_t *data)
+{
+    __m128 lo = cvtpd_ps_odd_avx(_mm256_loadu_pd((const double*)data));
+    __m128 hi = cvtpd_ps_odd_avx(_mm256_loadu_pd((const double*)data + 4));
+    return _mm256_cvtps_ph(_mm256_set_m128(hi, lo), _MM_FROUND_TO_NEAREST_INT);
+}
+
+void f64_to_f16_buffer_avx2(uint64_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        _mm_storeu_si128((__m128i*)result, cvtpd_ph_avx2(data));
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder) {
+        uint64_t in_buf[8] = {0};
+        uint16_t out_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        _mm_storeu_si128((__m128i*)&out_buf[0], cvtpd_ph_avx2(in_buf));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
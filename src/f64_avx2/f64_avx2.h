@@ -0,0 +1,4 @@
+#include <stdint.h>
+
+// correctly rounded double to half, 8 values per loop with avx2 and f16c
+void f64_to_f16_buffer_avx2(uint64_t *data, uint16_t *result, int data_size);
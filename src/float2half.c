@@ -1,197 +1,1428 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <assert.h>
 
 #include "common.h"
 
 #include "platform_info.h"
+#include "noisy_neighbor.h"
+#include "target_clones.h"
+#include "autotune.h"
 
 #include <float.h>
 #include <math.h>
 #include <time.h>
 #include <inttypes.h>
 
-#include "hardware/hardware.h"
-#include "table/table.h"
-#include "table_round/table_round.h"
-#include "no_table/no_table.h"
-#include "cpython/cpython.h"
-#include "numpy/numpy.h"
-#include "imath/imath.h"
-#include "tursa/tursa.h"
-#include "ryg/ryg.h"
-#include "maratyszcza/maratyszcza.h"
-#include "maratyszcza_nanfix/maratyszcza_nanfix.h"
+#include "f16_registry.h"
+#include "special_values.h"
+#include "f64/f64.h"
+#include "image/image.h"
+#include "channels.h"
+#include "stochastic/stochastic.h"
+#include "integer/integer.h"
+#include "representable/representable.h"
 
-#if defined(ARCH_X86)
-#include "maratyszcza_sse2/maratyszcza_sse2.h"
-#include "ryg_sse2/ryg_sse2.h"
-#include "x86_cpu_info.h"
-#endif
+static const F16Kernel *f16_tests[F16_MAX_KERNELS];
+static size_t test_count = 0;
+
+static const F16Kernel *bf16_tests[F16_MAX_KERNELS];
+static size_t bf16_test_count = 0;
+
+static const F16StochasticKernel *stochastic_tests[F16_MAX_KERNELS];
+static size_t stochastic_test_count = 0;
+
+static const F16DoubleKernel *double_tests[F16_MAX_KERNELS];
+static size_t double_test_count = 0;
+
+static const F16InplaceKernel *inplace_tests[F16_MAX_KERNELS];
+static size_t inplace_test_count = 0;
+
+static const F16ImageKernel *image_tests[F16_MAX_KERNELS];
+static size_t image_test_count = 0;
+
+static const F16ChannelKernel *channel_tests[F16_MAX_KERNELS];
+static size_t channel_test_count = 0;
+
+static const F16ScaleBiasKernel *scale_bias_tests[F16_MAX_KERNELS];
+static size_t scale_bias_test_count = 0;
+
+static const F16IntegerKernel *integer_tests[F16_MAX_KERNELS];
+static size_t integer_test_count = 0;
+
+static const F16RepresentableKernel *representable_tests[F16_MAX_KERNELS];
+static size_t representable_test_count = 0;
+
+#define PRINT_ERROR_RESULT(name, count, total) \
+    printf("%-20s : %g%% \n", name,  100.0 - (100.0 * (count)/(double)(total))); \
+    fprintf(f, "%s,%f,%f\n", name, (double)(count), (double)(total))
+
+void test_hardware_accuracy(FILE *f, const F16Kernel *reference)
+{
+    int_float value;
+
+    uint32_t full_error[F16_MAX_KERNELS] = {0};
+    uint32_t half_error[F16_MAX_KERNELS] = {0};
+    uint32_t nan_exact_error[F16_MAX_KERNELS] = {0};
+    uint32_t nan_error[F16_MAX_KERNELS] = {0};
+
+    uint32_t inf_error[F16_MAX_KERNELS] = {0};
+
+    uint32_t nan_total = 0;
+    uint32_t inf_total = 0;
+    uint32_t half_total = 0;
+
+    if (strcmp(reference->name, "hardware")) {
+        printf("** cpu has no f16c instruction, verifying against %s instead **\n\n", reference->name);
+    }
+
+    // test every possible float32 value
+    for (uint64_t i = 0; i <= UINT32_MAX; i++) {
+        value.u = (uint32_t)i;
+
+        uint16_t r0 = reference->f32_to_f16(value.f);
+
+        if (isnan(value.f))
+            nan_total++;
+        else if ((value.u & 0x7FFFFFFF) > 0x477fefff)
+            inf_total++;
+        else
+            half_total++;
+
+        for (size_t j = 0; j < test_count; j++) {
+            if (f16_tests[j] == reference)
+                continue;
+            uint16_t r1 = f16_tests[j]->f32_to_f16(value.f);
+
+            // check if value exactly matches hardware
+            int e = (r0 != r1);
+            full_error[j] += e;
+
+            if (isnan(value.f)) {
+                // float v = f16_to_f32_hw(r0);
+                // assert(isnan(v));
+
+                nan_exact_error[j] += e;
+
+                // check if the converted value is a NaN
+                // even if it doesn't match hardware exactly
+
+                // float t = f16_to_f32_hw(r1);
+                // int is_a_nan = ((r1 & 0x7FFF) > 0x7C00);
+                // assert(is_a_nan == isnan(t));
+
+                nan_error[j] += !((r1 & 0x7FFF) > 0x7C00);
+
+            } else if ((value.u & 0x7FFFFFFF) > 0x477fefff) {
+                // value should be +inf/-inf
+
+                // float v = f16_to_f32_hw(r0);
+                // assert(isinf(v));
+
+                inf_error[j] += e;
+
+            } else {
+                // value can be mapped to a f16 normal number or denormal
+
+                // float v = f16_to_f32_hw(r0);
+                // assert(!(isinf(v) || isnan(v)));
+
+                half_error[j] += e;
+
+            }
+        }
+
+        if ((i % 0x10000000 ) == 0){
+            printf("\r %4.1f%%", 100.0 * i/(double)UINT32_MAX);
+            fflush(stdout);
+        }
+    }
+
+    printf("\rnormal and denormal value matches hardware, out of %u:\n", half_total);
+    fprintf(f, "\nerror_test,normal and denormal value matches hardware\nname,error,total\n");
+
+    for (size_t i = 0; i < test_count; i++) {
+        if (f16_tests[i] == reference)
+            continue;
+        PRINT_ERROR_RESULT(f16_tests[i]->name, half_error[i], half_total);
+    }
+
+    printf("\nnan value exactly matches hardware, out of %u:\n", nan_total);
+    fprintf(f, "\nerror_test,nan value exactly matches hardware\nname,error,total\n");
+
+    for (size_t i = 0; i < test_count; i++) {
+        if (f16_tests[i] == reference)
+            continue;
+        PRINT_ERROR_RESULT(f16_tests[i]->name, nan_exact_error[i], nan_total);
+    }
+
+    printf("\nnan is a nan value but might not match hardware, out of %u:\n", nan_total);
+    fprintf(f, "\nerror_test,nan is a nan value but might not match hardware\nname,error,total\n");
+
+    for (size_t i = 0; i < test_count; i++) {
+        if (f16_tests[i] == reference)
+            continue;
+        PRINT_ERROR_RESULT(f16_tests[i]->name, nan_error[i], nan_total);
+    }
+
+    printf("\n+/-inf value matches hardware, out of %u:\n", inf_total);
+    fprintf(f, "\nerror_test,+/-inf value matches hardware\nname,error,total\n");
+
+    for (size_t i = 0; i < test_count; i++) {
+        if (f16_tests[i] == reference)
+            continue;
+        PRINT_ERROR_RESULT(f16_tests[i]->name, inf_error[i], inf_total);
+    }
+
+    printf("\ntotal exact hardware match:\n");
+    fprintf(f, "\nerror_test,total exact hardware match\nname,error,total\n");
+
+    for (size_t i = 0; i < test_count; i++) {
+        if (f16_tests[i] == reference)
+            continue;
+        PRINT_ERROR_RESULT(f16_tests[i]->name, full_error[i], UINT32_MAX);
+    }
+}
+
+typedef struct RoundMode {
+    int mode;
+    const char *name;
+    const char *suffix;
+} RoundMode;
+
+static const RoundMode round_modes[] = {
+    {F16_ROUND_TO_NEG_INF, "round down",        "rd"},
+    {F16_ROUND_TO_POS_INF, "round up",          "ru"},
+    {F16_ROUND_TO_ZERO,    "round toward zero", "rz"},
+};
+
+#define ROUND_CHUNK_SIZE 0x10000
+
+// every float32 value through the buffer functions in chunks,
+// compared against the reference with the matching rounding immediate
+void test_rounding_modes(FILE *f, const F16Kernel *reference)
+{
+    uint32_t *src = (uint32_t*) malloc(sizeof(uint32_t) * ROUND_CHUNK_SIZE);
+    uint16_t *expect = (uint16_t*) malloc(sizeof(uint16_t) * ROUND_CHUNK_SIZE);
+    uint16_t *got = (uint16_t*) malloc(sizeof(uint16_t) * ROUND_CHUNK_SIZE);
+
+    if (!src || !expect || !got) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    for (size_t m = 0; m < ARRAY_SIZE(round_modes); m++) {
+        int mode = round_modes[m].mode;
+        uint32_t error[F16_MAX_KERNELS] = {0};
+        uint32_t scalar_error[F16_MAX_KERNELS] = {0};
+
+        for (uint64_t base = 0; base <= UINT32_MAX; base += ROUND_CHUNK_SIZE) {
+            for (int i = 0; i < ROUND_CHUNK_SIZE; i++) {
+                src[i] = (uint32_t)(base + i);
+            }
+
+            reference->f32_to_f16_buffer_mode(src, expect, ROUND_CHUNK_SIZE, mode);
+
+            for (size_t j = 0; j < test_count; j++) {
+                if (f16_tests[j] == reference || !f16_tests[j]->f32_to_f16_buffer_mode)
+                    continue;
+
+                f16_tests[j]->f32_to_f16_buffer_mode(src, got, ROUND_CHUNK_SIZE, mode);
+                for (int i = 0; i < ROUND_CHUNK_SIZE; i++) {
+                    error[j] += expect[i] != got[i];
+                }
+
+                // spot check the single value version
+                for (int i = 0; i < ROUND_CHUNK_SIZE; i += 251) {
+                    int_float value;
+                    value.u = src[i];
+                    scalar_error[j] += expect[i] != f16_tests[j]->f32_to_f16_mode(value.f, mode);
+                }
+            }
+
+            if ((base % 0x10000000 ) == 0){
+                printf("\r %4.1f%%", 100.0 * base/(double)UINT32_MAX);
+                fflush(stdout);
+            }
+        }
+
+        printf("\r%s matches hardware:\n", round_modes[m].name);
+        fprintf(f, "\nerror_test,%s matches hardware\nname,error,total\n", round_modes[m].name);
+
+        for (size_t j = 0; j < test_count; j++) {
+            if (f16_tests[j] == reference || !f16_tests[j]->f32_to_f16_buffer_mode)
+                continue;
+            PRINT_ERROR_RESULT(f16_tests[j]->name, error[j], UINT32_MAX);
+            if (scalar_error[j])
+                printf("%-20s : %u single value mismatches\n", f16_tests[j]->name, scalar_error[j]);
+        }
+        printf("\n");
+    }
+
+done:
+    free(src);
+    free(expect);
+    free(got);
+}
+
+// every output has to be the value rounded toward zero or away from zero,
+// checked over every float32 value in chunks like test_rounding_modes
+void test_stochastic_rounding(FILE *f, const F16Kernel *reference, unsigned int cpu_flags)
+{
+    uint32_t *src = (uint32_t*) malloc(sizeof(uint32_t) * ROUND_CHUNK_SIZE);
+    uint16_t *rz = (uint16_t*) malloc(sizeof(uint16_t) * ROUND_CHUNK_SIZE);
+    uint16_t *up = (uint16_t*) malloc(sizeof(uint16_t) * ROUND_CHUNK_SIZE);
+    uint16_t *down = (uint16_t*) malloc(sizeof(uint16_t) * ROUND_CHUNK_SIZE);
+    uint16_t *first = (uint16_t*) malloc(sizeof(uint16_t) * ROUND_CHUNK_SIZE);
+    uint16_t *got = (uint16_t*) malloc(sizeof(uint16_t) * ROUND_CHUNK_SIZE);
+
+    F16StochasticState state[F16_MAX_KERNELS];
+    uint32_t error[F16_MAX_KERNELS] = {0};
+    uint32_t differ[F16_MAX_KERNELS] = {0};
+
+    if (!src || !rz || !up || !down || !first || !got) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    // same seed everywhere, the simd versions have to match the portable one
+    for (size_t k = 0; k < stochastic_test_count; k++) {
+        f16_stochastic_seed(&state[k], 0x5eed, 0);
+    }
+
+    for (uint64_t base = 0; base <= UINT32_MAX; base += ROUND_CHUNK_SIZE) {
+        for (int i = 0; i < ROUND_CHUNK_SIZE; i++) {
+            src[i] = (uint32_t)(base + i);
+        }
+
+        reference->f32_to_f16_buffer_mode(src, rz, ROUND_CHUNK_SIZE, F16_ROUND_TO_ZERO);
+        reference->f32_to_f16_buffer_mode(src, up, ROUND_CHUNK_SIZE, F16_ROUND_TO_POS_INF);
+        reference->f32_to_f16_buffer_mode(src, down, ROUND_CHUNK_SIZE, F16_ROUND_TO_NEG_INF);
+
+        for (size_t k = 0; k < stochastic_test_count; k++) {
+            const F16StochasticKernel *s = stochastic_tests[k];
+
+            // the portable version goes first and the others are compared against it
+            uint16_t *r = k == 0 ? first : got;
+            s->f32_to_f16_buffer(&state[k], src, r, ROUND_CHUNK_SIZE);
+
+            for (int i = 0; i < ROUND_CHUNK_SIZE; i++) {
+                uint16_t away = (src[i] >> 31) ? down[i] : up[i];
+                error[k] += r[i] != rz[i] && r[i] != away;
+                differ[k] += r[i] != first[i];
+            }
+        }
+
+        if ((base % 0x10000000 ) == 0){
+            printf("\r %4.1f%%", 100.0 * base/(double)UINT32_MAX);
+            fflush(stdout);
+        }
+    }
+
+    printf("\rstochastic rounding is round toward zero or away from zero:\n");
+    fprintf(f, "\nerror_test,stochastic rounding is round toward zero or away from zero\nname,error,total\n");
+
+    for (size_t k = 0; k < stochastic_test_count; k++) {
+        const F16StochasticKernel *s = stochastic_tests[k];
+        PRINT_ERROR_RESULT(s->name, error[k], UINT32_MAX);
+        if (differ[k])
+            printf("%-20s : %u values differ from %s\n", s->name, differ[k], stochastic_tests[0]->name);
+    }
+
+    // the mean of many conversions has to land on the input, within six standard deviations
+    // of a mean of coin flips between the two halves around it, and away from the nearest half
+    {
+        const F16Kernel *widen = f16_kernel_find(F16_F16_TO_F32, "static_table", cpu_flags);
+        const float values[] = {1.0f + 1.0f / 4096.0f, -1234.567f, 3.0e-6f, 1.5f};
+        const int samples = ROUND_CHUNK_SIZE * 16;
+        uint32_t mean_error[F16_MAX_KERNELS] = {0};
+        double total = ARRAY_SIZE(values);
+        int_float v;
+
+        printf("\nmean of %d conversions:\n", samples);
+        for (size_t n = 0; n < ARRAY_SIZE(values); n++) {
+            int away_mode = values[n] < 0.0f ? F16_ROUND_TO_NEG_INF : F16_ROUND_TO_POS_INF;
+            double toward = widen->f16_to_f32(reference->f32_to_f16_mode(values[n], F16_ROUND_TO_ZERO));
+            double away = widen->f16_to_f32(reference->f32_to_f16_mode(values[n], away_mode));
+            double nearest = widen->f16_to_f32(reference->f32_to_f16_mode(values[n], F16_ROUND_TO_NEAREST));
+            // 0 when the input is a half, then every conversion has to give it back
+            double tolerance = 3.0 * fabs(away - toward) / sqrt((double)samples);
+
+            v.f = values[n];
+            for (int i = 0; i < ROUND_CHUNK_SIZE; i++) {
+                src[i] = v.u;
+            }
+
+            for (size_t k = 0; k < stochastic_test_count; k++) {
+                const F16StochasticKernel *s = stochastic_tests[k];
+                double sum = 0.0;
+                double mean;
+
+                for (int j = 0; j < 16; j++) {
+                    s->f32_to_f16_buffer(&state[k], src, got, ROUND_CHUNK_SIZE);
+                    for (int i = 0; i < ROUND_CHUNK_SIZE; i++) {
+                        sum += widen->f16_to_f32(got[i]);
+                    }
+                }
+
+                mean = sum / samples;
+                mean_error[k] += fabs(mean - values[n]) > tolerance || (away != toward && fabs(mean - nearest) <= tolerance);
+                printf("%-20s : %-14.9g mean %.9g, nearest %.9g\n", s->name, values[n], mean, nearest);
+            }
+        }
+
+        printf("\nstochastic mean is the input and not the nearest half, out of %.0f:\n", total);
+        fprintf(f, "\nerror_test,stochastic mean is the input and not the nearest half\nname,error,total\n");
+        for (size_t k = 0; k < stochastic_test_count; k++) {
+            PRINT_ERROR_RESULT(stochastic_tests[k]->name, mean_error[k], total);
+        }
+    }
+
+done:
+    free(src);
+    free(rz);
+    free(up);
+    free(down);
+    free(first);
+    free(got);
+}
+
+typedef struct SpecialMode {
+    int flags;
+    const char *name;
+    const char *suffix;
+} SpecialMode;
+
+static const SpecialMode special_modes[] = {
+    {F16_SATURATE | F16_NAN_TO_ZERO,   "saturate, nan to zero",   "sat nan0"},
+    {F16_SATURATE | F16_NAN_CANONICAL, "saturate, canonical nan", "sat qnan"},
+    {F16_NAN_CANONICAL,                "canonical nan",           "qnan"},
+    {F16_SATURATE,                     "saturate",                "sat"},
+    {F16_NAN_TO_ZERO,                  "nan to zero",             "nan0"},
+};
+
+// the expected value is worked out from the float32 input, only finite
+// in range values go through the reference conversion. with no nan flag
+// a nan keeps the payload the kernel's plain conversion gives it
+void test_special_values(FILE *f, const F16Kernel *reference)
+{
+    uint32_t *src = (uint32_t*) malloc(sizeof(uint32_t) * ROUND_CHUNK_SIZE);
+    uint16_t *nearest = (uint16_t*) malloc(sizeof(uint16_t) * ROUND_CHUNK_SIZE);
+    uint16_t *plain = (uint16_t*) malloc(sizeof(uint16_t) * ROUND_CHUNK_SIZE);
+    uint16_t *got = (uint16_t*) malloc(sizeof(uint16_t) * ROUND_CHUNK_SIZE);
+
+    if (!src || !nearest || !plain || !got) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    for (size_t m = 0; m < ARRAY_SIZE(special_modes); m++) {
+        int flags = special_modes[m].flags;
+        int keep_nan = !(flags & (F16_NAN_TO_ZERO | F16_NAN_CANONICAL));
+        uint32_t error[F16_MAX_KERNELS] = {0};
+
+        for (uint64_t base = 0; base <= UINT32_MAX; base += ROUND_CHUNK_SIZE) {
+            for (int i = 0; i < ROUND_CHUNK_SIZE; i++) {
+                src[i] = (uint32_t)(base + i);
+            }
+
+            reference->f32_to_f16_buffer(src, nearest, ROUND_CHUNK_SIZE);
+
+            for (int i = 0; i < ROUND_CHUNK_SIZE; i++) {
+                uint32_t abs = src[i] & 0x7FFFFFFF;
+                uint16_t sign = (src[i] >> 16) & 0x8000;
+
+                if (abs > 0x7F800000) {
+                    if (!keep_nan)
+                        nearest[i] = (flags & F16_NAN_TO_ZERO) ? 0x0000 : 0x7E00;
+                } else if ((flags & F16_SATURATE) && abs > 0x477FEFFF) {
+                    // rounds to inf, including inf itself
+                    nearest[i] = sign | 0x7BFF;
+                }
+            }
+
+            for (size_t j = 0; j < test_count; j++) {
+                if (!f16_tests[j]->f32_to_f16_buffer_special)
+                    continue;
+
+                if (keep_nan)
+                    f16_tests[j]->f32_to_f16_buffer(src, plain, ROUND_CHUNK_SIZE);
+
+                f16_tests[j]->f32_to_f16_buffer_special(src, got, ROUND_CHUNK_SIZE, flags);
+                for (int i = 0; i < ROUND_CHUNK_SIZE; i++) {
+                    uint16_t want = nearest[i];
+                    if (keep_nan && (src[i] & 0x7FFFFFFF) > 0x7F800000)
+                        want = plain[i];
+                    error[j] += want != got[i];
+                }
+            }
+
+            if ((base % 0x10000000 ) == 0){
+                printf("\r %4.1f%%", 100.0 * base/(double)UINT32_MAX);
+                fflush(stdout);
+            }
+        }
+
+        printf("\r%s:\n", special_modes[m].name);
+        fprintf(f, "\nerror_test,%s\nname,error,total\n", special_modes[m].name);
+
+        for (size_t j = 0; j < test_count; j++) {
+            if (!f16_tests[j]->f32_to_f16_buffer_special)
+                continue;
+            PRINT_ERROR_RESULT(f16_tests[j]->name, error[j], UINT32_MAX);
+        }
+        printf("\n");
+    }
+
+done:
+    free(src);
+    free(nearest);
+    free(plain);
+    free(got);
+}
+
+// the unfused version, a plain conversion followed by a second pass over the halves
+static void f32_to_f16_buffer_two_pass_special(const F16Kernel *k, uint32_t *data, uint16_t *result, int data_size, int flags)
+{
+    k->f32_to_f16_buffer(data, result, data_size);
+    for (int i = 0; i < data_size; i++) {
+        result[i] = f16_fix_special(result[i], flags);
+    }
+}
+
+static int stats_equal(const F16ConvertStats *a, const F16ConvertStats *b)
+{
+    return a->nan == b->nan && a->inf == b->inf &&
+           a->overflow == b->overflow && a->underflow == b->underflow &&
+           a->min == b->min && a->max == b->max;
+}
+
+// every float32 value through the *_stats buffer functions in chunks, the halves
+// have to match the reference and the stats have to match a scalar count.
+// a short buffer from the start of each chunk checks the tail handling
+void test_convert_stats(FILE *f, const F16Kernel *reference)
+{
+    uint32_t *src = (uint32_t*) malloc(sizeof(uint32_t) * ROUND_CHUNK_SIZE);
+    uint16_t *expect = (uint16_t*) malloc(sizeof(uint16_t) * ROUND_CHUNK_SIZE);
+    uint16_t *got = (uint16_t*) malloc(sizeof(uint16_t) * ROUND_CHUNK_SIZE);
+    uint32_t error[F16_MAX_KERNELS] = {0};
+    uint32_t stats_error[F16_MAX_KERNELS] = {0};
+    uint32_t chunks = 0;
+
+    if (!src || !expect || !got) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    for (uint64_t base = 0; base <= UINT32_MAX; base += ROUND_CHUNK_SIZE) {
+        F16ConvertStats expect_stats, tail_stats, stats;
+        int tail_size = (int)(chunks % 15) + 1;
+
+        for (int i = 0; i < ROUND_CHUNK_SIZE; i++) {
+            src[i] = (uint32_t)(base + i);
+        }
+
+        reference->f32_to_f16_buffer(src, expect, ROUND_CHUNK_SIZE);
+
+        f16_stats_init(&expect_stats);
+        f16_stats_init(&tail_stats);
+        for (int i = 0; i < ROUND_CHUNK_SIZE; i++) {
+            f16_stats_add(&expect_stats, src[i]);
+            if (i < tail_size)
+                f16_stats_add(&tail_stats, src[i]);
+        }
+
+        for (size_t j = 0; j < test_count; j++) {
+            if (!f16_tests[j]->f32_to_f16_buffer_stats)
+                continue;
+
+            f16_tests[j]->f32_to_f16_buffer_stats(src, got, ROUND_CHUNK_SIZE, &stats);
+            for (int i = 0; i < ROUND_CHUNK_SIZE; i++) {
+                error[j] += expect[i] != got[i];
+            }
+            stats_error[j] += !stats_equal(&stats, &expect_stats);
+
+            f16_tests[j]->f32_to_f16_buffer_stats(src, got, tail_size, &stats);
+            stats_error[j] += !stats_equal(&stats, &tail_stats);
+        }
+
+        if ((base % 0x10000000 ) == 0){
+            printf("\r %4.1f%%", 100.0 * base/(double)UINT32_MAX);
+            fflush(stdout);
+        }
+        chunks++;
+    }
+
+    printf("\rstats conversion matches hardware:\n");
+    fprintf(f, "\nerror_test,stats conversion matches hardware\nname,error,total\n");
+
+    for (size_t j = 0; j < test_count; j++) {
+        if (!f16_tests[j]->f32_to_f16_buffer_stats)
+            continue;
+        PRINT_ERROR_RESULT(f16_tests[j]->name, error[j], UINT32_MAX);
+        if (stats_error[j])
+            printf("%-20s : %u of %u buffers with wrong stats\n", f16_tests[j]->name, stats_error[j], chunks * 2);
+    }
+
+done:
+    free(src);
+    free(expect);
+    free(got);
+}
+
+// the unfused version, a plain conversion followed by a second pass over the floats
+static void f32_to_f16_buffer_two_pass_stats(const F16Kernel *k, uint32_t *data, uint16_t *result, int data_size, F16ConvertStats *stats)
+{
+    k->f32_to_f16_buffer(data, result, data_size);
+    f16_stats_init(stats);
+    for (int i = 0; i < data_size; i++) {
+        f16_stats_add(stats, data[i]);
+    }
+}
+
+// exact value of a positive half, 0x7c00 stands in for the next binade at 65536
+static double half_value(const F16Kernel *widen, uint16_t h)
+{
+    return h == 0x7C00 ? 65536.0 : (double)widen->f16_to_f32(h);
+}
+
+// searches the halves for the two around d and compares d with their midpoint,
+// which a double holds exactly
+static uint16_t f64_to_f16_reference(const F16Kernel *widen, uint64_t u)
+{
+    union { uint64_t u; double d; } value;
+    uint16_t sign = (u >> 48) & 0x8000;
+    int lo = 0, hi = 0x7C00;
+
+    value.u = u & 0x7FFFFFFFFFFFFFFFull;
+    if (isnan(value.d))
+        return sign | 0x7E00 | (uint16_t)((u & 0x000FFFFFFFFFFFFFull) >> 42);
+    if (value.d >= 65536.0)
+        return sign | 0x7C00;
+
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (half_value(widen, mid) <= value.d)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    if (half_value(widen, lo) != value.d) {
+        double mid = (half_value(widen, lo) + half_value(widen, lo + 1)) / 2.0;
+        if (value.d > mid || (value.d == mid && (lo & 1)))
+            lo++;
+    }
+
+    return sign | lo;
+}
+
+static uint64_t rand_u64(void)
+{
+    return ((uint64_t)rand() << 62) ^ ((uint64_t)rand() << 31) ^ (uint64_t)rand();
+}
+
+// random doubles, doubles near every half midpoint where a float would land on
+// a false tie, and the usual special values
+void test_f64_conversion(FILE *f, unsigned int cpu_flags)
+{
+    const F16Kernel *widen = f16_kernel_find(F16_F16_TO_F32, "static_table", cpu_flags);
+    const size_t random_size = 1 << 21;
+    // 2 signs, 7 offsets around each midpoint
+    const size_t size = random_size * 2 + 0x7C00 * 14 + 16;
+    const int64_t offsets[] = {0, 1, -1, 1 << 28, -(1 << 28), 1 << 29, -(1 << 29)};
+    union { uint64_t u; double d; } value;
+    uint32_t error[F16_MAX_KERNELS] = {0};
+    uint32_t two_pass_error = 0;
+    size_t n = 0;
+    double total;
+
+    uint64_t *src = (uint64_t*) malloc(sizeof(uint64_t) * size);
+    uint16_t *expect = (uint16_t*) malloc(sizeof(uint16_t) * size);
+    uint16_t *got = (uint16_t*) malloc(sizeof(uint16_t) * size);
+
+    if (!src || !expect || !got) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    for (size_t i = 0; i < random_size; i++) {
+        src[n++] = rand_u64();
+    }
+    randomize_buffer_f64(&src[n], random_size);
+    n += random_size;
+
+    for (uint16_t h = 0; h < 0x7C00; h++) {
+        value.d = (half_value(widen, h) + half_value(widen, h + 1)) / 2.0;
+        for (size_t i = 0; i < ARRAY_SIZE(offsets); i++) {
+            src[n++] = value.u + offsets[i];
+            src[n++] = (value.u + offsets[i]) | 0x8000000000000000ull;
+        }
+    }
+
+    {
+        const double special[] = {0.0, -0.0, INFINITY, -INFINITY, NAN, -NAN, 65504.0, 65520.0, -65520.0,
+                                  DBL_MAX, -DBL_MAX, DBL_MIN, 1e-300, 0x1p-25, 0x1p-24, 0x1p-14};
+        for (size_t i = 0; i < ARRAY_SIZE(special); i++) {
+            value.d = special[i];
+            src[n++] = value.u;
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        expect[i] = f64_to_f16_reference(widen, src[i]);
+    }
+
+    // n is a multiple of 8, so the whole buffer never reaches a tail. n - 1 down to
+    // n - 7 leave 1 to 7 over for any width, only the last 8 are checked again
+    for (size_t k = 0; k < double_test_count; k++) {
+        const F16DoubleKernel *d = double_tests[k];
+        for (size_t len = n; len > n - 8; len--) {
+            d->f64_to_f16_buffer(src, got, (int)len);
+            for (size_t i = len == n ? 0 : n - 8; i < len; i++) {
+                error[k] += expect[i] != got[i];
+            }
+        }
+    }
+
+    for (size_t len = n; len > n - 8; len--) {
+        f64_to_f16_buffer_two_pass(src, got, (int)len);
+        for (size_t i = len == n ? 0 : n - 8; i < len; i++) {
+            two_pass_error += expect[i] != got[i];
+        }
+    }
+
+    // the full buffer plus 1 + 2 + ... + 7 for the shorter ones
+    total = (double)n + 28.0;
+    printf("f64 rounded once to nearest even, out of %.0f:\n", total);
+    fprintf(f, "\nerror_test,f64 rounded once to nearest even\nname,error,total\n");
+
+    for (size_t k = 0; k < double_test_count; k++) {
+        const F16DoubleKernel *d = double_tests[k];
+        PRINT_ERROR_RESULT(d->name, error[k], total);
+    }
+    PRINT_ERROR_RESULT("f64 two pass", two_pass_error, total);
+
+done:
+    free(src);
+    free(expect);
+    free(got);
+}
+
+static double bf16_value(uint16_t h)
+{
+    int_float value;
+    // 0x7f80 stands in for the next binade past FLT_MAX
+    if (h == 0x7F80)
+        return 340282366920938463463374607431768211456.0;
+    value.u = (uint32_t)h << 16;
+    return value.f;
+}
+
+// truncates, then compares what was dropped with the distance to the next bf16
+static uint16_t f32_to_bf16_reference(uint32_t u)
+{
+    int_float value;
+    uint16_t sign = (u >> 16) & 0x8000;
+    uint16_t lo = (u & 0x7FFFFFFF) >> 16;
+    double below, above;
+
+    if ((u & 0x7FFFFFFF) > 0x7F800000)
+        return (uint16_t)(u >> 16) | 0x0040;
+    if ((u & 0x7FFFFFFF) == 0x7F800000)
+        return sign | 0x7F80;
+
+    value.u = u & 0x7FFFFFFF;
+    below = value.f - bf16_value(lo);
+    above = bf16_value(lo + 1) - value.f;
+
+    if (above < below || (above == below && (lo & 1)))
+        lo++;
+
+    return sign | lo;
+}
+
+// every float32 value through the bf16 buffer kernels in chunks
+void test_bf16_accuracy(FILE *f)
+{
+    uint32_t *src = (uint32_t*) malloc(sizeof(uint32_t) * ROUND_CHUNK_SIZE);
+    uint16_t *expect = (uint16_t*) malloc(sizeof(uint16_t) * ROUND_CHUNK_SIZE);
+    uint16_t *got = (uint16_t*) malloc(sizeof(uint16_t) * ROUND_CHUNK_SIZE);
+    uint32_t value_error[F16_MAX_KERNELS] = {0};
+    uint32_t nan_error[F16_MAX_KERNELS] = {0};
+    uint32_t full_error[F16_MAX_KERNELS] = {0};
+    uint32_t nan_total = 0;
+    double value_total;
+
+    if (!src || !expect || !got) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    for (uint64_t base = 0; base <= UINT32_MAX; base += ROUND_CHUNK_SIZE) {
+        for (int i = 0; i < ROUND_CHUNK_SIZE; i++) {
+            src[i] = (uint32_t)(base + i);
+            expect[i] = f32_to_bf16_reference(src[i]);
+            nan_total += (src[i] & 0x7FFFFFFF) > 0x7F800000;
+        }
+
+        for (size_t j = 0; j < bf16_test_count; j++) {
+            bf16_tests[j]->f32_to_f16_buffer(src, got, ROUND_CHUNK_SIZE);
+            for (int i = 0; i < ROUND_CHUNK_SIZE; i++) {
+                int e = expect[i] != got[i];
+                full_error[j] += e;
+                if ((src[i] & 0x7FFFFFFF) > 0x7F800000)
+                    nan_error[j] += !((got[i] & 0x7FFF) > 0x7F80);
+                else
+                    value_error[j] += e;
+            }
+        }
+
+        if ((base % 0x10000000 ) == 0){
+            printf("\r %4.1f%%", 100.0 * base/(double)UINT32_MAX);
+            fflush(stdout);
+        }
+    }
+
+    value_total = (double)UINT32_MAX + 1.0 - nan_total;
+    printf("\rbf16 value rounded to nearest even, out of %.0f:\n", value_total);
+    fprintf(f, "\nerror_test,bf16 value rounded to nearest even\nname,error,total\n");
+    for (size_t j = 0; j < bf16_test_count; j++) {
+        PRINT_ERROR_RESULT(bf16_tests[j]->name, value_error[j], value_total);
+    }
+
+    printf("\nbf16 nan is a nan value, out of %u:\n", nan_total);
+    fprintf(f, "\nerror_test,bf16 nan is a nan value\nname,error,total\n");
+    for (size_t j = 0; j < bf16_test_count; j++) {
+        PRINT_ERROR_RESULT(bf16_tests[j]->name, nan_error[j], nan_total);
+    }
+
+    printf("\nbf16 total exact match:\n");
+    fprintf(f, "\nerror_test,bf16 total exact match\nname,error,total\n");
+    for (size_t j = 0; j < bf16_test_count; j++) {
+        PRINT_ERROR_RESULT(bf16_tests[j]->name, full_error[j], UINT32_MAX);
+    }
+
+done:
+    free(src);
+    free(expect);
+    free(got);
+}
+
+// every size up to a few vectors, then a large odd size. words past the floats must be left alone
+void test_inplace_conversion(FILE *f, unsigned int cpu_flags)
+{
+    const int sizes_small = 67;
+    const int size_large = (1 << 16) + 3;
+    uint32_t *buf = (uint32_t*) malloc(sizeof(uint32_t) * (size_large + GUARD_COUNT));
+    uint32_t *src = (uint32_t*) malloc(sizeof(uint32_t) * size_large);
+    uint16_t *expect = (uint16_t*) malloc(sizeof(uint16_t) * size_large);
+    uint16_t *got = (uint16_t*) malloc(sizeof(uint16_t) * size_large);
+    uint32_t error[F16_MAX_KERNELS] = {0};
+    uint32_t total = 0;
+
+    if (!buf || !src || !expect || !got) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    for (int i = 0; i < size_large; i++) {
+        src[i] = (uint32_t)rand_u64();
+    }
+
+    for (int n = 0; n < TAIL_TEST_COUNT(sizes_small); n++) {
+        int size = TAIL_TEST_SIZE(n, sizes_small, size_large);
+        total += size;
+
+        for (size_t k = 0; k < inplace_test_count; k++) {
+            const F16InplaceKernel *p = inplace_tests[k];
+            const F16Kernel *plain = f16_kernel_find(F16_F32_TO_F16, p->name, cpu_flags);
+            if (!p->f32_to_f16_buffer_inplace || !plain)
+                continue;
+
+            plain->f32_to_f16_buffer(src, expect, size);
+
+            memcpy(buf, src, sizeof(uint32_t) * size);
+            guard_fill(buf + size, sizeof(uint32_t), GUARD_COUNT);
+            p->f32_to_f16_buffer_inplace(buf, size);
+            memcpy(got, buf, sizeof(uint16_t) * size);
+
+            for (int i = 0; i < size; i++) {
+                error[k] += expect[i] != got[i];
+            }
+            error[k] += guard_check(buf + size, sizeof(uint32_t), GUARD_COUNT);
+        }
+    }
+
+    printf("in place matches out of place, out of %u:\n", total);
+    fprintf(f, "\nerror_test,in place matches out of place\nname,error,total\n");
+    for (size_t k = 0; k < inplace_test_count; k++) {
+        const F16InplaceKernel *p = inplace_tests[k];
+        if (!p->f32_to_f16_buffer_inplace || !f16_kernel_find(F16_F32_TO_F16, p->name, cpu_flags))
+            continue;
+        PRINT_ERROR_RESULT(p->name, error[k], total);
+    }
+
+done:
+    free(buf);
+    free(src);
+    free(expect);
+    free(got);
+}
+
+// every plane element against the scalar conversion, and the row padding must still be the guard fill
+static uint32_t check_planes(const F16Kernel *k, uint32_t *data, int data_stride, uint16_t *planes[4], int plane_stride, int width, int height)
+{
+    uint32_t error = 0;
+    int_float value;
+
+    for (int c = 0; c < 4; c++) {
+        for (int y = 0; y < height; y++) {
+            uint32_t *src = IMAGE_ROW(uint32_t, data, data_stride, y);
+            uint16_t *dst = IMAGE_ROW(uint16_t, planes[c], plane_stride, y);
+            for (int x = 0; x < width; x++) {
+                value.u = src[x * 4 + c];
+                error += dst[x] != k->f32_to_f16(value.f);
+            }
+            error += guard_check(dst + width, sizeof(uint16_t), plane_stride / 2 - width);
+        }
+    }
+    return error;
+}
+
+// odd width so every row has a tail, and padded strides that aren't a multiple of the vector size
+void test_image_conversion(FILE *f, const F16Kernel *reference, unsigned int cpu_flags)
+{
+    const int width = 37;
+    const int height = 5;
+    const int data_stride = width * 16 + 48;
+    const int plane_stride = width * 2 + 22;
+    const int result_stride = width * 8 + 36;
+    uint32_t *data = (uint32_t*) malloc(data_stride * height);
+    uint16_t *plane_buf = (uint16_t*) malloc(plane_stride * height * 4);
+    uint16_t *result = (uint16_t*) malloc(result_stride * height);
+    uint16_t *planes[4];
+    uint32_t error[F16_MAX_KERNELS] = {0};
+    uint32_t generic_error = 0;
+    uint32_t image_error = 0;
+    uint32_t total = (plane_stride / 2) * height * 4;
+    uint32_t image_total = (result_stride / 2) * height;
+    int_float value;
+
+    if (!data || !plane_buf || !result) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    for (int i = 0; i < data_stride * height / 4; i++) {
+        data[i] = (uint32_t)rand_u64();
+    }
+    for (int c = 0; c < 4; c++) {
+        planes[c] = plane_buf + c * (plane_stride / 2) * height;
+    }
+
+    for (size_t k = 0; k < image_test_count; k++) {
+        const F16ImageKernel *img = image_tests[k];
+        const F16Kernel *plain = f16_kernel_find(F16_F32_TO_F16, img->name, cpu_flags);
+        if (!img->f32_rgba_to_f16_planar || !plain)
+            continue;
+
+        guard_fill(plane_buf, sizeof(uint16_t), plane_stride / 2 * height * 4);
+        img->f32_rgba_to_f16_planar(data, data_stride, planes, plane_stride, width, height);
+        error[k] = check_planes(plain, data, data_stride, planes, plane_stride, width, height);
+    }
+
+    guard_fill(plane_buf, sizeof(uint16_t), plane_stride / 2 * height * 4);
+    f32_rgba_to_f16_planar(reference->f32_to_f16_buffer, data, data_stride, planes, plane_stride, width, height);
+    generic_error = check_planes(reference, data, data_stride, planes, plane_stride, width, height);
+
+    // interleaved stays interleaved, only the strides differ
+    guard_fill(result, sizeof(uint16_t), result_stride / 2 * height);
+    f32_to_f16_image(reference->f32_to_f16_buffer, data, data_stride, result, result_stride, width * 4, height);
+    for (int y = 0; y < height; y++) {
+        uint32_t *src = IMAGE_ROW(uint32_t, data, data_stride, y);
+        uint16_t *dst = IMAGE_ROW(uint16_t, result, result_stride, y);
+        for (int x = 0; x < width * 4; x++) {
+            value.u = src[x];
+            image_error += dst[x] != reference->f32_to_f16(value.f);
+        }
+        image_error += guard_check(dst + width * 4, sizeof(uint16_t), result_stride / 2 - width * 4);
+    }
+
+    printf("rgba to planar and padding, out of %u:\n", total);
+    fprintf(f, "\nerror_test,rgba to planar and padding\nname,error,total\n");
+    for (size_t k = 0; k < image_test_count; k++) {
+        const F16ImageKernel *img = image_tests[k];
+        if (!img->f32_rgba_to_f16_planar || !f16_kernel_find(F16_F32_TO_F16, img->name, cpu_flags))
+            continue;
+        PRINT_ERROR_RESULT(img->name, error[k], total);
+    }
+    PRINT_ERROR_RESULT("generic", generic_error, total);
+
+    printf("\nstrided rows and padding, out of %u:\n", image_total);
+    fprintf(f, "\nerror_test,strided rows and padding\nname,error,total\n");
+    PRINT_ERROR_RESULT(reference->name, image_error, image_total);
+
+done:
+    free(data);
+    free(plane_buf);
+    free(result);
+}
+
+// what callers did before the fused kernels, deinterleave the whole frame then convert it
+static void f32_rgba_to_f16_planar_two_pass(const F16Kernel *k, uint32_t *data, uint32_t *scratch, uint16_t *result, int pixels)
+{
+    for (int i = 0; i < pixels; i++) {
+        for (int c = 0; c < 4; c++) {
+            scratch[c * pixels + i] = data[i * 4 + c];
+        }
+    }
+    k->f32_to_f16_buffer(scratch, result, pixels * 4);
+}
+
+// every mask over every pixel count up to a few vectors and a large odd one,
+// against a full conversion followed by f16_pack_channels
+void test_channel_conversion(FILE *f, unsigned int cpu_flags)
+{
+    const int sizes_small = 21;
+    const int size_large = (1 << 12) + 3;
+    uint32_t *src = (uint32_t*) malloc(sizeof(uint32_t) * size_large * 4);
+    uint16_t *full = (uint16_t*) malloc(sizeof(uint16_t) * size_large * 4);
+    uint16_t *expect = (uint16_t*) malloc(sizeof(uint16_t) * size_large * 4);
+    uint16_t *got = (uint16_t*) malloc(sizeof(uint16_t) * (size_large * 4 + GUARD_COUNT));
+    uint32_t error[F16_MAX_KERNELS] = {0};
+    uint32_t total = 0;
+
+    if (!src || !full || !expect || !got) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    for (int i = 0; i < size_large * 4; i++) {
+        src[i] = (uint32_t)rand_u64();
+    }
 
-typedef struct F16Test {
-    const char *name;
-    uint16_t (*f32_to_f16)(float v);
-    void (*f32_to_f16_buffer)(uint32_t *data, uint16_t *result, int data_size);
-} F16Test;
-
-const static F16Test f16_tests[] =
-{
-    {"hardware",            f32_to_f16_hw,                 f32_to_f16_buffer_hw },
-    {"table no rounding",   f32_to_f16_table,              f32_to_f16_buffer_table },
-    {"table rounding",      f32_to_f16_table_round,        f32_to_f16_buffer_table_round },
-    {"no table",            f32_to_f16_no_table,           f32_to_f16_buffer_no_table },
-    {"imath half",          f32_to_f16_imath,              f32_to_f16_buffer_imath },
-    {"cpython",             f32_to_f16_cpython,            f32_to_f16_buffer_cpython },
-    {"numpy",               f32_to_f16_numpy,              f32_to_f16_buffer_numpy },
-    {"tursa",               f32_to_f16_tursa,              f32_to_f16_buffer_tursa },
-    {"ryg",                 f32_to_f16_ryg,                f32_to_f16_buffer_ryg },
-#if defined(ARCH_X86)
-    {"ryg_sse2",            f32_to_f16_ryg_sse2,           f32_to_f16_buffer_ryg_sse2},
-#endif
-    {"maratyszcza",         f32_to_f16_maratyszcza,        f32_to_f16_buffer_maratyszcza },
-    {"maratyszcza nan fix", f32_to_f16_maratyszcza_nanfix, f32_to_f16_buffer_maratyszcza_nanfix },
-#if defined(ARCH_X86)
-    {"maratyszcza sse2",    f32_to_f16_maratyszcza_sse2,   f32_to_f16_buffer_maratyszcza_sse2 }
-#endif
-};
+    for (int mask = 1; mask <= F16_CHANNELS_RGBA; mask++) {
+        int count = f16_channel_count(mask);
 
+        for (int n = 0; n < TAIL_TEST_COUNT(sizes_small); n++) {
+            int pixels = TAIL_TEST_SIZE(n, sizes_small, size_large);
+            total += pixels * count;
 
-#define TEST_COUNT ARRAY_SIZE(f16_tests)
+            for (size_t k = 0; k < channel_test_count; k++) {
+                const F16ChannelKernel *ch = channel_tests[k];
+                const F16Kernel *plain = f16_kernel_find(F16_F32_TO_F16, ch->name, cpu_flags);
+                if (!plain)
+                    continue;
 
-#define PRINT_ERROR_RESULT(name, count, total) \
-    printf("%-20s : %g%% \n", name,  100.0 - (100.0 * count/(double)total)); \
-    fprintf(f, "%s,%f,%f\n", name, (double)count, (double)total)
+                plain->f32_to_f16_buffer(src, full, pixels * 4);
+                f16_pack_channels(full, expect, pixels, mask);
+
+                guard_fill(got, sizeof(uint16_t), pixels * count + GUARD_COUNT);
+                ch->f32_to_f16_channels(src, got, pixels, mask);
+
+                for (int i = 0; i < pixels * count; i++) {
+                    error[k] += got[i] != expect[i];
+                }
+                error[k] += guard_check(got + pixels * count, sizeof(uint16_t), GUARD_COUNT);
+            }
+        }
+    }
+
+    printf("channel subset matches convert and pack, out of %u:\n", total);
+    fprintf(f, "\nerror_test,channel subset matches convert and pack\nname,error,total\n");
+    for (size_t k = 0; k < channel_test_count; k++) {
+        const F16ChannelKernel *ch = channel_tests[k];
+        if (!f16_kernel_find(F16_F32_TO_F16, ch->name, cpu_flags))
+            continue;
+        PRINT_ERROR_RESULT(ch->name, error[k], total);
+    }
+
+done:
+    free(src);
+    free(full);
+    free(expect);
+    free(got);
+}
+
+// what callers did before, convert every channel then pack the ones they keep
+static void f32_to_f16_channels_two_pass(const F16Kernel *k, uint32_t *data, uint16_t *scratch, uint16_t *result, int pixels, int mask)
+{
+    k->f32_to_f16_buffer(data, scratch, pixels * 4);
+    f16_pack_channels(scratch, result, pixels, mask);
+}
 
-void test_hardware_accuracy(FILE *f, int has_hardware_f16)
+// the separate float loop callers had before converting
+static void f32_scale_bias(const uint32_t *data, uint32_t *result, int data_size, const float scale[4], const float bias[4])
 {
     int_float value;
 
-    uint32_t full_error[TEST_COUNT] = {0};
-    uint32_t half_error[TEST_COUNT] = {0};
-    uint32_t nan_exact_error[TEST_COUNT] = {0};
-    uint32_t nan_error[TEST_COUNT] = {0};
+    for (int i = 0; i < data_size; i++) {
+        value.u = data[i];
+        value.f = value.f * scale[i & 3] + bias[i & 3];
+        result[i] = value.u;
+    }
+}
 
-    uint32_t inf_error[TEST_COUNT] = {0};
+// scalar and per channel gains against the float loop followed by the plain kernel
+void test_scale_bias_conversion(FILE *f, unsigned int cpu_flags)
+{
+    const int sizes_small = 21;
+    const int size_large = (1 << 16) + 3;
+    const float gain[4] = {1.7f, 1.7f, 1.7f, 1.7f};
+    const float offset[4] = {-0.25f, -0.25f, -0.25f, -0.25f};
+    const float scale[4] = {1.5f, 0.8f, 2.0f, 1.0f};
+    const float bias[4] = {0.1f, -0.2f, 0.0f, 0.0f};
+    uint32_t *src = (uint32_t*) malloc(sizeof(uint32_t) * size_large);
+    uint32_t *scaled = (uint32_t*) malloc(sizeof(uint32_t) * size_large);
+    uint16_t *expect = (uint16_t*) malloc(sizeof(uint16_t) * size_large);
+    uint16_t *got = (uint16_t*) malloc(sizeof(uint16_t) * (size_large + GUARD_COUNT));
+    uint32_t error[F16_MAX_KERNELS] = {0};
+    uint32_t total = 0;
+
+    if (!src || !scaled || !expect || !got) {
+        printf("malloc error\n");
+        goto done;
+    }
 
-    uint32_t nan_total = 0;
-    uint32_t inf_total = 0;
-    uint32_t half_total = 0;
+    for (int i = 0; i < size_large; i++) {
+        src[i] = (uint32_t)rand_u64();
+    }
 
-    if (!has_hardware_f16) {
-        printf("** cpu has no f16c instruction, verifying against f32_to_f16_no_table instead **\n\n");
+    for (int n = 0; n < TAIL_TEST_COUNT(sizes_small); n++) {
+        int size = TAIL_TEST_SIZE(n, sizes_small, size_large);
+        total += size * 2;
+
+        for (size_t k = 0; k < scale_bias_test_count; k++) {
+            const F16ScaleBiasKernel *sb = scale_bias_tests[k];
+            const F16Kernel *plain = f16_kernel_find(F16_F32_TO_F16, sb->name, cpu_flags);
+            if (!plain)
+                continue;
+
+            for (int per_channel = 0; per_channel < 2; per_channel++) {
+                f32_scale_bias(src, scaled, size, per_channel ? scale : gain, per_channel ? bias : offset);
+                plain->f32_to_f16_buffer(scaled, expect, size);
+
+                guard_fill(got, sizeof(uint16_t), size + GUARD_COUNT);
+                if (per_channel)
+                    sb->f32_to_f16_buffer_scale_bias4(src, got, size, scale, bias);
+                else
+                    sb->f32_to_f16_buffer_scale_bias(src, got, size, gain[0], offset[0]);
+
+                for (int i = 0; i < size; i++) {
+                    error[k] += got[i] != expect[i];
+                }
+                error[k] += guard_check(got + size, sizeof(uint16_t), GUARD_COUNT);
+            }
+        }
     }
 
-    // test every possible float32 value
-    for (uint64_t i = 0; i <= UINT32_MAX; i++) {
-        value.u = (uint32_t)i;
+    printf("scale and bias matches float loop then convert, out of %u:\n", total);
+    fprintf(f, "\nerror_test,scale and bias matches float loop then convert\nname,error,total\n");
+    for (size_t k = 0; k < scale_bias_test_count; k++) {
+        const F16ScaleBiasKernel *sb = scale_bias_tests[k];
+        if (!f16_kernel_find(F16_F32_TO_F16, sb->name, cpu_flags))
+            continue;
+        PRINT_ERROR_RESULT(sb->name, error[k], total);
+    }
 
-        uint16_t r0;
-        if (has_hardware_f16)
-            r0 = f32_to_f16_hw(value.f);
-        else
-            r0 = f32_to_f16_no_table(value.f);
+done:
+    free(src);
+    free(scaled);
+    free(expect);
+    free(got);
+}
 
-        for (size_t j = 1; j < TEST_COUNT; j++) {
-            uint16_t r1 = f16_tests[j].f32_to_f16(value.f);
+// every half in [0, 1] is a whole number of 2^-24, so v / max can be rounded
+// to half exactly with integers. the largest half at or below it, then its neighbour
+static uint16_t unorm_reference(uint32_t v, uint32_t max)
+{
+    const uint64_t x = (uint64_t)v << 24;
+    uint32_t lo = 0;
+    uint32_t hi = 0x3C00;
 
-            // check if value exactly matches hardware
-            int e = (r0 != r1);
-            full_error[j] += e;
+    #define HALF_STEPS(h) ((h) < 0x400 ? (uint64_t)(h) : (uint64_t)(0x400 | ((h) & 0x3FF)) << (((h) >> 10) - 1))
 
-            if (isnan(value.f)) {
-                // float v = f16_to_f32_hw(r0);
-                // assert(isnan(v));
-                if (j == 1)
-                    nan_total++;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi + 1) / 2;
+        if (HALF_STEPS(mid) * max <= x)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    if (lo == 0x3C00)
+        return (uint16_t)lo;
 
-                nan_exact_error[j] += e;
+    uint64_t below = x - HALF_STEPS(lo) * max;
+    uint64_t above = HALF_STEPS(lo + 1) * max - x;
+    #undef HALF_STEPS
 
-                // check if the converted value is a NaN
-                // even if it doesn't match hardware exactly
+    if (below < above || (below == above && !(lo & 1)))
+        return (uint16_t)lo;
+    return (uint16_t)(lo + 1);
+}
 
-                // float t = f16_to_f32_hw(r1);
-                // int is_a_nan = ((r1 & 0x7FFF) > 0x7C00);
-                // assert(is_a_nan == isnan(t));
+// the srgb decode straight from the spec, kept apart from f16_srgb_decode
+// so the table is not checked against the code that built it
+static double srgb_reference(double encoded)
+{
+    if (encoded <= 0.04045)
+        return encoded / 12.92;
+    return pow((encoded + 0.055) / 1.055, 2.4);
+}
 
-                nan_error[j] += !((r1 & 0x7FFF) > 0x7C00);
+// the u8 tables against exact rounding and the srgb curve, then every kernel on every
+// input, shuffled so neighbouring lanes differ, and every size around the tails
+void test_integer_conversion(FILE *f)
+{
+    const int sizes_small = 21;
+    const int size_large = UINT16_MAX + 1;
+    uint8_t *u8 = (uint8_t*) malloc(size_large);
+    uint16_t *u16 = (uint16_t*) malloc(sizeof(uint16_t) * size_large);
+    uint16_t *expect_unorm = (uint16_t*) malloc(sizeof(uint16_t) * size_large);
+    uint16_t *expect_i16 = (uint16_t*) malloc(sizeof(uint16_t) * size_large);
+    uint16_t *got = (uint16_t*) malloc(sizeof(uint16_t) * (size_large + GUARD_COUNT));
+    uint32_t error[F16_MAX_KERNELS] = {0};
+    uint32_t table_error = 0;
+    uint32_t total = 0;
+
+    if (!u8 || !u16 || !expect_unorm || !expect_i16 || !got) {
+        printf("malloc error\n");
+        goto done;
+    }
 
-            } else if ((value.u & 0x7FFFFFFF) > 0x477fefff) {
-                // value should be +inf/-inf
+    for (int k = 0; k < 256; k++) {
+        table_error += f16_u8_unorm_table[k] != unorm_reference(k, 255);
+        table_error += f16_u8_srgb_table[k] != f64_to_f16(srgb_reference(k / 255.0));
+    }
+    for (int i = 0; i < size_large; i++) {
+        u16[i] = (uint16_t)(i * 40503);
+        u8[i] = (uint8_t)u16[i];
+        expect_unorm[i] = unorm_reference(i, UINT16_MAX);
+        expect_i16[i] = f64_to_f16((double)(int16_t)i);
+    }
 
-                // float v = f16_to_f32_hw(r0);
-                // assert(isinf(v));
+    for (int n = 0; n < TAIL_TEST_COUNT(sizes_small); n++) {
+        int size = TAIL_TEST_SIZE(n, sizes_small, size_large);
+        total += size * 4;
+
+        for (size_t k = 0; k < integer_test_count; k++) {
+            const F16IntegerKernel *ik = integer_tests[k];
+
+            for (int which = 0; which < 4; which++) {
+                guard_fill(got, sizeof(uint16_t), size + GUARD_COUNT);
+                switch (which) {
+                    case 0:  ik->u8_to_f16_buffer(f16_u8_unorm_table, u8, got, size); break;
+                    case 1:  ik->u8_to_f16_buffer(f16_u8_srgb_table, u8, got, size); break;
+                    case 2:  ik->u16_unorm_to_f16_buffer(u16, got, size); break;
+                    default: ik->i16_to_f16_buffer((int16_t*)u16, got, size); break;
+                }
+                for (int i = 0; i < size; i++) {
+                    uint16_t want;
+                    switch (which) {
+                        case 0:  want = f16_u8_unorm_table[u8[i]]; break;
+                        case 1:  want = f16_u8_srgb_table[u8[i]]; break;
+                        case 2:  want = expect_unorm[u16[i]]; break;
+                        default: want = expect_i16[u16[i]]; break;
+                    }
+                    error[k] += got[i] != want;
+                }
+                error[k] += guard_check(got + size, sizeof(uint16_t), GUARD_COUNT);
+            }
+        }
+    }
 
-                if (j == 1)
-                    inf_total++;
+    printf("%-20s : %u mismatches\n", "u8 tables", table_error);
+    printf("u8, u16 / 65535 and i16 match exact rounding, out of %u:\n", total);
+    fprintf(f, "\nerror_test,u8 u16 and i16 match exact rounding\nname,error,total\n");
+    for (size_t k = 0; k < integer_test_count; k++) {
+        const F16IntegerKernel *ik = integer_tests[k];
+        PRINT_ERROR_RESULT(ik->name, error[k], total);
+    }
 
-                inf_error[j] += e;
+done:
+    free(u8);
+    free(u16);
+    free(expect_unorm);
+    free(expect_i16);
+    free(got);
+}
 
-            } else {
-                // value can be mapped to a f16 normal number or denormal
+#define REPRESENTABLE_SMALL 21
 
-                // float v = f16_to_f32_hw(r0);
-                // assert(!(isinf(v) || isnan(v)));
+// every float32 value in chunks like test_rounding_modes. f32_fits_f16 is checked against
+// a round trip through the reference, then each kernel scans every chunk and restarts
+// just past each float it reports. short buffers get one bad float at every position
+void test_representable_scan(FILE *f, const F16Kernel *reference, unsigned int cpu_flags)
+{
+    const F16Kernel *widen = f16_kernel_find(F16_F16_TO_F32, reference->name, cpu_flags);
+    uint32_t *src = (uint32_t*) malloc(sizeof(uint32_t) * ROUND_CHUNK_SIZE);
+    uint16_t *half = (uint16_t*) malloc(sizeof(uint16_t) * ROUND_CHUNK_SIZE);
+    uint32_t *back = (uint32_t*) malloc(sizeof(uint32_t) * ROUND_CHUNK_SIZE);
+    uint32_t error[F16_MAX_KERNELS] = {0};
+    uint32_t fits_error = 0;
+    uint32_t small_total = 0;
+    double total;
+
+    if (!widen)
+        widen = f16_kernel_find(F16_F16_TO_F32, "static_table", cpu_flags);
+
+    if (!src || !half || !back) {
+        printf("malloc error\n");
+        goto done;
+    }
 
-                if (j == 1)
-                    half_total++;
+    for (uint64_t base = 0; base <= UINT32_MAX; base += ROUND_CHUNK_SIZE) {
+        for (int i = 0; i < ROUND_CHUNK_SIZE; i++) {
+            src[i] = (uint32_t)(base + i);
+        }
 
-                half_error[j] += e;
+        reference->f32_to_f16_buffer(src, half, ROUND_CHUNK_SIZE);
+        widen->f16_to_f32_buffer(half, back, ROUND_CHUNK_SIZE);
+        for (int i = 0; i < ROUND_CHUNK_SIZE; i++) {
+            // only hardware keeps nan payloads, the others can't say which nans come back
+            if (reference->nan != F16_NAN_HARDWARE && (src[i] & 0x7FFFFFFF) > 0x7F800000)
+                continue;
+            fits_error += (back[i] == src[i]) != f32_fits_f16(src[i]);
+        }
 
+        for (size_t k = 0; k < representable_test_count; k++) {
+            const F16RepresentableKernel *rk = representable_tests[k];
+            int pos = 0;
+
+            while (pos < ROUND_CHUNK_SIZE) {
+                int want = pos;
+                int got = pos + rk->f32_find_inexact_f16(src + pos, ROUND_CHUNK_SIZE - pos);
+                while (want < ROUND_CHUNK_SIZE && f32_fits_f16(src[want]))
+                    want++;
+                if (got != want) {
+                    error[k]++;
+                    got = want;
+                }
+                pos = got + 1;
             }
         }
 
-        if ((i % 0x10000000 ) == 0){
-            printf("\r %4.1f%%", 100.0 * i/(double)UINT32_MAX);
+        if ((base % 0x10000000 ) == 0){
+            printf("\r %4.1f%%", 100.0 * base/(double)UINT32_MAX);
             fflush(stdout);
         }
     }
 
-    printf("\rnormal and denormal value matches hardware, out of %u:\n", half_total);
-    fprintf(f, "\nerror_test,normal and denormal value matches hardware\nname,error,total\n");
-
-    for (size_t i = 1; i < TEST_COUNT; i++) {
-        PRINT_ERROR_RESULT(f16_tests[i].name, half_error[i], half_total);
+    // halves as floats with 1 + 2^-23 at every position, or at none
+    for (int i = 0; i < ROUND_CHUNK_SIZE; i++) {
+        half[i] = (uint16_t)(i * 40503);
+    }
+    widen->f16_to_f32_buffer(half, back, ROUND_CHUNK_SIZE);
+    for (int n = 0; n <= REPRESENTABLE_SMALL; n++) {
+        for (int bad = 0; bad <= n; bad++) {
+            for (int i = 0; i < n; i++) {
+                src[i] = i == bad ? 0x3F800001 : back[n * REPRESENTABLE_SMALL + bad * n + i];
+            }
+            small_total++;
+
+            for (size_t k = 0; k < representable_test_count; k++) {
+                const F16RepresentableKernel *rk = representable_tests[k];
+                int want = 0;
+                while (want < n && f32_fits_f16(src[want]))
+                    want++;
+                error[k] += rk->f32_find_inexact_f16(src, n) != want;
+            }
+        }
     }
 
-    printf("\nnan value exactly matches hardware, out of %u:\n", nan_total);
-    fprintf(f, "\nerror_test,nan value exactly matches hardware\nname,error,total\n");
-
-    for (size_t i = 1; i < TEST_COUNT; i++) {
-        PRINT_ERROR_RESULT(f16_tests[i].name, nan_exact_error[i], nan_total);
+    printf("\r%-20s : %u mismatches against %s\n", "f32_fits_f16", fits_error, reference->name);
+    total = (double)UINT32_MAX + 1.0 + small_total;
+    printf("first inexact float matches f32_fits_f16, out of %.0f:\n", total);
+    fprintf(f, "\nerror_test,first inexact float matches f32_fits_f16\nname,error,total\n");
+    for (size_t k = 0; k < representable_test_count; k++) {
+        const F16RepresentableKernel *rk = representable_tests[k];
+        PRINT_ERROR_RESULT(rk->name, error[k], total);
     }
 
-    printf("\nnan is a nan value but might not match hardware, out of %u:\n", nan_total);
-    fprintf(f, "\nerror_test,nan is a nan value but might not match hardware\nname,error,total\n");
+done:
+    free(src);
+    free(half);
+    free(back);
+}
 
-    for (size_t i = 1; i < TEST_COUNT; i++) {
-        PRINT_ERROR_RESULT(f16_tests[i].name, nan_error[i], nan_total);
-    }
+#define INTEGER_CHUNK 256
 
-    printf("\n+/-inf value matches hardware, out of %u:\n", inf_total);
-    fprintf(f, "\nerror_test,+/-inf value matches hardware\nname,error,total\n");
+// what ingest does today, the integers to a float buffer and then the float kernel
+static void u8_to_f16_through_f32(const F16Kernel *k, uint8_t *data, uint16_t *result, int data_size)
+{
+    uint32_t buf[INTEGER_CHUNK];
+    int_float v;
+
+    for (int i = 0; i < data_size; i += INTEGER_CHUNK) {
+        int n = data_size - i < INTEGER_CHUNK ? data_size - i : INTEGER_CHUNK;
+        for (int j = 0; j < n; j++) {
+            v.f = data[i + j] * (1.0f / 255.0f);
+            buf[j] = v.u;
+        }
+        k->f32_to_f16_buffer(buf, result + i, n);
+    }
+}
 
-    for (size_t i = 1; i < TEST_COUNT; i++) {
-        PRINT_ERROR_RESULT(f16_tests[i].name, inf_error[i], inf_total);
+static void u16_unorm_to_f16_through_f32(const F16Kernel *k, uint16_t *data, uint16_t *result, int data_size)
+{
+    uint32_t buf[INTEGER_CHUNK];
+    int_float v;
+
+    for (int i = 0; i < data_size; i += INTEGER_CHUNK) {
+        int n = data_size - i < INTEGER_CHUNK ? data_size - i : INTEGER_CHUNK;
+        for (int j = 0; j < n; j++) {
+            v.f = data[i + j] * (1.0f / 65535.0f);
+            buf[j] = v.u;
+        }
+        k->f32_to_f16_buffer(buf, result + i, n);
     }
+}
 
-    printf("\ntotal exact hardware match:\n");
-    fprintf(f, "\nerror_test,total exact hardware match\nname,error,total\n");
+static void i16_to_f16_through_f32(const F16Kernel *k, int16_t *data, uint16_t *result, int data_size)
+{
+    uint32_t buf[INTEGER_CHUNK];
+    int_float v;
+
+    for (int i = 0; i < data_size; i += INTEGER_CHUNK) {
+        int n = data_size - i < INTEGER_CHUNK ? data_size - i : INTEGER_CHUNK;
+        for (int j = 0; j < n; j++) {
+            v.f = (float)data[i + j];
+            buf[j] = v.u;
+        }
+        k->f32_to_f16_buffer(buf, result + i, n);
+    }
+}
 
-    for (size_t i = 1; i < TEST_COUNT; i++) {
-        PRINT_ERROR_RESULT(f16_tests[i].name, full_error[i], UINT32_MAX);
+// what a caller does without the scan, the whole buffer to half and back and then compared
+static int f32_find_inexact_f16_round_trip(const F16Kernel *k, const F16Kernel *widen, uint32_t *data, uint16_t *half, uint32_t *back, int data_size)
+{
+    k->f32_to_f16_buffer(data, half, data_size);
+    widen->f16_to_f32_buffer(half, back, data_size);
+    for (int i = 0; i < data_size; i++) {
+        if (back[i] != data[i])
+            return i;
     }
+    return data_size;
+}
+
+static void f32_to_f16_scale_bias_two_pass(const F16Kernel *k, uint32_t *data, uint32_t *scratch, uint16_t *result, int data_size, const float scale[4], const float bias[4])
+{
+    f32_scale_bias(data, scratch, data_size, scale, bias);
+    k->f32_to_f16_buffer(scratch, result, data_size);
 }
 
-#define TIME_FUNC(name, func, buffer_size, runs)                            \
+// call is evaluated once per run with ptr pointing at that run's data
+#define TIME_CALL(name, call, buffer_size, runs)                            \
     min_value = INFINITY;                                                   \
     max_value = -INFINITY;                                                  \
     average = 0.0;                                                          \
     ptr = data;                                                             \
-    for (size_t j = 0; j < runs; j++) {                                        \
+    for (size_t j = 0; j < runs; j++) {                                     \
         start = get_timer();                                                \
-        func(ptr, result, buffer_size);                                     \
+        call;                                                               \
         elapse = (double)((get_timer() - start)) / (double)freq;            \
         min_value = MIN(min_value, elapse);                                 \
         max_value = MAX(max_value, elapse);                                 \
@@ -202,6 +1433,128 @@ void test_hardware_accuracy(FILE *f, int has_hardware_f16)
     printf("%-20s : %f %f %f secs\n", name, min_value, average, max_value); \
     fprintf(f, "%s,%f,%f,%f\n", name, min_value, average, max_value)
 
+#define TIME_FUNC(name, func, buffer_size, runs) \
+    TIME_CALL(name, func(ptr, result, buffer_size), buffer_size, runs)
+
+static Autotune tune;
+
+// only kernels that give the same bits as hardware, so the autotuned output doesn't depend on the machine
+static const F16Kernel *autotune_tests[F16_MAX_KERNELS];
+static size_t autotune_test_count = 0;
+
+typedef struct AutotuneBuffers {
+    uint32_t *data;
+    uint16_t *result;
+} AutotuneBuffers;
+
+static void autotune_run_test(void *ctx, int kernel, int size)
+{
+    AutotuneBuffers *b = (AutotuneBuffers*)ctx;
+    autotune_tests[kernel]->f32_to_f16_buffer(b->data, b->result, size);
+}
+
+// dispatches to the fastest kernel measured for the size class
+static void f32_to_f16_buffer_autotuned(uint32_t *data, uint16_t *result, int data_size)
+{
+    int kernel = tune.winners[autotune_size_class(data_size)];
+    autotune_tests[kernel]->f32_to_f16_buffer(data, result, data_size);
+}
+
+static int run_autotune(const char *cache_path, const char *cpu_key)
+{
+    const char *names[F16_MAX_KERNELS] = {0};
+    char key[512];
+    AutotuneBuffers b;
+    int size = autotune_sizes[AUTOTUNE_SIZE_CLASSES - 1];
+    int err = 0;
+
+    autotune_test_count = 0;
+    for (size_t i = 0; i < test_count; i++) {
+        if (f16_kernel_matches_hardware(f16_tests[i])) {
+            names[autotune_test_count] = f16_tests[i]->name;
+            autotune_tests[autotune_test_count++] = f16_tests[i];
+        }
+    }
+    if (!autotune_test_count)
+        return -1;
+    autotune_key(key, sizeof(key), cpu_key, __DATE__ " " __TIME__, names, (int)autotune_test_count);
+
+    if (autotune_load(&tune, cache_path, key, "f32_to_f16", names, (int)autotune_test_count)) {
+        b.data = (uint32_t*) malloc(sizeof(uint32_t) * size);
+        b.result = (uint16_t*) malloc(sizeof(uint16_t) * size);
+
+        if (!b.data || !b.result) {
+            free(b.data);
+            free(b.result);
+            return -1;
+        }
+
+        randomize_buffer_u32(b.data, size, 1);
+        err = autotune_measure(&tune, names, (int)autotune_test_count, autotune_run_test, &b);
+        if (!err && autotune_save(&tune, cache_path, key, "f32_to_f16", names))
+            printf("unable to write autotune cache: %s\n", cache_path);
+
+        free(b.data);
+        free(b.result);
+        if (err)
+            return err;
+    }
+
+    printf("\nautotune %s, cache file: %s\n", tune.from_cache ? "loaded from cache" : "measured", cache_path);
+    for (int i = 0; i < AUTOTUNE_SIZE_CLASSES; i++) {
+        printf("size <= %-12d : %s\n", autotune_sizes[i], autotune_tests[tune.winners[i]]->name);
+    }
+    return 0;
+}
+
+void test_autotune(FILE *f, const F16Kernel *reference)
+{
+    int size = autotune_sizes[AUTOTUNE_SIZE_CLASSES - 1];
+    uint32_t *src = (uint32_t*) malloc(sizeof(uint32_t) * size);
+    uint16_t *want = (uint16_t*) malloc(sizeof(uint16_t) * size);
+    uint16_t *got = (uint16_t*) malloc(sizeof(uint16_t) * size);
+    uint32_t candidate_error = 0;
+    uint32_t winner_error = 0;
+    uint32_t value_error = 0;
+    double candidate_total = (double)autotune_test_count;
+    double winner_total = AUTOTUNE_SIZE_CLASSES;
+    double value_total = 0.0;
+
+    if (!src || !want || !got) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    for (size_t i = 0; i < autotune_test_count; i++) {
+        candidate_error += !f16_kernel_matches_hardware(autotune_tests[i]);
+    }
+
+    // every class at its own size, so each winner converts a buffer it was picked for
+    randomize_buffer_u32(src, size, 0);
+    for (int c = 0; c < AUTOTUNE_SIZE_CLASSES; c++) {
+        int n = autotune_sizes[c];
+        winner_error += !f16_kernel_matches_hardware(autotune_tests[tune.winners[c]]);
+
+        reference->f32_to_f16_buffer(src, want, n);
+        f32_to_f16_buffer_autotuned(src, got, n);
+        for (int i = 0; i < n; i++) {
+            value_error += got[i] != want[i];
+        }
+        value_total += n;
+    }
+
+    fprintf(f, "\nerror_test,autotune only picks kernels that match hardware\nname,error,total\n");
+    PRINT_ERROR_RESULT("candidates", candidate_error, candidate_total);
+    PRINT_ERROR_RESULT("winners", winner_error, winner_total);
+    fprintf(f, "\nerror_test,autotuned matches %s\nname,error,total\n", reference->name);
+    PRINT_ERROR_RESULT("autotuned", value_error, value_total);
+
+done:
+    free(src);
+    free(want);
+    free(got);
+}
+
 int main(int argc, char *argv[])
 {
     uint64_t freq = get_timer_frequency();
@@ -211,15 +1564,32 @@ int main(int argc, char *argv[])
     double min_value;
     double max_value;
     uint32_t *ptr;
-    int has_hardware_f16 = 1;
-    int first = 0;
+    unsigned int cpu_flags = f16_cpu_flags();
+    const F16Kernel *reference;
+    double quiet_average[F16_MAX_KERNELS] = {0};
+    double noisy_average[F16_MAX_KERNELS] = {0};
 
     FILE *f = NULL;
     char *csv_path = NULL;
+    char *autotune_cache = AUTOTUNE_DEFAULT_CACHE;
+    char cpu_key[256];
+    int autotuned;
+
+    NoisyNeighborOptions noisy;
+    int noisy_arg;
+    noisy_neighbor_default_options(&noisy);
+
+    for (int i = 1; i < argc; i++) {
+        if (!strncmp(argv[i], "--autotune-cache=", 17))
+            autotune_cache = argv[i] + 17;
+        else if ((noisy_arg = noisy_neighbor_parse_arg(&noisy, argv[i])) < 0) {
+            printf("invalid value: %s\n", argv[i]);
+            return -1;
+        } else if (!noisy_arg)
+            csv_path = argv[i];
+    }
 
-    if (argc > 1)
-        csv_path = argv[1];
-    else
+    if (!csv_path)
         csv_path = "float2half_result.csv";
 
     f = fopen(csv_path,"wb");
@@ -232,25 +1602,50 @@ int main(int argc, char *argv[])
     // print cpu name and check for f16c instruction
     CPUInfo info = {0};
     get_cpu_info(&info);
+    snprintf(cpu_key, sizeof(cpu_key), "%s 0x%08x", info.name, info.flags);
     printf("CPU: %s %s %s\n", CPU_ARCH, info.name, info.extensions);
     fprintf(f, "%s,%s,%s\n", CPU_ARCH, info.name, info.extensions);
 
-    has_hardware_f16 = info.flags & X86_CPU_FLAG_F16C;
-    if (!has_hardware_f16) {
+    if (!(cpu_flags & F16_CPU_F16C)) {
         printf("** CPU does not support f16c instruction, skipping some tests **\n");
-        first = 1;
     }
 #else
+    snprintf(cpu_key, sizeof(cpu_key), "%s", get_cpu_model_name());
     printf("CPU: %s %s\n", CPU_ARCH, get_cpu_model_name());
     fprintf(f, "%s,%s\n", CPU_ARCH, get_cpu_model_name());
 #endif
 
     printf("%s %s\n", get_platform_name(), COMPILER_NAME);
-    fprintf(f, "%s,%s\n", get_platform_name(), COMPILER_NAME);
+    fprintf(f, "%s,%s,%s\n", get_platform_name(), COMPILER_NAME, get_target_clone_name());
+    printf("scalar kernels dispatched to target clone: %s\n", get_target_clone_name());
     printf("csv file: %s\n", csv_path);
 
-    init_tables();
-    init_table_round();
+    test_count = f16_kernel_select(F16_F32_TO_F16, cpu_flags, f16_tests, F16_MAX_KERNELS);
+    bf16_test_count = f16_kernel_select(F16_F32_TO_BF16, cpu_flags, bf16_tests, F16_MAX_KERNELS);
+    stochastic_test_count = f16_stochastic_kernel_select(cpu_flags, stochastic_tests, F16_MAX_KERNELS);
+    double_test_count = f16_double_kernel_select(cpu_flags, double_tests, F16_MAX_KERNELS);
+    inplace_test_count = f16_inplace_kernel_select(cpu_flags, inplace_tests, F16_MAX_KERNELS);
+    image_test_count = f16_image_kernel_select(cpu_flags, image_tests, F16_MAX_KERNELS);
+    channel_test_count = f16_channel_kernel_select(cpu_flags, channel_tests, F16_MAX_KERNELS);
+    scale_bias_test_count = f16_scale_bias_kernel_select(cpu_flags, scale_bias_tests, F16_MAX_KERNELS);
+    integer_test_count = f16_integer_kernel_select(cpu_flags, integer_tests, F16_MAX_KERNELS);
+    representable_test_count = f16_representable_kernel_select(cpu_flags, representable_tests, F16_MAX_KERNELS);
+    f16_integer_init();
+
+    printf("\n%-20s : %-14s %-8s %s\n", "kernel", "rounding", "nan", "width");
+    for (size_t i = 0; i < test_count; i++) {
+        printf("%-20s : %-14s %-8s %d\n", f16_tests[i]->name, f16_rounding_name(f16_tests[i]->rounding),
+               f16_nan_name(f16_tests[i]->nan), f16_tests[i]->vector_width);
+    }
+    for (size_t i = 0; i < bf16_test_count; i++) {
+        printf("%-20s : %-14s %-8s %d\n", bf16_tests[i]->name, f16_rounding_name(bf16_tests[i]->rounding),
+               f16_nan_name(bf16_tests[i]->nan), bf16_tests[i]->vector_width);
+    }
+
+    // the winners are unset if it fails, so the autotuned runs are skipped
+    autotuned = !run_autotune(autotune_cache, cpu_key);
+    if (!autotuned)
+        printf("autotune failed, skipping the autotuned runs\n");
 
 
 #if 1
@@ -269,8 +1664,11 @@ int main(int argc, char *argv[])
 
     printf("%-20s :      min      avg     max\n", "name");
     fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f32 <= HALF_MAX", "name", "min", "avg", "max");
-    for (size_t i = first; i < TEST_COUNT; i++) {
-        TIME_FUNC(f16_tests[i].name, f16_tests[i].f32_to_f16_buffer, BUFFER_SIZE, TEST_RUNS);
+    for (size_t i = 0; i < test_count; i++) {
+        TIME_FUNC(f16_tests[i]->name, f16_tests[i]->f32_to_f16_buffer, BUFFER_SIZE, TEST_RUNS);
+    }
+    if (autotuned) {
+        TIME_FUNC("autotuned", f32_to_f16_buffer_autotuned, BUFFER_SIZE, TEST_RUNS);
     }
 
     fflush(stdout);
@@ -282,9 +1680,315 @@ int main(int argc, char *argv[])
 
     printf("%-20s :      min      avg     max\n", "name");
     fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f32 full +inf+nan", "name", "min", "avg", "max");
-    for (size_t i = first; i < TEST_COUNT; i++) {
-        TIME_FUNC(f16_tests[i].name, f16_tests[i].f32_to_f16_buffer, BUFFER_SIZE, TEST_RUNS);
+    for (size_t i = 0; i < test_count; i++) {
+        TIME_FUNC(f16_tests[i]->name, f16_tests[i]->f32_to_f16_buffer, BUFFER_SIZE, TEST_RUNS);
+        quiet_average[i] = average;
+    }
+    if (autotuned) {
+        TIME_FUNC("autotuned", f32_to_f16_buffer_autotuned, BUFFER_SIZE, TEST_RUNS);
+    }
+
+    printf("\r\nruns: %d, buffer size: %d, random f32 full +inf+nan, directed rounding\n\n", TEST_RUNS, BUFFER_SIZE);
+    printf("%-20s :      min      avg     max\n", "name");
+    fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f32 full +inf+nan directed rounding", "name", "min", "avg", "max");
+    for (size_t m = 0; m < ARRAY_SIZE(round_modes); m++) {
+        for (size_t i = 0; i < test_count; i++) {
+            char name[64];
+            if (!f16_tests[i]->f32_to_f16_buffer_mode)
+                continue;
+            snprintf(name, sizeof(name), "%s %s", f16_tests[i]->name, round_modes[m].suffix);
+            TIME_CALL(name, f16_tests[i]->f32_to_f16_buffer_mode(ptr, result, BUFFER_SIZE, round_modes[m].mode), BUFFER_SIZE, TEST_RUNS);
+        }
+    }
+
+    printf("\r\nruns: %d, buffer size: %d, random f32 full +inf+nan, saturate and nan to zero\n\n", TEST_RUNS, BUFFER_SIZE);
+    printf("%-20s :      min      avg     max\n", "name");
+    fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f32 full +inf+nan saturate and nan to zero", "name", "min", "avg", "max");
+    for (size_t i = 0; i < test_count; i++) {
+        char name[64];
+        if (!f16_tests[i]->f32_to_f16_buffer_special)
+            continue;
+        snprintf(name, sizeof(name), "%s %s", f16_tests[i]->name, special_modes[0].suffix);
+        TIME_CALL(name, f16_tests[i]->f32_to_f16_buffer_special(ptr, result, BUFFER_SIZE, special_modes[0].flags), BUFFER_SIZE, TEST_RUNS);
+        snprintf(name, sizeof(name), "%s 2 pass", f16_tests[i]->name);
+        TIME_CALL(name, f32_to_f16_buffer_two_pass_special(f16_tests[i], ptr, result, BUFFER_SIZE, special_modes[0].flags), BUFFER_SIZE, TEST_RUNS);
+    }
+
+    printf("\r\nruns: %d, buffer size: %d, random f32 full +inf+nan, conversion stats\n\n", TEST_RUNS, BUFFER_SIZE);
+    printf("%-20s :      min      avg     max\n", "name");
+    fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f32 full +inf+nan conversion stats", "name", "min", "avg", "max");
+    for (size_t i = 0; i < test_count; i++) {
+        char name[64];
+        F16ConvertStats stats;
+        if (!f16_tests[i]->f32_to_f16_buffer_stats)
+            continue;
+        snprintf(name, sizeof(name), "%s stats", f16_tests[i]->name);
+        TIME_CALL(name, f16_tests[i]->f32_to_f16_buffer_stats(ptr, result, BUFFER_SIZE, &stats), BUFFER_SIZE, TEST_RUNS);
+        snprintf(name, sizeof(name), "%s 2 pass", f16_tests[i]->name);
+        TIME_CALL(name, f32_to_f16_buffer_two_pass_stats(f16_tests[i], ptr, result, BUFFER_SIZE, &stats), BUFFER_SIZE, TEST_RUNS);
+    }
+
+    printf("\r\nruns: %d, buffer size: %d, random f32 full +inf+nan, stochastic rounding\n\n", TEST_RUNS, BUFFER_SIZE);
+    printf("%-20s :      min      avg     max\n", "name");
+    fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f32 full +inf+nan stochastic rounding", "name", "min", "avg", "max");
+    for (size_t k = 0; k < stochastic_test_count; k++) {
+        const F16StochasticKernel *s = stochastic_tests[k];
+        F16StochasticState state;
+        f16_stochastic_seed(&state, (uint64_t)time(NULL), k);
+        TIME_CALL(s->name, s->f32_to_f16_buffer(&state, ptr, result, BUFFER_SIZE), BUFFER_SIZE, TEST_RUNS);
+    }
+
+    printf("\r\nruns: %d, buffer size: %d, random f32 full +inf+nan, bf16\n\n", TEST_RUNS, BUFFER_SIZE);
+    printf("%-20s :      min      avg     max\n", "name");
+    fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f32 full +inf+nan bf16", "name", "min", "avg", "max");
+    for (size_t i = 0; i < bf16_test_count; i++) {
+        TIME_FUNC(bf16_tests[i]->name, bf16_tests[i]->f32_to_f16_buffer, BUFFER_SIZE, TEST_RUNS);
+    }
+
+    if (noisy.enabled) {
+        // rerun the same data while another thread keeps evicting our cache lines
+        if (noisy_neighbor_start(&noisy)) {
+            printf("unable to start noisy neighbor\n");
+        } else {
+            printf("\r\nruns: %d, buffer size: %d, random f32 full +inf+nan, noisy neighbor thrashing %d KB\n", TEST_RUNS, BUFFER_SIZE, (int)(noisy.size / 1024));
+            printf("co-runner: %s\n\n", noisy_neighbor_placement());
+
+            printf("%-20s :      min      avg     max\n", "name");
+            fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f32 full +inf+nan noisy neighbor", "name", "min", "avg", "max");
+            for (size_t i = 0; i < test_count; i++) {
+                TIME_FUNC(f16_tests[i]->name, f16_tests[i]->f32_to_f16_buffer, BUFFER_SIZE, TEST_RUNS);
+                noisy_average[i] = average;
+            }
+            noisy_neighbor_stop();
+
+            printf("\nslowdown against quiet run:\n");
+            fprintf(f, "\nnoisy_test,slowdown against quiet run\nname,quiet,noisy,slowdown\n");
+            for (size_t i = 0; i < test_count; i++) {
+                double slowdown = noisy_average[i] / quiet_average[i];
+                printf("%-20s : %5.2fx\n", f16_tests[i]->name, slowdown);
+                fprintf(f, "%s,%f,%f,%f\n", f16_tests[i]->name, quiet_average[i], noisy_average[i], slowdown);
+            }
+        }
+    }
+
+    {
+        // the frame is 1920x1080 rgba, result holds the 4 planes back to back
+        const int width = 1920;
+        const int height = BUFFER_SIZE / (width * 4);
+        const F16Kernel *image_reference = f16_kernel_find(F16_F32_TO_F16, "hardware", cpu_flags);
+        uint32_t *scratch = (uint32_t*) alloc_perf_buffer(sizeof(uint32_t) * BUFFER_SIZE);
+        uint16_t *planes[4];
+        char name[64];
+
+        if (!image_reference)
+            image_reference = f16_kernel_find(F16_F32_TO_F16, "no table", cpu_flags);
+
+        for (int c = 0; c < 4; c++) {
+            planes[c] = result + c * width * height;
+        }
+
+        printf("\r\nruns: %d, buffer size: %d, random f32 full +inf+nan, rgba to planar %dx%d\n\n", TEST_RUNS, BUFFER_SIZE, width, height);
+        printf("%-20s :      min      avg     max\n", "name");
+        fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f32 full +inf+nan rgba to planar", "name", "min", "avg", "max");
+        for (size_t k = 0; k < image_test_count; k++) {
+            const F16ImageKernel *img = image_tests[k];
+            if (!img->f32_rgba_to_f16_planar)
+                continue;
+            snprintf(name, sizeof(name), "%s planar", img->name);
+            TIME_CALL(name, img->f32_rgba_to_f16_planar(ptr, width * 16, planes, width * 2, width, height), BUFFER_SIZE, TEST_RUNS);
+        }
+        TIME_CALL("generic planar", f32_rgba_to_f16_planar(image_reference->f32_to_f16_buffer, ptr, width * 16, planes, width * 2, width, height), BUFFER_SIZE, TEST_RUNS);
+        if (scratch) {
+            snprintf(name, sizeof(name), "%s 2 pass", image_reference->name);
+            TIME_CALL(name, f32_rgba_to_f16_planar_two_pass(image_reference, ptr, scratch, result, width * height), BUFFER_SIZE, TEST_RUNS);
+        }
+
+        // the last 16 pixels of each row are padding
+        snprintf(name, sizeof(name), "%s 2d", image_reference->name);
+        TIME_CALL(name, f32_to_f16_image(image_reference->f32_to_f16_buffer, ptr, width * 16, result, width * 8, (width - 16) * 4, height), BUFFER_SIZE, TEST_RUNS);
+
+        free(scratch);
+    }
+
+    {
+        const int pixels = BUFFER_SIZE / 4;
+        uint16_t *scratch = (uint16_t*) alloc_perf_buffer(sizeof(uint16_t) * BUFFER_SIZE);
+        char name[64];
+
+        printf("\r\nruns: %d, buffer size: %d, random f32 full +inf+nan, rgb from rgba\n\n", TEST_RUNS, BUFFER_SIZE);
+        printf("%-20s :      min      avg     max\n", "name");
+        fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f32 full +inf+nan rgb from rgba", "name", "min", "avg", "max");
+        for (size_t k = 0; k < channel_test_count; k++) {
+            const F16ChannelKernel *ch = channel_tests[k];
+            const F16Kernel *plain = f16_kernel_find(F16_F32_TO_F16, ch->name, cpu_flags);
+            if (!plain)
+                continue;
+            snprintf(name, sizeof(name), "%s rgb", ch->name);
+            TIME_CALL(name, ch->f32_to_f16_channels(ptr, result, pixels, F16_CHANNELS_RGB), BUFFER_SIZE, TEST_RUNS);
+            if (scratch) {
+                snprintf(name, sizeof(name), "%s 2 pass", ch->name);
+                TIME_CALL(name, f32_to_f16_channels_two_pass(plain, ptr, scratch, result, pixels, F16_CHANNELS_RGB), BUFFER_SIZE, TEST_RUNS);
+            }
+        }
+
+        free(scratch);
+    }
+
+    {
+        const float scale[4] = {1.5f, 0.8f, 2.0f, 1.0f};
+        const float bias[4] = {0.1f, -0.2f, 0.0f, 0.0f};
+        uint32_t *scratch = (uint32_t*) alloc_perf_buffer(sizeof(uint32_t) * BUFFER_SIZE);
+        char name[64];
+
+        printf("\r\nruns: %d, buffer size: %d, random f32 full +inf+nan, scale and bias\n\n", TEST_RUNS, BUFFER_SIZE);
+        printf("%-20s :      min      avg     max\n", "name");
+        fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f32 full +inf+nan scale and bias", "name", "min", "avg", "max");
+        for (size_t k = 0; k < scale_bias_test_count; k++) {
+            const F16ScaleBiasKernel *sb = scale_bias_tests[k];
+            const F16Kernel *plain = f16_kernel_find(F16_F32_TO_F16, sb->name, cpu_flags);
+            if (!plain)
+                continue;
+            snprintf(name, sizeof(name), "%s scale bias", sb->name);
+            TIME_CALL(name, sb->f32_to_f16_buffer_scale_bias(ptr, result, BUFFER_SIZE, scale[0], bias[0]), BUFFER_SIZE, TEST_RUNS);
+            snprintf(name, sizeof(name), "%s per channel", sb->name);
+            TIME_CALL(name, sb->f32_to_f16_buffer_scale_bias4(ptr, result, BUFFER_SIZE, scale, bias), BUFFER_SIZE, TEST_RUNS);
+            if (scratch) {
+                snprintf(name, sizeof(name), "%s 2 pass", sb->name);
+                TIME_CALL(name, f32_to_f16_scale_bias_two_pass(plain, ptr, scratch, result, BUFFER_SIZE, scale, bias), BUFFER_SIZE, TEST_RUNS);
+            }
+        }
+
+        free(scratch);
+    }
+
+    {
+        // the random floats reinterpreted as bytes and shorts, every bit pattern is a valid input
+        const F16Kernel *plain = f16_kernel_find(F16_F32_TO_F16, "hardware", cpu_flags);
+        char name[64];
+
+        if (!plain)
+            plain = f16_kernel_find(F16_F32_TO_F16, "no table", cpu_flags);
+
+        printf("\r\nruns: %d, buffer size: %d, random u8 u16 i16\n\n", TEST_RUNS, BUFFER_SIZE);
+        printf("%-20s :      min      avg     max\n", "name");
+        fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random u8 u16 i16", "name", "min", "avg", "max");
+        for (size_t k = 0; k < integer_test_count; k++) {
+            const F16IntegerKernel *ik = integer_tests[k];
+            snprintf(name, sizeof(name), "%s u8", ik->name);
+            TIME_CALL(name, ik->u8_to_f16_buffer(f16_u8_unorm_table, (uint8_t*)ptr, result, BUFFER_SIZE), BUFFER_SIZE / 4, TEST_RUNS);
+            snprintf(name, sizeof(name), "%s u8 srgb", ik->name);
+            TIME_CALL(name, ik->u8_to_f16_buffer(f16_u8_srgb_table, (uint8_t*)ptr, result, BUFFER_SIZE), BUFFER_SIZE / 4, TEST_RUNS);
+            snprintf(name, sizeof(name), "%s u16", ik->name);
+            TIME_CALL(name, ik->u16_unorm_to_f16_buffer((uint16_t*)ptr, result, BUFFER_SIZE), BUFFER_SIZE / 2, TEST_RUNS);
+            snprintf(name, sizeof(name), "%s i16", ik->name);
+            TIME_CALL(name, ik->i16_to_f16_buffer((int16_t*)ptr, result, BUFFER_SIZE), BUFFER_SIZE / 2, TEST_RUNS);
+        }
+        snprintf(name, sizeof(name), "%s u8 via f32", plain->name);
+        TIME_CALL(name, u8_to_f16_through_f32(plain, (uint8_t*)ptr, result, BUFFER_SIZE), BUFFER_SIZE / 4, TEST_RUNS);
+        snprintf(name, sizeof(name), "%s u16 via f32", plain->name);
+        TIME_CALL(name, u16_unorm_to_f16_through_f32(plain, (uint16_t*)ptr, result, BUFFER_SIZE), BUFFER_SIZE / 2, TEST_RUNS);
+        snprintf(name, sizeof(name), "%s i16 via f32", plain->name);
+        TIME_CALL(name, i16_to_f16_through_f32(plain, (int16_t*)ptr, result, BUFFER_SIZE), BUFFER_SIZE / 2, TEST_RUNS);
+    }
+
+    {
+        // random floats would stop the scan within the first few. random halves with one float
+        // that is not a half three quarters in show the early exit against the round trip,
+        // which converts everything anyway. a frame that was stored as half is read to the end
+        const int inexact_at = BUFFER_SIZE - BUFFER_SIZE / 4 + 3;
+        const int width = 1920;
+        const int height = BUFFER_SIZE / (width * 4);
+        const F16Kernel *plain = f16_kernel_find(F16_F32_TO_F16, "hardware", cpu_flags);
+        const F16Kernel *widen = f16_kernel_find(F16_F16_TO_F32, "hardware", cpu_flags);
+        uint32_t *scratch = (uint32_t*) alloc_perf_buffer(sizeof(uint32_t) * BUFFER_SIZE);
+        char name[64];
+
+        if (!plain)
+            plain = f16_kernel_find(F16_F32_TO_F16, "no table", cpu_flags);
+        if (!widen)
+            widen = f16_kernel_find(F16_F16_TO_F32, "static_table", cpu_flags);
+
+        for (int pass = 0; pass < 2; pass++) {
+            const char *label = pass == 0 ? "random f32 from half, first inexact at 3/4" : "rgba frame from half, first inexact";
+
+            if (pass == 0) {
+                int_float v;
+                for (size_t i = 0; i < (size_t)BUFFER_SIZE * TEST_RUNS; i++) {
+                    uint16_t h = (uint16_t)rand();
+                    // inf and nan come back too, but keep to finite values like a real buffer
+                    if ((h & 0x7C00) == 0x7C00)
+                        h ^= 0x4000;
+                    v.f = widen->f16_to_f32(h);
+                    data[i] = v.u;
+                }
+                for (int r = 0; r < TEST_RUNS; r++) {
+                    // 1 + 2^-23 needs all 24 float bits
+                    data[(size_t)r * BUFFER_SIZE + inexact_at] = 0x3F800001;
+                }
+            } else {
+                // a smooth gradient in [0, 2] with alpha 1, rounded through half
+                int_float v;
+                for (size_t i = 0; i < (size_t)BUFFER_SIZE * TEST_RUNS; i++) {
+                    int pixel = (int)((i / 4) % ((size_t)width * height));
+                    int x = pixel % width;
+                    int y = pixel / width;
+                    switch (i % 4) {
+                        case 0:  v.f = 2.0f * x / width; break;
+                        case 1:  v.f = 2.0f * y / height; break;
+                        case 2:  v.f = (float)(x + y) / (width + height); break;
+                        default: v.f = 1.0f; break;
+                    }
+                    v.f = widen->f16_to_f32(plain->f32_to_f16(v.f));
+                    data[i] = v.u;
+                }
+            }
+
+            printf("\r\nruns: %d, buffer size: %d, %s\n\n", TEST_RUNS, BUFFER_SIZE, label);
+            printf("%-20s :      min      avg     max\n", "name");
+            fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE, label, "name", "min", "avg", "max");
+            for (size_t k = 0; k < representable_test_count; k++) {
+                const F16RepresentableKernel *rk = representable_tests[k];
+                int want = pass == 0 ? inexact_at : BUFFER_SIZE;
+                int got = rk->f32_find_inexact_f16(data, BUFFER_SIZE);
+                if (got != want)
+                    printf("%-20s : first inexact at %d, expected %d\n", rk->name, got, want);
+                TIME_CALL(rk->name, rk->f32_find_inexact_f16(ptr, BUFFER_SIZE), BUFFER_SIZE, TEST_RUNS);
+            }
+            if (scratch) {
+                snprintf(name, sizeof(name), "%s round trip", plain->name);
+                TIME_CALL(name, f32_find_inexact_f16_round_trip(plain, widen, ptr, result, scratch, BUFFER_SIZE), BUFFER_SIZE, TEST_RUNS);
+            }
+        }
+        free(scratch);
+    }
+
+    // in place overwrites data, the packed halves read back as mostly zeros and
+    // denormals, so every kernel gets freshly randomized data
+    printf("\r\nruns: %d, buffer size: %d, random f32 full +inf+nan, in place\n\n", TEST_RUNS, BUFFER_SIZE);
+    printf("%-20s :      min      avg     max\n", "name");
+    fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f32 full +inf+nan in place", "name", "min", "avg", "max");
+    for (size_t k = 0; k < inplace_test_count; k++) {
+        const F16InplaceKernel *p = inplace_tests[k];
+        char name[64];
+        if (!p->f32_to_f16_buffer_inplace)
+            continue;
+        randomize_buffer_u32(data, BUFFER_SIZE * TEST_RUNS, 0);
+        printf("\r");
+        snprintf(name, sizeof(name), "%s in place", p->name);
+        TIME_CALL(name, p->f32_to_f16_buffer_inplace(ptr, BUFFER_SIZE), BUFFER_SIZE, TEST_RUNS);
+    }
+
+    // reuses the f32 buffer, every run is BUFFER_SIZE doubles so there are half as many runs
+    printf("\r\nruns: %d, buffer size: %d, random f64 <= HALF_MAX\n\n", TEST_RUNS / 2, BUFFER_SIZE);
+    randomize_buffer_f64((uint64_t*)data, (size_t)BUFFER_SIZE * TEST_RUNS / 2);
+
+    printf("%-20s :      min      avg     max\n", "name");
+    fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS / 2, BUFFER_SIZE,"random f64 <= HALF_MAX", "name", "min", "avg", "max");
+    for (size_t k = 0; k < double_test_count; k++) {
+        const F16DoubleKernel *d = double_tests[k];
+        TIME_CALL(d->name, d->f64_to_f16_buffer((uint64_t*)ptr, result, BUFFER_SIZE), BUFFER_SIZE * 2, (TEST_RUNS / 2));
     }
+    TIME_CALL("f64 two pass", f64_to_f16_buffer_two_pass((uint64_t*)ptr, result, BUFFER_SIZE), BUFFER_SIZE * 2, (TEST_RUNS / 2));
 
     fflush(stdout);
     free(data);
@@ -296,10 +2000,97 @@ int main(int argc, char *argv[])
 
     printf("\nchecking hardware accuracy\n\n");
     start = get_timer();
-    test_hardware_accuracy(f, has_hardware_f16);
+    reference = f16_kernel_find(F16_F32_TO_F16, "hardware", cpu_flags);
+    if (!reference)
+        reference = f16_kernel_find(F16_F32_TO_F16, "no table", cpu_flags);
+    test_hardware_accuracy(f, reference);
     elapse = (double)((get_timer() - start)) / (double)freq;
     printf("\nhardware check in %f secs\n",  elapse);
 
+    if (reference->f32_to_f16_buffer_mode) {
+        printf("\nchecking directed rounding modes\n\n");
+        start = get_timer();
+        test_rounding_modes(f, reference);
+        elapse = (double)((get_timer() - start)) / (double)freq;
+        printf("rounding mode check in %f secs\n",  elapse);
+    } else {
+        printf("\n** no hardware rounding modes to check against, skipping rounding mode check **\n");
+    }
+
+    if (autotuned) {
+        printf("\nchecking autotuned kernels against %s\n\n", reference->name);
+        test_autotune(f, reference);
+    }
+
+    printf("\nchecking saturating and nan canonicalizing conversions\n\n");
+    start = get_timer();
+    test_special_values(f, reference);
+    elapse = (double)((get_timer() - start)) / (double)freq;
+    printf("special value check in %f secs\n",  elapse);
+
+    printf("\nchecking conversion stats\n\n");
+    start = get_timer();
+    test_convert_stats(f, reference);
+    elapse = (double)((get_timer() - start)) / (double)freq;
+    printf("\nstats check in %f secs\n",  elapse);
+
+    printf("\nchecking f64 to f16\n\n");
+    start = get_timer();
+    test_f64_conversion(f, cpu_flags);
+    elapse = (double)((get_timer() - start)) / (double)freq;
+    printf("\nf64 check in %f secs\n",  elapse);
+
+    printf("\nchecking bf16\n\n");
+    start = get_timer();
+    test_bf16_accuracy(f);
+    elapse = (double)((get_timer() - start)) / (double)freq;
+    printf("\nbf16 check in %f secs\n",  elapse);
+
+    printf("\nchecking rgba to planar and strided conversions\n\n");
+    start = get_timer();
+    test_image_conversion(f, reference, cpu_flags);
+    elapse = (double)((get_timer() - start)) / (double)freq;
+    printf("\nimage check in %f secs\n",  elapse);
+
+    printf("\nchecking channel subset conversions\n\n");
+    start = get_timer();
+    test_channel_conversion(f, cpu_flags);
+    elapse = (double)((get_timer() - start)) / (double)freq;
+    printf("\nchannel check in %f secs\n",  elapse);
+
+    printf("\nchecking scale and bias conversions\n\n");
+    start = get_timer();
+    test_scale_bias_conversion(f, cpu_flags);
+    elapse = (double)((get_timer() - start)) / (double)freq;
+    printf("\nscale and bias check in %f secs\n",  elapse);
+
+    printf("\nchecking u8, u16 and i16 to f16\n\n");
+    start = get_timer();
+    test_integer_conversion(f);
+    elapse = (double)((get_timer() - start)) / (double)freq;
+    printf("\ninteger check in %f secs\n",  elapse);
+
+    printf("\nchecking first inexact float scans against %s\n\n", reference->name);
+    start = get_timer();
+    test_representable_scan(f, reference, cpu_flags);
+    elapse = (double)((get_timer() - start)) / (double)freq;
+    printf("\nrepresentable check in %f secs\n",  elapse);
+
+    printf("\nchecking in place conversions\n\n");
+    start = get_timer();
+    test_inplace_conversion(f, cpu_flags);
+    elapse = (double)((get_timer() - start)) / (double)freq;
+    printf("\nin place check in %f secs\n",  elapse);
+
+    // table rounding has exact directed modes when there is no f16c
+    const F16Kernel *round_reference = reference->f32_to_f16_buffer_mode ? reference :
+                                       f16_kernel_find(F16_F32_TO_F16, "table rounding", cpu_flags);
+    printf("\nchecking stochastic rounding against %s\n\n", round_reference->name);
+    start = get_timer();
+    test_stochastic_rounding(f, round_reference, cpu_flags);
+    elapse = (double)((get_timer() - start)) / (double)freq;
+    printf("\nstochastic rounding check in %f secs\n",  elapse);
+
 
 #endif
     fprintf(f, "\n");
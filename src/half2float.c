@@ -1,60 +1,54 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <assert.h>
 
 #include <float.h>
 #include <time.h>
 #include <math.h>
+#include <inttypes.h>
 
 #include "common.h"
 #include "platform_info.h"
-#include "hardware/hardware.h"
-#include "table/table.h"
-#include "ryg/ryg.h"
-#include "imath/imath.h"
+#include "noisy_neighbor.h"
+#include "target_clones.h"
+#include "autotune.h"
+#include "f16_registry.h"
+#include "static_table/static_table.h"
+#include "image/image.h"
+#include "reduce.h"
+#include "arith.h"
+#include "lut/lut.h"
+#include "display/display.h"
+#include "threads.h"
 
-#if defined(ARCH_X86)
-#include "x86_cpu_info.h"
-#include "ryg_sse2/ryg_sse2.h"
-#include "emmintrin.h"
-#endif
+static const F16Kernel *f16_tests[F16_MAX_KERNELS];
+static size_t test_count = 0;
 
-#include "half2float_table.h"
+static const F16Kernel *bf16_tests[F16_MAX_KERNELS];
+static size_t bf16_test_count = 0;
 
-static void f16_to_f32_buffer_static_table(uint16_t *data, uint32_t *result, int data_size)
-{
-    for (int i =0; i < data_size; i++) {
-        result[i] = f16_to_f32_static_table[data[i]];
-    }
-}
+static const F16WidenKernel *widen_tests[F16_MAX_KERNELS];
+static size_t widen_test_count = 0;
 
-static float f16_to_f32_static_table_func(uint16_t h)
-{
-    int_float v;
-    v.u = f16_to_f32_static_table[h];
-    return v.f;
-}
+static const F16InplaceKernel *inplace_tests[F16_MAX_KERNELS];
+static size_t inplace_test_count = 0;
 
-typedef struct F16Test {
-    const char *name;
-    float (*f16_to_f32)(uint16_t h);
-    void (*f16_to_f32_buffer)(uint16_t *data, uint32_t *result, int data_size);
-} F16Test;
+static const F16ReduceKernel *reduce_tests[F16_MAX_KERNELS];
+static size_t reduce_test_count = 0;
 
-const static F16Test f16_tests[] =
-{
-    {"hardware",            f16_to_f32_hw,                 f16_to_f32_buffer_hw },
-    {"static_table",        f16_to_f32_static_table_func,  f16_to_f32_buffer_static_table },
-    {"table",               f16_to_f32_table,              f16_to_f32_buffer_table },
-    {"imath",               f16_to_f32_imath,              f16_to_f32_buffer_imath },
-    {"ryg",                 f16_to_f32_ryg,                f16_to_f32_buffer_ryg },
-#if defined(ARCH_X86)
-    {"ryg_sse2",            f16_to_f32_ryg_sse2,           f16_to_f32_buffer_ryg_sse2 },
-#endif
-};
+static const F16ArithKernel *arith_tests[F16_MAX_KERNELS];
+static size_t arith_test_count = 0;
+
+static const F16LutKernel *lut_tests[F16_MAX_KERNELS];
+static size_t lut_test_count = 0;
 
-#define TEST_COUNT ARRAY_SIZE(f16_tests)
+static const F16DisplayKernel *display_tests[F16_MAX_KERNELS];
+static size_t display_test_count = 0;
+
+static const F16ImageKernel *image_tests[F16_MAX_KERNELS];
+static size_t image_test_count = 0;
 
 #define USE_VALIDATE 1
 
@@ -93,6 +87,874 @@ int validate(uint16_t *src, uint32_t *result, size_t size) { return 0;}
     printf("%-20s : %f %f %f secs\n", name, min_value, average, max_value); \
     fprintf(f, "%s,%f,%f,%f\n", name, min_value, average, max_value)
 
+// like TIME_FUNC for kernels with other result types, they are checked up front instead
+#define TIME_CALL(name, call, buffer_size, runs)                            \
+    min_value = INFINITY;                                                   \
+    max_value = -INFINITY;                                                  \
+    average = 0.0;                                                          \
+    ptr = data;                                                             \
+    for (size_t j = 0; j < runs; j++) {                                     \
+        start = get_timer();                                                \
+        call;                                                               \
+        elapse = (double)((get_timer() - start)) / (double)freq;            \
+        min_value = MIN(min_value, elapse);                                 \
+        max_value = MAX(max_value, elapse);                                 \
+        average += elapse * 1.0 / (double)runs;                             \
+        ptr += buffer_size;                                                 \
+    }                                                                       \
+                                                                            \
+    printf("%-20s : %f %f %f secs\n", name, min_value, average, max_value); \
+    fprintf(f, "%s,%f,%f,%f\n", name, min_value, average, max_value)
+
+static const float i32_scales[] = {1.0f, 0.5f, -1.0f, 255.0f, 65535.0f, 2147483648.0f};
+
+// truncates then looks at the exact remainder
+static int32_t f16_to_i32_reference(uint16_t h, float scale)
+{
+    double v = f16_to_f32_static_table_func(h) * scale;
+    double frac;
+    int64_t r;
+
+    if (isnan(v))
+        return 0;
+    if (v >= 2147483648.0)
+        return INT32_MAX;
+    if (v <= -2147483648.0)
+        return INT32_MIN;
+
+    r = (int64_t)v;
+    frac = v - (double)r;
+    if (frac > 0.5 || (frac == 0.5 && (r & 1)))
+        r++;
+    else if (frac < -0.5 || (frac == -0.5 && (r & 1)))
+        r--;
+
+    return (int32_t)MAX(MIN(r, INT32_MAX), INT32_MIN);
+}
+
+// every half through the f64 and scaled int32 kernels
+void test_widen(void)
+{
+    uint16_t src[UINT16_MAX + 1];
+    uint64_t *f64_result = (uint64_t*) malloc(sizeof(uint64_t) * (UINT16_MAX + 1));
+    int32_t *i32_result = (int32_t*) malloc(sizeof(int32_t) * (UINT16_MAX + 1));
+
+    if (!f64_result || !i32_result) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    for (int i = 0; i <= UINT16_MAX; i++) {
+        src[i] = (uint16_t)i;
+    }
+
+    for (size_t k = 0; k < widen_test_count; k++) {
+        const F16WidenKernel *w = widen_tests[k];
+        uint32_t f64_error = 0;
+        uint32_t i32_error = 0;
+
+        // one short of the full range so the tail is used
+        w->f16_to_f64_buffer(src, f64_result, UINT16_MAX);
+        for (int i = 0; i < UINT16_MAX; i++) {
+            union { uint64_t u; double d; } value;
+            value.d = f16_to_f32_static_table_func(src[i]);
+            if (f64_result[i] != value.u) {
+                if (f64_error++ < 4)
+                    printf("%s f64 : 0x%04X 0x%016" PRIX64 " != 0x%016" PRIX64 "\n", w->name, src[i], f64_result[i], value.u);
+            }
+        }
+
+        for (size_t n = 0; n < ARRAY_SIZE(i32_scales); n++) {
+            w->f16_to_i32_buffer(src, i32_result, UINT16_MAX, i32_scales[n]);
+            for (int i = 0; i < UINT16_MAX; i++) {
+                int32_t expect = f16_to_i32_reference(src[i], i32_scales[n]);
+                if (i32_result[i] != expect) {
+                    if (i32_error++ < 4)
+                        printf("%s i32 * %g : 0x%04X %d != %d\n", w->name, i32_scales[n], src[i], i32_result[i], expect);
+                }
+            }
+        }
+
+        printf("%-20s: f64 %u mismatches, i32 %u mismatches over %d scales\n", w->name, f64_error, i32_error, (int)ARRAY_SIZE(i32_scales));
+    }
+
+done:
+    free(f64_result);
+    free(i32_result);
+}
+
+// every size up to a few vectors, then every half plus a few. words past the floats must be left alone
+void test_inplace(void)
+{
+    const int sizes_small = 67;
+    const int size_large = UINT16_MAX + 4;
+    uint16_t *src = (uint16_t*) malloc(sizeof(uint16_t) * size_large);
+    uint32_t *buf = (uint32_t*) malloc(sizeof(uint32_t) * (size_large + GUARD_COUNT));
+
+    if (!src || !buf) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    for (int i = 0; i < size_large; i++) {
+        src[i] = (uint16_t)(i * 40503);
+    }
+
+    for (size_t k = 0; k < inplace_test_count; k++) {
+        const F16InplaceKernel *p = inplace_tests[k];
+        uint32_t errors = 0;
+
+        if (!p->f16_to_f32_buffer_inplace)
+            continue;
+
+        for (int n = 0; n < TAIL_TEST_COUNT(sizes_small); n++) {
+            int size = TAIL_TEST_SIZE(n, sizes_small, size_large);
+
+            memcpy(buf, src, sizeof(uint16_t) * size);
+            guard_fill(buf + size, sizeof(uint32_t), GUARD_COUNT);
+            p->f16_to_f32_buffer_inplace((uint16_t*)buf, size);
+
+            for (int i = 0; i < size; i++) {
+                uint32_t expect = f16_to_f32_static_table[src[i]];
+                if (buf[i] != expect) {
+                    if (errors++ < 4)
+                        printf("%s in place size %d : %d 0x%04X 0x%08X != 0x%08X\n", p->name, size, i, src[i], buf[i], expect);
+                }
+            }
+            errors += guard_check(buf + size, sizeof(uint32_t), GUARD_COUNT);
+        }
+
+        printf("%-20s: in place %u mismatches\n", p->name, errors);
+    }
+
+done:
+    free(src);
+    free(buf);
+}
+
+static const char *sum_mode_names[] = {"naive", "kahan", "pairwise"};
+
+// the second pass of convert then reduce. it keeps 4 running sums like the kernels do,
+// a single one would be a chain of dependent adds and much slower than either kernel
+static float f32_sum_pairwise(const float *a, const float *b, int size)
+{
+    if (size <= F16_PAIRWISE_BLOCK) {
+        float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < size; i++) {
+            sum[i & 3] += b ? a[i] * b[i] : a[i];
+        }
+        return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+    }
+
+    int half = size / 8 * 4;
+    return f32_sum_pairwise(a, b, half) + f32_sum_pairwise(a + half, b ? b + half : b, size - half);
+}
+
+static float f32_sum(const float *a, const float *b, int size, int mode)
+{
+    F16Sum s[4];
+    F16Sum total;
+
+    if (mode == F16_SUM_PAIRWISE)
+        return f32_sum_pairwise(a, b, size);
+
+    for (int i = 0; i < 4; i++) {
+        f16_sum_init(&s[i]);
+    }
+
+    for (int i = 0; i < size; i++) {
+        float v = b ? a[i] * b[i] : a[i];
+        if (mode == F16_SUM_KAHAN)
+            f16_sum_add_kahan(&s[i & 3], v);
+        else
+            s[i & 3].sum += v;
+    }
+
+    f16_sum_init(&total);
+    for (int i = 0; i < 4; i++) {
+        f16_sum_add_kahan(&total, s[i].sum);
+        f16_sum_add_kahan(&total, -s[i].c);
+    }
+    return total.sum - total.c;
+}
+
+static float f16_sum_two_pass(const F16Kernel *k, uint16_t *data, uint32_t *scratch, int data_size, int mode)
+{
+    k->f16_to_f32_buffer(data, scratch, data_size);
+    return f32_sum((const float*)scratch, NULL, data_size, mode);
+}
+
+static float f16_dot_two_pass(const F16Kernel *k, uint16_t *a, uint16_t *b, uint32_t *scratch, int data_size, int mode)
+{
+    k->f16_to_f32_buffer(a, scratch, data_size);
+    k->f16_to_f32_buffer(b, scratch + data_size, data_size);
+    return f32_sum((const float*)scratch, (const float*)scratch + data_size, data_size, mode);
+}
+
+// small integers add up exactly in any order, so every mode has to give the exact sum.
+// then sums of values in [0, 1) against a double sum, to show what each mode buys
+void test_reduce(void)
+{
+    const int sizes_small = 21;
+    const int size_large = (1 << 20) + 3;
+    uint16_t ints[31];
+    uint16_t *a = (uint16_t*) malloc(sizeof(uint16_t) * size_large);
+    uint16_t *b = (uint16_t*) malloc(sizeof(uint16_t) * size_large);
+
+    if (!a || !b) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    for (int i = 0; i <= UINT16_MAX; i++) {
+        int_float v;
+        v.u = f16_to_f32_static_table[i];
+        if (v.f >= -15.0f && v.f <= 15.0f && (float)(int)v.f == v.f && i != 0x8000)
+            ints[(int)v.f + 15] = (uint16_t)i;
+    }
+
+    for (size_t k = 0; k < reduce_test_count; k++) {
+        const F16ReduceKernel *r = reduce_tests[k];
+        uint32_t errors = 0;
+
+        for (int n = 0; n < TAIL_TEST_COUNT(sizes_small); n++) {
+            int size = TAIL_TEST_SIZE(n, sizes_small, size_large);
+            int64_t sum = 0;
+            int64_t dot = 0;
+            float min = INFINITY;
+            float max = -INFINITY;
+            float got_min;
+            float got_max;
+
+            // products are at most 225, so the large dot product still fits in 24 bits
+            for (int i = 0; i < size; i++) {
+                int x = (int)((i * 7919u) % 31) - 15;
+                int y = (int)((i * 104729u) % 31) - 15;
+                a[i] = ints[x + 15];
+                b[i] = ints[y + 15];
+                sum += x;
+                dot += x * y;
+            }
+
+            for (int mode = F16_SUM_NAIVE; mode <= F16_SUM_PAIRWISE; mode++) {
+                float got_sum = r->f16_sum_buffer(a, size, mode);
+                float got_dot = r->f16_dot_buffer(a, b, size, mode);
+                if (got_sum != (float)sum || got_dot != (float)dot) {
+                    if (errors++ < 4)
+                        printf("%s %s size %d : sum %f != %" PRId64 " or dot %f != %" PRId64 "\n", r->name, sum_mode_names[mode], size, got_sum, sum, got_dot, dot);
+                }
+            }
+
+            // every half including nan and inf, nan is skipped
+            for (int i = 0; i < size; i++) {
+                int_float v;
+                a[i] = (uint16_t)(i * 40503);
+                v.u = f16_to_f32_static_table[a[i]];
+                if (v.f < min)
+                    min = v.f;
+                if (v.f > max)
+                    max = v.f;
+            }
+
+            r->f16_minmax_buffer(a, size, &got_min, &got_max);
+            if (got_min != min || got_max != max) {
+                if (errors++ < 4)
+                    printf("%s minmax size %d : %f %f != %f %f\n", r->name, size, got_min, got_max, min, max);
+            }
+        }
+
+        printf("%-20s: reduce %u mismatches\n", r->name, errors);
+    }
+
+    {
+        double exact = 0.0;
+
+        for (int i = 0; i < size_large; i++) {
+            int_float v;
+            a[i] = (uint16_t)((i * 40503u) % 0x3C00);
+            v.u = f16_to_f32_static_table[a[i]];
+            exact += v.f;
+        }
+
+        printf("\nrelative error summing %d halves in [0, 1):\n", size_large);
+        for (size_t k = 0; k < reduce_test_count; k++) {
+            const F16ReduceKernel *r = reduce_tests[k];
+            for (int mode = F16_SUM_NAIVE; mode <= F16_SUM_PAIRWISE; mode++) {
+                double err = ((double)r->f16_sum_buffer(a, size_large, mode) - exact) / exact;
+                printf("%-20s: %-8s %e\n", r->name, sum_mode_names[mode], err < 0.0 ? -err : err);
+            }
+        }
+    }
+
+done:
+    free(a);
+    free(b);
+}
+
+static const char *arith_op_names[] = {"axpy", "add", "mul", "lerp"};
+static const float arith_scale[] = {-1.5f, 0.0f, 0.0f, 0.3f};
+
+// the decode and encode kernels each arith kernel is built from, for the three pass version
+static const char *arith_codecs[][3] = {
+    {"hardware", "hardware", "hardware"},
+    {"sse2",     "ryg_sse2", "maratyszcza sse2"},
+};
+
+static const F16Kernel *arith_codec(const char *name, int which, F16Direction direction, unsigned int cpu_flags)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(arith_codecs); i++) {
+        if (!strcmp(arith_codecs[i][0], name))
+            return f16_kernel_find(direction, arith_codecs[i][which], cpu_flags);
+    }
+    return NULL;
+}
+
+// axpy works in place on y, so result gets a copy of b first
+static void f16_arith_call(const F16ArithKernel *k, uint16_t *a, uint16_t *b, uint16_t *result, int data_size, float s, int op)
+{
+    switch (op) {
+        case F16_OP_AXPY:
+            memcpy(result, b, sizeof(uint16_t) * data_size);
+            k->f16_axpy_buffer(a, result, data_size, s);
+            break;
+        case F16_OP_ADD:  k->f16_add_buffer(a, b, result, data_size); break;
+        case F16_OP_MUL:  k->f16_mul_buffer(a, b, result, data_size); break;
+        default:          k->f16_lerp_buffer(a, b, result, data_size, s); break;
+    }
+}
+
+// every half against a shuffled copy of every half, and the sizes around the tail.
+// nan only has to come out as a nan, the payload depends on operand order
+void test_arith(unsigned int cpu_flags)
+{
+    const int sizes_small = 21;
+    const int size_large = UINT16_MAX + 1;
+    const F16Kernel *encode = f16_kernel_find(F16_F32_TO_F16, "no table", cpu_flags);
+    uint16_t *a = (uint16_t*) malloc(sizeof(uint16_t) * size_large);
+    uint16_t *b = (uint16_t*) malloc(sizeof(uint16_t) * size_large);
+    uint16_t *got = (uint16_t*) malloc(sizeof(uint16_t) * (size_large + GUARD_COUNT));
+
+    if (!a || !b || !got || !encode) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    for (int i = 0; i < size_large; i++) {
+        a[i] = (uint16_t)i;
+        b[i] = (uint16_t)(i * 40503);
+    }
+
+    for (size_t k = 0; k < arith_test_count; k++) {
+        const F16ArithKernel *r = arith_tests[k];
+
+        for (int op = F16_OP_AXPY; op <= F16_OP_LERP; op++) {
+            uint32_t errors = 0;
+
+            for (int n = 0; n < TAIL_TEST_COUNT(sizes_small); n++) {
+                int size = TAIL_TEST_SIZE(n, sizes_small, size_large);
+
+                guard_fill(got + size, sizeof(uint16_t), GUARD_COUNT);
+                f16_arith_call(r, a, b, got, size, arith_scale[op], op);
+
+                for (int i = 0; i < size; i++) {
+                    int_float x;
+                    int_float y;
+                    x.u = f16_to_f32_static_table[a[i]];
+                    y.u = f16_to_f32_static_table[b[i]];
+                    uint16_t expect = encode->f32_to_f16(f16_arith_f32(x.f, y.f, arith_scale[op], op));
+                    int is_nan = (expect & 0x7FFF) > 0x7C00 && (got[i] & 0x7FFF) > 0x7C00;
+
+                    if (got[i] != expect && !is_nan) {
+                        if (errors++ < 4)
+                            printf("%s %s size %d : %d 0x%04X 0x%04X 0x%04X != 0x%04X\n", r->name, arith_op_names[op], size, i, a[i], b[i], got[i], expect);
+                    }
+                }
+                errors += guard_check(got + size, sizeof(uint16_t), GUARD_COUNT);
+            }
+
+            printf("%-20s: %-4s %u mismatches\n", r->name, arith_op_names[op], errors);
+        }
+    }
+
+done:
+    free(a);
+    free(b);
+    free(got);
+}
+
+// the float loop of the three pass version, op is a constant in each call
+static inline void f32_arith_buffer(float *a, const float *b, int data_size, float s, const int op)
+{
+    for (int i = 0; i < data_size; i++) {
+        a[i] = f16_arith_f32(a[i], b[i], s, op);
+    }
+}
+
+// what callers do without the kernels, decode both to floats, do the math and encode the result
+static void f16_arith_three_pass(const F16Kernel *decode, const F16Kernel *encode, uint16_t *a, uint16_t *b, uint16_t *result, uint32_t *scratch, int data_size, float s, int op)
+{
+    float *fa = (float*)scratch;
+    float *fb = (float*)scratch + data_size;
+
+    decode->f16_to_f32_buffer(a, scratch, data_size);
+    decode->f16_to_f32_buffer(b, scratch + data_size, data_size);
+    switch (op) {
+        case F16_OP_AXPY: f32_arith_buffer(fa, fb, data_size, s, F16_OP_AXPY); break;
+        case F16_OP_ADD:  f32_arith_buffer(fa, fb, data_size, s, F16_OP_ADD);  break;
+        case F16_OP_MUL:  f32_arith_buffer(fa, fb, data_size, s, F16_OP_MUL);  break;
+        default:          f32_arith_buffer(fa, fb, data_size, s, F16_OP_LERP); break;
+    }
+    encode->f32_to_f16_buffer(scratch, result, data_size);
+}
+
+// aces filmic fit (Narkowicz 2015), a tone curve with no libm calls
+static float aces_curve(float x, void *ctx)
+{
+    (void)ctx;
+    float v = (x * (2.51f * x + 0.03f)) / (x * (2.43f * x + 0.59f) + 0.14f);
+    if (!(v > 0.0f))
+        return 0.0f;
+    return v < 1.0f ? v : 1.0f;
+}
+
+#define LUT_DIRECT_CHUNK 256
+
+// the curve run on every value instead of the table, what the table replaces
+static void f16_curve_direct(const F16Kernel *decode, const F16Kernel *encode, f16_lut_func func, void *ctx,
+                             uint16_t *data, uint16_t *result, int data_size)
+{
+    uint32_t buf[LUT_DIRECT_CHUNK];
+    int_float v;
+
+    for (int i = 0; i < data_size; i += LUT_DIRECT_CHUNK) {
+        int n = data_size - i < LUT_DIRECT_CHUNK ? data_size - i : LUT_DIRECT_CHUNK;
+        decode->f16_to_f32_buffer(data + i, buf, n);
+        for (int j = 0; j < n; j++) {
+            v.u = buf[j];
+            v.f = func(v.f, ctx);
+            buf[j] = v.u;
+        }
+        encode->f32_to_f16_buffer(buf, result + i, n);
+    }
+}
+
+#define LUT_THREAD_CASES 7
+
+static const int lut_thread_sizes[LUT_THREAD_CASES] = {129, 129, 131, 4099, 4099, F16_LUT_SIZE, F16_LUT_SIZE};
+static const int lut_thread_counts[LUT_THREAD_CASES] = {2, 4, 4, 2, 4, 3, 4};
+
+// the table against the curve on every half, then every kernel against the
+// table for every half and every size around the tails, and split over threads
+void test_lut(const F16Lut *lut, const F16Kernel *decode, const F16Kernel *encode)
+{
+    const int sizes_small = 37;
+    const int size_large = F16_LUT_SIZE;
+    uint16_t *src = (uint16_t*) malloc(sizeof(uint16_t) * size_large);
+    uint16_t *half = (uint16_t*) malloc(sizeof(uint16_t) * (size_large + GUARD_COUNT));
+    uint32_t *f32 = (uint32_t*) malloc(sizeof(uint32_t) * (size_large + GUARD_COUNT));
+    uint32_t errors = 0;
+
+    if (!src || !half || !f32) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    for (int i = 0; i < size_large; i++) {
+        src[i] = (uint16_t)(i * 40503);
+    }
+
+    f16_curve_direct(decode, encode, aces_curve, NULL, src, half, size_large);
+    for (int i = 0; i < size_large; i++) {
+        int_float v;
+        v.u = f16_to_f32_static_table[src[i]];
+        v.f = aces_curve(v.f, NULL);
+        errors += half[i] != lut->half[src[i]];
+        errors += v.u != lut->f32[src[i]];
+    }
+    printf("%-20s: table %u mismatches\n", "lut build", errors);
+
+    for (size_t k = 0; k < lut_test_count; k++) {
+        const F16LutKernel *l = lut_tests[k];
+        errors = 0;
+
+        // the threaded sizes don't split evenly, every element still has to be written
+        for (int n = 0; n < TAIL_TEST_COUNT(sizes_small) + LUT_THREAD_CASES; n++) {
+            int thread_case = n - TAIL_TEST_COUNT(sizes_small);
+            int size = thread_case < 0 ? TAIL_TEST_SIZE(n, sizes_small, size_large) : lut_thread_sizes[thread_case];
+            int threads = thread_case < 0 ? 1 : lut_thread_counts[thread_case];
+
+            guard_fill(half, sizeof(uint16_t), size + GUARD_COUNT);
+            guard_fill(f32, sizeof(uint32_t), size + GUARD_COUNT);
+
+            if (threads > 1) {
+                f16_lut_apply_parallel(lut, l->f16_lut_apply_f16, NULL, src, half, size, threads);
+                f16_lut_apply_parallel(lut, NULL, l->f16_lut_apply_f32, src, f32, size, threads);
+            } else {
+                l->f16_lut_apply_f16(lut, src, half, size);
+                l->f16_lut_apply_f32(lut, src, f32, size);
+            }
+
+            for (int i = 0; i < size; i++) {
+                errors += half[i] != lut->half[src[i]];
+                errors += f32[i] != lut->f32[src[i]];
+            }
+            errors += guard_check(half + size, sizeof(uint16_t), GUARD_COUNT);
+            errors += guard_check(f32 + size, sizeof(uint32_t), GUARD_COUNT);
+        }
+
+        printf("%-20s: %u mismatches\n", l->name, errors);
+    }
+
+done:
+    free(src);
+    free(half);
+    free(f32);
+}
+
+// the srgb curve straight from the spec, kept apart from f16_srgb_encode and
+// f16_srgb_decode so the table is not only checked against the code that built it
+static double srgb_encode_reference(double linear)
+{
+    if (linear <= 0.0031308)
+        return linear * 12.92;
+    return 1.055 * pow(linear, 1.0 / 2.4) - 0.055;
+}
+
+static double srgb_decode_reference(double encoded)
+{
+    if (encoded <= 0.04045)
+        return encoded / 12.92;
+    return pow((encoded + 0.055) / 1.055, 2.4);
+}
+
+// what the display table replaces, decode, the srgb curve on each value and round
+static uint8_t srgb8_direct(float v)
+{
+    if (!(v > 0.0f))
+        return 0;
+    if (v >= 1.0f)
+        return 255;
+    return (uint8_t)(f16_srgb_encode(v) * 255.0 + 0.5);
+}
+
+#define DISPLAY_DIRECT_CHUNK 256
+
+static void f16_to_srgb8_direct(const F16Kernel *decode, uint16_t *data, uint8_t *result, int data_size)
+{
+    uint32_t buf[DISPLAY_DIRECT_CHUNK];
+    int_float v;
+
+    for (int i = 0; i < data_size; i += DISPLAY_DIRECT_CHUNK) {
+        int n = data_size - i < DISPLAY_DIRECT_CHUNK ? data_size - i : DISPLAY_DIRECT_CHUNK;
+        decode->f16_to_f32_buffer(data + i, buf, n);
+        for (int j = 0; j < n; j++) {
+            v.u = buf[j];
+            result[i + j] = srgb8_direct(v.f);
+        }
+    }
+}
+
+// f16_srgb_encode and f16_srgb_decode take roots by iterating, they only need to
+// land far closer than a code apart
+#define SRGB_CURVE_TOLERANCE 1e-12
+
+// the curve both ways and the table on every half against pow, then every kernel
+// against the table around the tails and on a padded image split over threads
+void test_display(void)
+{
+    const int sizes_small = 37;
+    const int size_large = F16_DISPLAY_SIZE;
+    const int width = 37;
+    const int height = 7;
+    const int data_stride = width * 2 + 22;
+    const int result_stride = width + 13;
+    uint16_t *src = (uint16_t*) malloc(sizeof(uint16_t) * size_large);
+    uint8_t *out = (uint8_t*) malloc(size_large + GUARD_COUNT);
+    uint8_t *image = (uint8_t*) malloc(result_stride * height);
+    uint32_t errors = 0;
+    uint32_t spec_errors = 0;
+    double max_error = 0.0;
+
+    if (!src || !out || !image) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    // both directions at every code, encode again at every half in (0, 1)
+    for (int k = 0; k <= 255; k++) {
+        double e = fabs(f16_srgb_decode(k / 255.0) - srgb_decode_reference(k / 255.0));
+        errors += e > SRGB_CURVE_TOLERANCE;
+        max_error = MAX(max_error, e);
+    }
+    for (int i = 0; i < size_large; i++) {
+        int_float v;
+        v.u = f16_to_f32_static_table[i];
+        if (v.f > 0.0f && v.f < 1.0f) {
+            double e = fabs(f16_srgb_encode(v.f) - srgb_encode_reference(v.f));
+            errors += e > SRGB_CURVE_TOLERANCE;
+            max_error = MAX(max_error, e);
+        }
+    }
+    printf("%-20s: %u mismatches against pow, max error %g\n", "srgb curve", errors, max_error);
+
+    errors = 0;
+    for (int i = 0; i < size_large; i++) {
+        int_float v;
+        uint8_t expect;
+        v.u = f16_to_f32_static_table[i];
+        if (!(v.f > 0.0f))
+            expect = 0;
+        else if (v.f >= 1.0f)
+            expect = 255;
+        else
+            expect = (uint8_t)(srgb_encode_reference(v.f) * 255.0 + 0.5);
+        spec_errors += f16_display_srgb8[i] != expect;
+        errors += f16_display_srgb8[i] != srgb8_direct(v.f);
+        src[i] = (uint16_t)(i * 40503);
+    }
+    printf("%-20s: table %u mismatches against pow, %u against the direct chain\n", "display build", spec_errors, errors);
+
+    for (size_t k = 0; k < display_test_count; k++) {
+        const F16DisplayKernel *d = display_tests[k];
+        errors = 0;
+
+        for (int n = 0; n < TAIL_TEST_COUNT(sizes_small); n++) {
+            int size = TAIL_TEST_SIZE(n, sizes_small, size_large);
+
+            guard_fill(out + size, 1, GUARD_COUNT);
+            d->f16_to_srgb8_buffer(src, out, size);
+
+            for (int i = 0; i < size; i++) {
+                errors += out[i] != f16_display_srgb8[src[i]];
+            }
+            errors += guard_check(out + size, 1, GUARD_COUNT);
+        }
+
+        // the rows of src read through a padded stride, more threads than some bands have rows
+        for (int threads = 1; threads <= 8; threads += 3) {
+            guard_fill(image, 1, result_stride * height);
+            f16_to_srgb8_rows(d->f16_to_srgb8_buffer, src, data_stride, image, result_stride, width, height, threads);
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    errors += image[y * result_stride + x] != f16_display_srgb8[src[y * data_stride / 2 + x]];
+                }
+                errors += guard_check(image + y * result_stride + width, 1, result_stride - width);
+            }
+        }
+
+        printf("%-20s: %u mismatches\n", d->name, errors);
+    }
+
+done:
+    free(src);
+    free(out);
+    free(image);
+}
+
+// every pixel against the table, and the row padding must still be the guard fill
+static uint32_t check_rgba(uint16_t *planes[4], int plane_stride, uint32_t *result, int result_stride, int width, int height)
+{
+    uint32_t error = 0;
+
+    for (int y = 0; y < height; y++) {
+        uint32_t *dst = IMAGE_ROW(uint32_t, result, result_stride, y);
+        for (int x = 0; x < width; x++) {
+            for (int c = 0; c < 4; c++) {
+                error += dst[x * 4 + c] != f16_to_f32_static_table[IMAGE_ROW(uint16_t, planes[c], plane_stride, y)[x]];
+            }
+        }
+        error += guard_check(dst + width * 4, sizeof(uint32_t), result_stride / 4 - width * 4);
+    }
+    return error;
+}
+
+// odd width so every row has a tail, and padded strides that aren't a multiple of the vector size
+void test_image(const F16Kernel *reference)
+{
+    const int width = 37;
+    const int height = 5;
+    const int plane_stride = width * 2 + 22;
+    const int result_stride = width * 16 + 52;
+    uint16_t *plane_buf = (uint16_t*) malloc(plane_stride * height * 4);
+    uint32_t *result = (uint32_t*) malloc(result_stride * height);
+    uint16_t *planes[4];
+    uint32_t errors = 0;
+
+    if (!plane_buf || !result) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    for (int i = 0; i < plane_stride / 2 * height * 4; i++) {
+        plane_buf[i] = (uint16_t)(i * 40503);
+    }
+    for (int c = 0; c < 4; c++) {
+        planes[c] = plane_buf + c * (plane_stride / 2) * height;
+    }
+
+    for (size_t k = 0; k < image_test_count; k++) {
+        const F16ImageKernel *img = image_tests[k];
+        if (!img->f16_planar_to_f32_rgba)
+            continue;
+
+        guard_fill(result, sizeof(uint32_t), result_stride / 4 * height);
+        img->f16_planar_to_f32_rgba(planes, plane_stride, result, result_stride, width, height);
+        printf("%-20s: planar to rgba %u mismatches\n", img->name, check_rgba(planes, plane_stride, result, result_stride, width, height));
+    }
+
+    guard_fill(result, sizeof(uint32_t), result_stride / 4 * height);
+    f16_planar_to_f32_rgba(reference->f16_to_f32_buffer, planes, plane_stride, result, result_stride, width, height);
+    printf("%-20s: planar to rgba %u mismatches\n", "generic", check_rgba(planes, plane_stride, result, result_stride, width, height));
+
+    // plane 0 read as an interleaved image with padded rows
+    guard_fill(result, sizeof(uint32_t), result_stride / 4 * height);
+    f16_to_f32_image(reference->f16_to_f32_buffer, plane_buf, plane_stride, result, result_stride, width, height);
+    for (int y = 0; y < height; y++) {
+        uint16_t *src = IMAGE_ROW(uint16_t, plane_buf, plane_stride, y);
+        uint32_t *dst = IMAGE_ROW(uint32_t, result, result_stride, y);
+        for (int x = 0; x < width; x++) {
+            errors += dst[x] != f16_to_f32_static_table[src[x]];
+        }
+        errors += guard_check(dst + width, sizeof(uint32_t), result_stride / 4 - width);
+    }
+    printf("%-20s: strided rows %u mismatches\n", reference->name, errors);
+
+done:
+    free(plane_buf);
+    free(result);
+}
+
+// the 4 planes of a run are back to back
+static uint16_t **frame_planes(uint16_t *planes[4], uint16_t *data, int plane_size)
+{
+    for (int c = 0; c < 4; c++) {
+        planes[c] = data + c * plane_size;
+    }
+    return planes;
+}
+
+// what callers did before the fused kernels, convert the planes then interleave them
+static void f16_planar_to_f32_rgba_two_pass(const F16Kernel *k, uint16_t *data, uint32_t *scratch, uint32_t *result, int pixels)
+{
+    k->f16_to_f32_buffer(data, scratch, pixels * 4);
+    for (int i = 0; i < pixels; i++) {
+        for (int c = 0; c < 4; c++) {
+            result[i * 4 + c] = scratch[c * pixels + i];
+        }
+    }
+}
+
+static Autotune tune;
+
+// only kernels that give the same bits as hardware, so the autotuned output doesn't depend on the machine
+static const F16Kernel *autotune_tests[F16_MAX_KERNELS];
+static size_t autotune_test_count = 0;
+
+typedef struct AutotuneBuffers {
+    uint16_t *data;
+    uint32_t *result;
+} AutotuneBuffers;
+
+static void autotune_run_test(void *ctx, int kernel, int size)
+{
+    AutotuneBuffers *b = (AutotuneBuffers*)ctx;
+    autotune_tests[kernel]->f16_to_f32_buffer(b->data, b->result, size);
+}
+
+// dispatches to the fastest kernel measured for the size class
+static void f16_to_f32_buffer_autotuned(uint16_t *data, uint32_t *result, int data_size)
+{
+    int kernel = tune.winners[autotune_size_class(data_size)];
+    autotune_tests[kernel]->f16_to_f32_buffer(data, result, data_size);
+}
+
+static int run_autotune(const char *cache_path, const char *cpu_key)
+{
+    const char *names[F16_MAX_KERNELS] = {0};
+    char key[512];
+    AutotuneBuffers b;
+    int size = autotune_sizes[AUTOTUNE_SIZE_CLASSES - 1];
+    int err = 0;
+
+    autotune_test_count = 0;
+    for (size_t i = 0; i < test_count; i++) {
+        if (f16_kernel_matches_hardware(f16_tests[i])) {
+            names[autotune_test_count] = f16_tests[i]->name;
+            autotune_tests[autotune_test_count++] = f16_tests[i];
+        }
+    }
+    if (!autotune_test_count)
+        return -1;
+    autotune_key(key, sizeof(key), cpu_key, __DATE__ " " __TIME__, names, (int)autotune_test_count);
+
+    if (autotune_load(&tune, cache_path, key, "f16_to_f32", names, (int)autotune_test_count)) {
+        b.data = (uint16_t*) malloc(sizeof(uint16_t) * size);
+        b.result = (uint32_t*) malloc(sizeof(uint32_t) * size);
+
+        if (!b.data || !b.result) {
+            free(b.data);
+            free(b.result);
+            return -1;
+        }
+
+        randomize_buffer_u16(b.data, size, 1);
+        err = autotune_measure(&tune, names, (int)autotune_test_count, autotune_run_test, &b);
+        if (!err && autotune_save(&tune, cache_path, key, "f16_to_f32", names))
+            printf("unable to write autotune cache: %s\n", cache_path);
+
+        free(b.data);
+        free(b.result);
+        if (err)
+            return err;
+    }
+
+    printf("\nautotune %s, cache file: %s\n", tune.from_cache ? "loaded from cache" : "measured", cache_path);
+    for (int i = 0; i < AUTOTUNE_SIZE_CLASSES; i++) {
+        printf("size <= %-12d : %s\n", autotune_sizes[i], autotune_tests[tune.winners[i]]->name);
+    }
+    return 0;
+}
+
+void test_autotune(const F16Kernel *reference)
+{
+    int size = autotune_sizes[AUTOTUNE_SIZE_CLASSES - 1];
+    uint16_t *src = (uint16_t*) malloc(sizeof(uint16_t) * size);
+    uint32_t *want = (uint32_t*) malloc(sizeof(uint32_t) * size);
+    uint32_t *got = (uint32_t*) malloc(sizeof(uint32_t) * size);
+    uint32_t candidate_errors = 0;
+    uint32_t winner_errors = 0;
+    uint32_t errors = 0;
+
+    if (!src || !want || !got) {
+        printf("malloc error\n");
+        goto done;
+    }
+
+    for (size_t i = 0; i < autotune_test_count; i++) {
+        candidate_errors += !f16_kernel_matches_hardware(autotune_tests[i]);
+    }
+
+    // every class at its own size, so each winner converts a buffer it was picked for
+    randomize_buffer_u16(src, size, 0);
+    for (int c = 0; c < AUTOTUNE_SIZE_CLASSES; c++) {
+        int n = autotune_sizes[c];
+        winner_errors += !f16_kernel_matches_hardware(autotune_tests[tune.winners[c]]);
+
+        reference->f16_to_f32_buffer(src, want, n);
+        f16_to_f32_buffer_autotuned(src, got, n);
+        for (int i = 0; i < n; i++) {
+            errors += got[i] != want[i];
+        }
+    }
+
+    printf("%-20s: %u candidates and %u winners that don't match hardware\n", "autotune", candidate_errors, winner_errors);
+    printf("%-20s: %u mismatches against %s\n", "autotuned", errors, reference->name);
+
+done:
+    free(src);
+    free(want);
+    free(got);
+}
 
 int main(int argc, char *argv[])
 {
@@ -104,14 +966,31 @@ int main(int argc, char *argv[])
     double min_value;
     double max_value;
     uint16_t *ptr;
-    int first = 0;
+    unsigned int cpu_flags = f16_cpu_flags();
+    double quiet_average[F16_MAX_KERNELS] = {0};
+    double noisy_average[F16_MAX_KERNELS] = {0};
 
     FILE *f = NULL;
     char *csv_path = NULL;
+    char *autotune_cache = AUTOTUNE_DEFAULT_CACHE;
+    char cpu_key[256];
+    int autotuned;
 
-    if (argc > 1)
-        csv_path = argv[1];
-    else
+    NoisyNeighborOptions noisy;
+    int noisy_arg;
+    noisy_neighbor_default_options(&noisy);
+
+    for (int i = 1; i < argc; i++) {
+        if (!strncmp(argv[i], "--autotune-cache=", 17))
+            autotune_cache = argv[i] + 17;
+        else if ((noisy_arg = noisy_neighbor_parse_arg(&noisy, argv[i])) < 0) {
+            printf("invalid value: %s\n", argv[i]);
+            return -1;
+        } else if (!noisy_arg)
+            csv_path = argv[i];
+    }
+
+    if (!csv_path)
         csv_path = "half2float_result.csv";
 
     f = fopen(csv_path,"wb");
@@ -124,45 +1003,120 @@ int main(int argc, char *argv[])
     // print cpu name and check for f16c instruction
     CPUInfo info = {0};
     get_cpu_info(&info);
+    snprintf(cpu_key, sizeof(cpu_key), "%s 0x%08x", info.name, info.flags);
     printf("CPU: %s %s %s\n", CPU_ARCH, info.name, info.extensions);
     fprintf(f, "%s,%s,%s\n", CPU_ARCH, info.name, info.extensions);
 
-    if (!(info.flags & X86_CPU_FLAG_F16C)) {
-        first = 1;
+    if (!(cpu_flags & F16_CPU_F16C)) {
         printf("** CPU does not support f16c instruction**\n");
     }
 #else
+    snprintf(cpu_key, sizeof(cpu_key), "%s", get_cpu_model_name());
     printf("CPU: %s %s\n", CPU_ARCH, get_cpu_model_name());
     fprintf(f, "%s,%s\n", CPU_ARCH, get_cpu_model_name());
 #endif
 
     printf("%s %s\n", get_platform_name(), COMPILER_NAME);
-    fprintf(f, "%s,%s\n", get_platform_name(), COMPILER_NAME);
+    fprintf(f, "%s,%s,%s\n", get_platform_name(), COMPILER_NAME, get_target_clone_name());
+    printf("scalar kernels dispatched to target clone: %s\n", get_target_clone_name());
     printf("csv file: %s\n", csv_path);
 
-    init_tables();
+    test_count = f16_kernel_select(F16_F16_TO_F32, cpu_flags, f16_tests, F16_MAX_KERNELS);
+    bf16_test_count = f16_kernel_select(F16_BF16_TO_F32, cpu_flags, bf16_tests, F16_MAX_KERNELS);
+    widen_test_count = f16_widen_kernel_select(cpu_flags, widen_tests, F16_MAX_KERNELS);
+    inplace_test_count = f16_inplace_kernel_select(cpu_flags, inplace_tests, F16_MAX_KERNELS);
+    reduce_test_count = f16_reduce_kernel_select(cpu_flags, reduce_tests, F16_MAX_KERNELS);
+    arith_test_count = f16_arith_kernel_select(cpu_flags, arith_tests, F16_MAX_KERNELS);
+    lut_test_count = f16_lut_kernel_select(cpu_flags, lut_tests, F16_MAX_KERNELS);
+    display_test_count = f16_display_kernel_select(cpu_flags, display_tests, F16_MAX_KERNELS);
+    image_test_count = f16_image_kernel_select(cpu_flags, image_tests, F16_MAX_KERNELS);
+
+    // the winners are unset if it fails, so the autotuned runs are skipped
+    autotuned = !run_autotune(autotune_cache, cpu_key);
+    if (!autotuned)
+        printf("autotune failed, skipping the autotuned runs\n");
 
     printf("\n%-20s:\n", "name");
-    for (size_t j = first; j < TEST_COUNT; j++) {
+    for (size_t j = 0; j < test_count; j++) {
         freq = get_timer_frequency();
         start = get_timer();
-        if (!f16_tests[j].f16_to_f32)
-            continue;
 
         for (int i = 0; i <= UINT16_MAX; i++) {
             a.u = f16_to_f32_static_table[i];
-            b.f = f16_tests[j].f16_to_f32(i);
+            b.f = f16_tests[j]->f16_to_f32(i);
 
             if (a.u != b.u) {
-                printf("%s : %05d 0x%08X != 0x%08X %f %f\n", f16_tests[j].name, i, a.u, b.u, a.f, b.f);
+                printf("%s : %05d 0x%08X != 0x%08X %f %f\n", f16_tests[j]->name, i, a.u, b.u, a.f, b.f);
                 // printf("0x%08X\n", a.i - b.i);
             }
 
         }
         elapse = (double)((get_timer() - start)) / (double)freq;
-        printf("%-20s: checked accuracy in %f secs\n", f16_tests[j].name, elapse);
+        printf("%-20s: checked accuracy in %f secs\n", f16_tests[j]->name, elapse);
+    }
+
+    // bf16 to f32 is exact, the value is the top 16 bits
+    for (size_t j = 0; j < bf16_test_count; j++) {
+        uint16_t src[UINT16_MAX + 1];
+        uint32_t out[UINT16_MAX + 1];
+        uint32_t errors = 0;
+
+        for (int i = 0; i <= UINT16_MAX; i++) {
+            src[i] = (uint16_t)i;
+        }
+        // one short of the full range so the tail is used
+        bf16_tests[j]->f16_to_f32_buffer(src, out, UINT16_MAX);
+
+        for (int i = 0; i < UINT16_MAX; i++) {
+            a.u = (uint32_t)i << 16;
+            b.f = bf16_tests[j]->f16_to_f32(i);
+            errors += out[i] != a.u || b.u != a.u;
+        }
+        printf("%-20s: %u mismatches\n", bf16_tests[j]->name, errors);
+    }
+
+    printf("\nchecking f64 and i32 widening\n");
+    test_widen();
+
+    const F16Kernel *image_reference = f16_kernel_find(F16_F16_TO_F32, "hardware", cpu_flags);
+    if (!image_reference)
+        image_reference = f16_kernel_find(F16_F16_TO_F32, "static_table", cpu_flags);
+
+    printf("\nchecking planar to rgba and strided conversions\n");
+    test_image(image_reference);
+
+    if (autotuned) {
+        printf("\nchecking autotuned kernels\n");
+        test_autotune(image_reference);
     }
 
+    printf("\nchecking reductions\n");
+    test_reduce();
+
+    printf("\nchecking elementwise math\n");
+    test_arith(cpu_flags);
+
+    // curve tables use the same decode and encode as the image checks
+    const F16Kernel *lut_decode = image_reference;
+    const F16Kernel *lut_encode = f16_kernel_find(F16_F32_TO_F16, "hardware", cpu_flags);
+    if (!lut_encode)
+        lut_encode = f16_kernel_find(F16_F32_TO_F16, "no table", cpu_flags);
+    F16Lut lut = {0};
+    int lut_ready = !f16_lut_build(&lut, aces_curve, NULL, lut_decode->f16_to_f32_buffer, lut_encode->f32_to_f16_buffer);
+
+    printf("\nchecking 64K lut\n");
+    if (lut_ready)
+        test_lut(&lut, lut_decode, lut_encode);
+    else
+        printf("unable to build lut\n");
+
+    f16_display_init();
+    printf("\nchecking srgb8 display table\n");
+    test_display();
+
+    printf("\nchecking in place conversions\n");
+    test_inplace();
+
     uint16_t *data = (uint16_t*) malloc(sizeof(uint16_t) * BUFFER_SIZE * TEST_RUNS);
     uint32_t *result = (uint32_t*) malloc(sizeof(uint32_t) * BUFFER_SIZE * TEST_RUNS);
 
@@ -172,8 +1126,11 @@ int main(int argc, char *argv[])
 
     printf("%-20s :      min      avg     max\n", "name");
     fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f16 <= HALF_MAX", "name", "min", "avg", "max");
-    for (size_t i = first; i < TEST_COUNT; i++) {
-        TIME_FUNC(f16_tests[i].name, f16_tests[i].f16_to_f32_buffer, BUFFER_SIZE, TEST_RUNS);
+    for (size_t i = 0; i < test_count; i++) {
+        TIME_FUNC(f16_tests[i]->name, f16_tests[i]->f16_to_f32_buffer, BUFFER_SIZE, TEST_RUNS);
+    }
+    if (autotuned) {
+        TIME_FUNC("autotuned", f16_to_f32_buffer_autotuned, BUFFER_SIZE, TEST_RUNS);
     }
     fflush(stdout);
 
@@ -183,9 +1140,247 @@ int main(int argc, char *argv[])
 
     printf("%-20s :      min      avg     max\n", "name");
     fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f16 full +inf+nan", "name", "min", "avg", "max");
-    for (size_t i = first; i < TEST_COUNT; i++) {
-        TIME_FUNC(f16_tests[i].name, f16_tests[i].f16_to_f32_buffer, BUFFER_SIZE, TEST_RUNS);
+    for (size_t i = 0; i < test_count; i++) {
+        TIME_FUNC(f16_tests[i]->name, f16_tests[i]->f16_to_f32_buffer, BUFFER_SIZE, TEST_RUNS);
+        quiet_average[i] = average;
+    }
+    if (autotuned) {
+        TIME_FUNC("autotuned", f16_to_f32_buffer_autotuned, BUFFER_SIZE, TEST_RUNS);
+    }
+
+    printf("\r\nruns: %d, buffer size: %d, random bf16 full +inf+nan\n\n", TEST_RUNS, BUFFER_SIZE);
+    printf("%-20s :      min      avg     max\n", "name");
+    fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random bf16 full +inf+nan", "name", "min", "avg", "max");
+    for (size_t i = 0; i < bf16_test_count; i++) {
+        TIME_CALL(bf16_tests[i]->name, bf16_tests[i]->f16_to_f32_buffer(ptr, result, BUFFER_SIZE), BUFFER_SIZE, TEST_RUNS);
+    }
+
+    // result is reused every run and has room for BUFFER_SIZE doubles
+    printf("\r\nruns: %d, buffer size: %d, random f16 full +inf+nan, to f64\n\n", TEST_RUNS, BUFFER_SIZE);
+    printf("%-20s :      min      avg     max\n", "name");
+    fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f16 full +inf+nan to f64", "name", "min", "avg", "max");
+    for (size_t k = 0; k < widen_test_count; k++) {
+        const F16WidenKernel *w = widen_tests[k];
+        TIME_CALL(w->name, w->f16_to_f64_buffer(ptr, (uint64_t*)result, BUFFER_SIZE), BUFFER_SIZE, TEST_RUNS);
+    }
+
+    printf("\r\nruns: %d, buffer size: %d, random f16 full +inf+nan, to i32 * 65535\n\n", TEST_RUNS, BUFFER_SIZE);
+    printf("%-20s :      min      avg     max\n", "name");
+    fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f16 full +inf+nan to i32", "name", "min", "avg", "max");
+    for (size_t k = 0; k < widen_test_count; k++) {
+        const F16WidenKernel *w = widen_tests[k];
+        TIME_CALL(w->name, w->f16_to_i32_buffer(ptr, (int32_t*)result, BUFFER_SIZE, 65535.0f), BUFFER_SIZE, TEST_RUNS);
+    }
+
+    {
+        // every run's halves are 4 planes of a 1920x1080 frame, result is reused
+        const int width = 1920;
+        const int height = BUFFER_SIZE / (width * 4);
+        uint32_t *scratch = (uint32_t*) alloc_perf_buffer(sizeof(uint32_t) * BUFFER_SIZE);
+        uint16_t *planes[4];
+        char name[64];
+
+        printf("\r\nruns: %d, buffer size: %d, random f16 full +inf+nan, planar to rgba %dx%d\n\n", TEST_RUNS, BUFFER_SIZE, width, height);
+        printf("%-20s :      min      avg     max\n", "name");
+        fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f16 full +inf+nan planar to rgba", "name", "min", "avg", "max");
+        for (size_t k = 0; k < image_test_count; k++) {
+            const F16ImageKernel *img = image_tests[k];
+            if (!img->f16_planar_to_f32_rgba)
+                continue;
+            snprintf(name, sizeof(name), "%s planar", img->name);
+            TIME_CALL(name, img->f16_planar_to_f32_rgba(frame_planes(planes, ptr, width * height), width * 2, result, width * 16, width, height), BUFFER_SIZE, TEST_RUNS);
+        }
+        TIME_CALL("generic planar", f16_planar_to_f32_rgba(image_reference->f16_to_f32_buffer, frame_planes(planes, ptr, width * height), width * 2, result, width * 16, width, height), BUFFER_SIZE, TEST_RUNS);
+        if (scratch) {
+            snprintf(name, sizeof(name), "%s 2 pass", image_reference->name);
+            TIME_CALL(name, f16_planar_to_f32_rgba_two_pass(image_reference, ptr, scratch, result, width * height), BUFFER_SIZE, TEST_RUNS);
+        }
+
+        // the last 16 pixels of each row are padding
+        snprintf(name, sizeof(name), "%s 2d", image_reference->name);
+        TIME_CALL(name, f16_to_f32_image(image_reference->f16_to_f32_buffer, ptr, width * 8, result, width * 16, (width - 16) * 4, height), BUFFER_SIZE, TEST_RUNS);
+
+        free(scratch);
+    }
+
+    {
+        // result is reused every run as the float buffer of convert then reduce,
+        // the dot products pair every run with the first run's halves
+        uint32_t *scratch = (uint32_t*) alloc_perf_buffer(sizeof(uint32_t) * BUFFER_SIZE * 2);
+        volatile float sink;
+        float min;
+        float max;
+        char name[64];
+
+        printf("\r\nruns: %d, buffer size: %d, random f16 full +inf+nan, reductions\n\n", TEST_RUNS, BUFFER_SIZE);
+        printf("%-20s :      min      avg     max\n", "name");
+        fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f16 full +inf+nan reductions", "name", "min", "avg", "max");
+        for (size_t k = 0; k < reduce_test_count; k++) {
+            const F16ReduceKernel *r = reduce_tests[k];
+            const F16Kernel *plain = f16_kernel_find(F16_F16_TO_F32, r->name, cpu_flags);
+            for (int mode = F16_SUM_NAIVE; mode <= F16_SUM_PAIRWISE; mode++) {
+                snprintf(name, sizeof(name), "%s sum %s", r->name, sum_mode_names[mode]);
+                TIME_CALL(name, sink = r->f16_sum_buffer(ptr, BUFFER_SIZE, mode), BUFFER_SIZE, TEST_RUNS);
+            }
+            snprintf(name, sizeof(name), "%s dot", r->name);
+            TIME_CALL(name, sink = r->f16_dot_buffer(ptr, data, BUFFER_SIZE, F16_SUM_NAIVE), BUFFER_SIZE, TEST_RUNS);
+            snprintf(name, sizeof(name), "%s minmax", r->name);
+            TIME_CALL(name, r->f16_minmax_buffer(ptr, BUFFER_SIZE, &min, &max), BUFFER_SIZE, TEST_RUNS);
+            if (plain && scratch) {
+                snprintf(name, sizeof(name), "%s 2 pass sum", r->name);
+                TIME_CALL(name, sink = f16_sum_two_pass(plain, ptr, scratch, BUFFER_SIZE, F16_SUM_NAIVE), BUFFER_SIZE, TEST_RUNS);
+                snprintf(name, sizeof(name), "%s 2 pass dot", r->name);
+                TIME_CALL(name, sink = f16_dot_two_pass(plain, ptr, data, scratch, BUFFER_SIZE, F16_SUM_NAIVE), BUFFER_SIZE, TEST_RUNS);
+            }
+        }
+        (void)sink;
+
+        free(scratch);
+    }
+
+    {
+        // a is each run's halves, b is the first run's halves and the result goes to the
+        // front of result. axpy updates that in place, starting from a copy of b
+        uint32_t *scratch = (uint32_t*) alloc_perf_buffer(sizeof(uint32_t) * BUFFER_SIZE * 2);
+        uint16_t *out = (uint16_t*)result;
+        char name[64];
+
+        printf("\r\nruns: %d, buffer size: %d, random f16 full +inf+nan, elementwise math\n\n", TEST_RUNS, BUFFER_SIZE);
+        printf("%-20s :      min      avg     max\n", "name");
+        fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f16 full +inf+nan elementwise math", "name", "min", "avg", "max");
+        for (size_t k = 0; k < arith_test_count; k++) {
+            const F16ArithKernel *r = arith_tests[k];
+            const F16Kernel *decode = arith_codec(r->name, 1, F16_F16_TO_F32, cpu_flags);
+            const F16Kernel *encode = arith_codec(r->name, 2, F16_F32_TO_F16, cpu_flags);
+
+            memcpy(out, data, sizeof(uint16_t) * BUFFER_SIZE);
+            snprintf(name, sizeof(name), "%s axpy", r->name);
+            TIME_CALL(name, r->f16_axpy_buffer(ptr, out, BUFFER_SIZE, arith_scale[F16_OP_AXPY]), BUFFER_SIZE, TEST_RUNS);
+            snprintf(name, sizeof(name), "%s add", r->name);
+            TIME_CALL(name, r->f16_add_buffer(ptr, data, out, BUFFER_SIZE), BUFFER_SIZE, TEST_RUNS);
+            snprintf(name, sizeof(name), "%s mul", r->name);
+            TIME_CALL(name, r->f16_mul_buffer(ptr, data, out, BUFFER_SIZE), BUFFER_SIZE, TEST_RUNS);
+            snprintf(name, sizeof(name), "%s lerp", r->name);
+            TIME_CALL(name, r->f16_lerp_buffer(ptr, data, out, BUFFER_SIZE, arith_scale[F16_OP_LERP]), BUFFER_SIZE, TEST_RUNS);
+
+            if (!decode || !encode || !scratch)
+                continue;
+            memcpy(out, data, sizeof(uint16_t) * BUFFER_SIZE);
+            for (int op = F16_OP_AXPY; op <= F16_OP_LERP; op++) {
+                // axpy reads y from out and writes it back there
+                uint16_t *b = op == F16_OP_AXPY ? out : data;
+                snprintf(name, sizeof(name), "%s 3 pass %s", r->name, arith_op_names[op]);
+                TIME_CALL(name, f16_arith_three_pass(decode, encode, ptr, b, out, scratch, BUFFER_SIZE, arith_scale[op], op), BUFFER_SIZE, TEST_RUNS);
+            }
+        }
+
+        free(scratch);
+    }
+
+    if (lut_ready) {
+        // the halves go to the front of result, the floats fill it
+        int threads = get_cpu_count();
+        uint16_t *out = (uint16_t*)result;
+        double direct_average;
+        double best_average = INFINITY;
+        char name[64];
+
+        printf("\r\nruns: %d, buffer size: %d, random f16 full +inf+nan, 64K lut, %d threads\n\n", TEST_RUNS, BUFFER_SIZE, threads);
+        printf("%-20s :      min      avg     max\n", "name");
+        fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f16 full +inf+nan 64K lut", "name", "min", "avg", "max");
+        snprintf(name, sizeof(name), "%s direct", lut_decode->name);
+        TIME_CALL(name, f16_curve_direct(lut_decode, lut_encode, aces_curve, NULL, ptr, out, BUFFER_SIZE), BUFFER_SIZE, TEST_RUNS);
+        direct_average = average;
+        for (size_t k = 0; k < lut_test_count; k++) {
+            const F16LutKernel *l = lut_tests[k];
+            snprintf(name, sizeof(name), "%s f16", l->name);
+            TIME_CALL(name, l->f16_lut_apply_f16(&lut, ptr, out, BUFFER_SIZE), BUFFER_SIZE, TEST_RUNS);
+            best_average = MIN(best_average, average);
+            snprintf(name, sizeof(name), "%s f32", l->name);
+            TIME_CALL(name, l->f16_lut_apply_f32(&lut, ptr, result, BUFFER_SIZE), BUFFER_SIZE, TEST_RUNS);
+            if (threads > 1) {
+                snprintf(name, sizeof(name), "%s f16 threads", l->name);
+                TIME_CALL(name, f16_lut_apply_parallel(&lut, l->f16_lut_apply_f16, NULL, ptr, out, BUFFER_SIZE, threads), BUFFER_SIZE, TEST_RUNS);
+                best_average = MIN(best_average, average);
+            }
+        }
+        printf("\nhalves per sec, direct %.1f M, best lut to f16 %.1f M\n", BUFFER_SIZE / direct_average / 1e6, BUFFER_SIZE / best_average / 1e6);
+    }
+
+    {
+        // rows of a 1920 wide rgba frame, the bytes go to the front of result
+        int threads = get_cpu_count();
+        int width = 1920 * 4;
+        int height = BUFFER_SIZE / width;
+        uint8_t *out = (uint8_t*)result;
+        double direct_average;
+        double best_average = INFINITY;
+        char name[64];
+
+        printf("\r\nruns: %d, buffer size: %d, random f16 full +inf+nan, srgb8 display, %d threads\n\n", TEST_RUNS, BUFFER_SIZE, threads);
+        printf("%-20s :      min      avg     max\n", "name");
+        fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f16 full +inf+nan srgb8 display", "name", "min", "avg", "max");
+        snprintf(name, sizeof(name), "%s direct", lut_decode->name);
+        TIME_CALL(name, f16_to_srgb8_direct(lut_decode, ptr, out, BUFFER_SIZE), BUFFER_SIZE, TEST_RUNS);
+        direct_average = average;
+        for (size_t k = 0; k < display_test_count; k++) {
+            const F16DisplayKernel *d = display_tests[k];
+            TIME_CALL(d->name, d->f16_to_srgb8_buffer(ptr, out, BUFFER_SIZE), BUFFER_SIZE, TEST_RUNS);
+            best_average = MIN(best_average, average);
+            if (threads > 1) {
+                snprintf(name, sizeof(name), "%s rows", d->name);
+                TIME_CALL(name, f16_to_srgb8_rows(d->f16_to_srgb8_buffer, ptr, width * 2, out, width, width, height, threads), BUFFER_SIZE, TEST_RUNS);
+                best_average = MIN(best_average, average);
+            }
+        }
+        printf("\nhalves per sec, direct %.1f M, best display table %.1f M\n", BUFFER_SIZE / direct_average / 1e6, BUFFER_SIZE / best_average / 1e6);
+    }
+
+    // each run's halves are copied into the front of its own BUFFER_SIZE floats first,
+    // the rest of result hasn't been written yet so fault its pages in up front
+    memset(result, 0, sizeof(uint32_t) * BUFFER_SIZE * TEST_RUNS);
+    printf("\r\nruns: %d, buffer size: %d, random f16 full +inf+nan, in place\n\n", TEST_RUNS, BUFFER_SIZE);
+    printf("%-20s :      min      avg     max\n", "name");
+    fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f16 full +inf+nan in place", "name", "min", "avg", "max");
+    for (size_t k = 0; k < inplace_test_count; k++) {
+        const F16InplaceKernel *p = inplace_tests[k];
+        char name[64];
+        if (!p->f16_to_f32_buffer_inplace)
+            continue;
+        for (size_t j = 0; j < TEST_RUNS; j++) {
+            memcpy(result + j * BUFFER_SIZE, data + j * BUFFER_SIZE, sizeof(uint16_t) * BUFFER_SIZE);
+        }
+        snprintf(name, sizeof(name), "%s in place", p->name);
+        TIME_CALL(name, p->f16_to_f32_buffer_inplace((uint16_t*)(result + (ptr - data)), BUFFER_SIZE), BUFFER_SIZE, TEST_RUNS);
+        assert(!validate(data + (TEST_RUNS - 1) * BUFFER_SIZE, result + (TEST_RUNS - 1) * BUFFER_SIZE, BUFFER_SIZE));
+    }
+
+    if (noisy.enabled) {
+        // rerun the same data while another thread keeps evicting our cache lines
+        if (noisy_neighbor_start(&noisy)) {
+            printf("unable to start noisy neighbor\n");
+        } else {
+            printf("\r\nruns: %d, buffer size: %d, random f16 full +inf+nan, noisy neighbor thrashing %d KB\n", TEST_RUNS, BUFFER_SIZE, (int)(noisy.size / 1024));
+            printf("co-runner: %s\n\n", noisy_neighbor_placement());
+
+            printf("%-20s :      min      avg     max\n", "name");
+            fprintf(f, "\nperf_test,runs: %d buffer size: %d %s\n%s,%s,%s,%s\n", TEST_RUNS, BUFFER_SIZE,"random f16 full +inf+nan noisy neighbor", "name", "min", "avg", "max");
+            for (size_t i = 0; i < test_count; i++) {
+                TIME_FUNC(f16_tests[i]->name, f16_tests[i]->f16_to_f32_buffer, BUFFER_SIZE, TEST_RUNS);
+                noisy_average[i] = average;
+            }
+            noisy_neighbor_stop();
+
+            printf("\nslowdown against quiet run:\n");
+            fprintf(f, "\nnoisy_test,slowdown against quiet run\nname,quiet,noisy,slowdown\n");
+            for (size_t i = 0; i < test_count; i++) {
+                double slowdown = noisy_average[i] / quiet_average[i];
+                printf("%-20s : %5.2fx\n", f16_tests[i]->name, slowdown);
+                fprintf(f, "%s,%f,%f,%f\n", f16_tests[i]->name, quiet_average[i], noisy_average[i], slowdown);
+            }
+        }
     }
+    f16_lut_free(&lut);
     fflush(stdout);
     fprintf(f, "\n");
     fclose(f);
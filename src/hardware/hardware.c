@@ -1,5 +1,11 @@
 
 #include "hardware.h"
+#include "../round_to_odd.h"
+#include "../f64/f64.h"
+#include "../image/image.h"
+#include "../integer/integer.h"
+#include "../representable/representable.h"
+#include <string.h>
 
 typedef union {
         uint32_t i;
@@ -74,7 +80,8 @@ float f16_to_f32_hw(uint16_t f)
 }
 
 #if defined(__aarch64__) || defined(__arm__)
-void f32_to_f16_buffer_hw(uint32_t *data, uint16_t *result, int data_size)
+// one element at a time, relies on the compiler to vectorize
+void f32_to_f16_buffer_hw_scalar(uint32_t *data, uint16_t *result, int data_size)
 {
     int_float value;
 
@@ -84,7 +91,7 @@ void f32_to_f16_buffer_hw(uint32_t *data, uint16_t *result, int data_size)
     }
 }
 
-void f16_to_f32_buffer_hw(uint16_t *data, uint32_t *result, int data_size)
+void f16_to_f32_buffer_hw_scalar(uint16_t *data, uint32_t *result, int data_size)
 {
     int_float value;
 
@@ -94,6 +101,100 @@ void f16_to_f32_buffer_hw(uint16_t *data, uint32_t *result, int data_size)
     }
 }
 
+#if defined(__aarch64__)
+#include <arm_neon.h>
+
+void f32_to_f16_buffer_hw(uint32_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        float32x4_t lo = vld1q_f32((const float*)data);
+        float32x4_t hi = vld1q_f32((const float*)data + 4);
+        float16x8_t ph = vcvt_high_f16_f32(vcvt_f16_f32(lo), hi);
+        vst1q_u16(result, vreinterpretq_u16_f16(ph));
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder >= 4) {
+        float32x4_t ps = vld1q_f32((const float*)data);
+        vst1_u16(result, vreinterpret_u16_f16(vcvt_f16_f32(ps)));
+
+        data += 4;
+        result += 4;
+        remainder -= 4;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        float32x4_t ps = vld1q_f32((const float*)&in_buf[0]);
+        vst1_u16(&out_buf[0], vreinterpret_u16_f16(vcvt_f16_f32(ps)));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+void f16_to_f32_buffer_hw(uint16_t *data, uint32_t *result, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        float16x8_t ph = vreinterpretq_f16_u16(vld1q_u16(data));
+        float32x4_t lo = vcvt_f32_f16(vget_low_f16(ph));
+        float32x4_t hi = vcvt_high_f32_f16(ph);
+        vst1q_u32(result, vreinterpretq_u32_f32(lo));
+        vst1q_u32(result + 4, vreinterpretq_u32_f32(hi));
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder >= 4) {
+        float16x4_t ph = vreinterpret_f16_u16(vld1_u16(data));
+        vst1q_u32(result, vreinterpretq_u32_f32(vcvt_f32_f16(ph)));
+
+        data += 4;
+        result += 4;
+        remainder -= 4;
+    }
+
+    if (remainder) {
+        uint16_t in_buf[4] = {0};
+        uint32_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        float16x4_t ph = vreinterpret_f16_u16(vld1_u16(&in_buf[0]));
+        vst1q_u32(&out_buf[0], vreinterpretq_u32_f32(vcvt_f32_f16(ph)));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+#else
+void f32_to_f16_buffer_hw(uint32_t *data, uint16_t *result, int data_size)
+{
+    f32_to_f16_buffer_hw_scalar(data, result, data_size);
+}
+
+void f16_to_f32_buffer_hw(uint16_t *data, uint32_t *result, int data_size)
+{
+    f16_to_f32_buffer_hw_scalar(data, result, data_size);
+}
+#endif
 
 #else
 void f32_to_f16_buffer_hw(uint32_t *data, uint16_t *result, int data_size)
@@ -178,3 +279,1356 @@ void f16_to_f32_buffer_hw(uint16_t *data, uint32_t *result, int data_size)
 }
 
 #endif
+
+#if defined(__aarch64__) || defined(__arm__)
+// the conversions round to nearest. gcc ignores FENV_ACCESS, so a fesetround around
+// them could be moved past the conversion. the half converts back exactly instead, and
+// if nearest went the wrong way for the mode the answer is the half on the other side
+static inline uint16_t fix_round_mode(float f, uint16_t h, int mode)
+{
+    int_float back;
+    int up;
+    int negative = (h & 0x8000) != 0;
+
+    back.i = to_f32(h);
+    if (back.f == f || f != f)
+        return h;
+
+    up = back.f > f;
+    switch (mode) {
+        case F16_ROUND_TO_NEG_INF: if (!up) return h; break;
+        case F16_ROUND_TO_POS_INF: if (up) return h; break;
+        case F16_ROUND_TO_ZERO:    if (up == negative) return h; break;
+        default:                   return h;
+    }
+
+    // a step down is toward zero for a positive half, away from it for a negative one
+    return up != negative ? h - 1 : h + 1;
+}
+
+uint16_t f32_to_f16_hw_mode(float f, int mode)
+{
+    return fix_round_mode(f, to_f16(f), mode);
+}
+
+void f32_to_f16_buffer_hw_mode(uint32_t *data, uint16_t *result, int data_size, int mode)
+{
+    int_float value;
+
+    f32_to_f16_buffer_hw(data, result, data_size);
+    if (mode == F16_ROUND_TO_NEAREST)
+        return;
+
+    for (int i = 0; i < data_size; i++) {
+        value.i = data[i];
+        result[i] = fix_round_mode(value.f, result[i], mode);
+    }
+}
+
+#else
+// the rounding mode is an immediate, branch to a constant for each mode
+static inline __m128i cvtps_ph_mode(__m128 ps, int mode)
+{
+    switch (mode) {
+        case F16_ROUND_TO_NEG_INF: return _mm_cvtps_ph(ps, _MM_FROUND_TO_NEG_INF);
+        case F16_ROUND_TO_POS_INF: return _mm_cvtps_ph(ps, _MM_FROUND_TO_POS_INF);
+        case F16_ROUND_TO_ZERO:    return _mm_cvtps_ph(ps, _MM_FROUND_TO_ZERO);
+        default:                   return _mm_cvtps_ph(ps, _MM_FROUND_TO_NEAREST_INT);
+    }
+}
+
+uint16_t f32_to_f16_hw_mode(float f, int mode)
+{
+    uint16_t result[8] = {0};
+    __m128i ph = cvtps_ph_mode(_mm_set1_ps(f), mode);
+
+    _mm_storeu_si128((__m128i*)result, ph);
+
+    return result[0];
+}
+
+void f32_to_f16_buffer_hw_mode(uint32_t *data, uint16_t *result, int data_size, int mode)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = _mm_loadu_ps((float*)data);
+        __m128i ph = cvtps_ph_mode(ps, mode);
+        _mm_storel_epi64((__m128i*)result, ph);
+
+        data += 4;
+        result += 4;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        __m128 ps = _mm_loadu_ps((float*)&in_buf[0]);
+        __m128i ph = cvtps_ph_mode(ps, mode);
+        _mm_storel_epi64((__m128i*)out_buf, ph);
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+#endif
+
+#if defined(__aarch64__)
+// same as f16_fix_special on 8 f16 values
+static inline uint16x8_t fix_special_neon(uint16x8_t h, int flags)
+{
+    uint16x8_t abs = vandq_u16(h, vdupq_n_u16(0x7FFF));
+    uint16x8_t nan_mask = vcgtq_u16(abs, vdupq_n_u16(0x7C00));
+
+    if (flags & F16_SATURATE) {
+        uint16x8_t inf_mask = vceqq_u16(abs, vdupq_n_u16(0x7C00));
+        h = vaddq_u16(h, inf_mask);
+    }
+
+    if (flags & F16_NAN_TO_ZERO)
+        h = vbicq_u16(h, nan_mask);
+    else if (flags & F16_NAN_CANONICAL)
+        h = vbslq_u16(nan_mask, vdupq_n_u16(0x7E00), h);
+
+    return h;
+}
+
+static inline uint16x8_t cvt8_special(const uint32_t *data, int flags)
+{
+    float32x4_t lo = vld1q_f32((const float*)data);
+    float32x4_t hi = vld1q_f32((const float*)data + 4);
+    float16x8_t ph = vcvt_high_f16_f32(vcvt_f16_f32(lo), hi);
+    return fix_special_neon(vreinterpretq_u16_f16(ph), flags);
+}
+
+void f32_to_f16_buffer_hw_special(uint32_t *data, uint16_t *result, int data_size, int flags)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        vst1q_u16(result, cvt8_special(data, flags));
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[8] = {0};
+        uint16_t out_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        vst1q_u16(&out_buf[0], cvt8_special(in_buf, flags));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+#elif defined(__arm__)
+void f32_to_f16_buffer_hw_special(uint32_t *data, uint16_t *result, int data_size, int flags)
+{
+    int_float value;
+
+    for (int i =0; i < data_size; i++) {
+        value.i = data[i];
+        result[i] = f16_fix_special(to_f16(value.f), flags);
+    }
+}
+
+#else
+static inline __m128i cvt8_special(const uint32_t *data, int flags)
+{
+    __m128i lo = _mm_cvtps_ph(_mm_loadu_ps((const float*)data), _MM_FROUND_TO_NEAREST_INT);
+    __m128i hi = _mm_cvtps_ph(_mm_loadu_ps((const float*)data + 4), _MM_FROUND_TO_NEAREST_INT);
+    return f16_fix_special_sse2(_mm_unpacklo_epi64(lo, hi), flags);
+}
+
+void f32_to_f16_buffer_hw_special(uint32_t *data, uint16_t *result, int data_size, int flags)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        _mm_storeu_si128((__m128i*)result, cvt8_special(data, flags));
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[8] = {0};
+        uint16_t out_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        _mm_storeu_si128((__m128i*)&out_buf[0], cvt8_special(in_buf, flags));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+#endif
+
+#if defined(__aarch64__) || defined(__arm__)
+void f32_to_f16_buffer_hw_stats(uint32_t *data, uint16_t *result, int data_size, F16ConvertStats *stats)
+{
+    int_float value;
+
+    f16_stats_init(stats);
+
+    for (int i =0; i < data_size; i++) {
+        value.i = data[i];
+        result[i] = to_f16(value.f);
+        f16_stats_add(stats, data[i]);
+    }
+}
+#else
+void f32_to_f16_buffer_hw_stats(uint32_t *data, uint16_t *result, int data_size, F16ConvertStats *stats)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    F16StatsSSE2 acc;
+
+    f16_stats_init(stats);
+    f16_stats_sse2_init(&acc);
+
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = _mm_loadu_ps((float*)data);
+        __m128i ph = _mm_cvtps_ph(ps, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)result, ph);
+        f16_stats_sse2_add(&acc, ps);
+
+        data += 4;
+        result += 4;
+    }
+
+    f16_stats_sse2_finish(&acc, stats);
+
+    // zero padding the tail would count as a finite value, so it goes one at a time
+    f32_to_f16_buffer_hw(data, result, remainder);
+    for (int i = 0; i < remainder; i++) {
+        f16_stats_add(stats, data[i]);
+    }
+}
+#endif
+
+#if defined(__aarch64__)
+// fcvtxn narrows double to float with round to odd, so the second rounding is exact
+static inline float16x4_t cvt4_f64(const uint64_t *data)
+{
+    float64x2_t lo = vld1q_f64((const double*)data);
+    float64x2_t hi = vld1q_f64((const double*)data + 2);
+    return vcvt_f16_f32(vcvtx_high_f32_f64(vcvtx_f32_f64(lo), hi));
+}
+
+void f64_to_f16_buffer_hw(uint64_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=4) {
+        vst1_u16(result, vreinterpret_u16_f16(cvt4_f64(data)));
+
+        data += 4;
+        result += 4;
+    }
+
+    if (remainder) {
+        uint64_t in_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        vst1_u16(&out_buf[0], vreinterpret_u16_f16(cvt4_f64(in_buf)));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+#elif defined(__arm__)
+void f64_to_f16_buffer_hw(uint64_t *data, uint16_t *result, int data_size)
+{
+    f64_to_f16_buffer(data, result, data_size);
+}
+
+#else
+// round to odd through float, see round_to_odd.h
+void f64_to_f16_buffer_hw(uint64_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = cvtpd_ps_odd_sse2_x2(_mm_loadu_pd((double*)data), _mm_loadu_pd((double*)data + 2));
+        __m128i ph = _mm_cvtps_ph(ps, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)result, ph);
+
+        data += 4;
+        result += 4;
+    }
+
+    if (remainder) {
+        uint64_t in_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        __m128 ps = cvtpd_ps_odd_sse2_x2(_mm_loadu_pd((double*)&in_buf[0]), _mm_loadu_pd((double*)&in_buf[2]));
+        __m128i ph = _mm_cvtps_ph(ps, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)&out_buf[0], ph);
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+#endif
+
+#if defined(__aarch64__)
+void f16_to_f64_buffer_hw(uint16_t *data, uint64_t *result, int data_size)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=4) {
+        float32x4_t ps = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(data)));
+        vst1q_f64((double*)result, vcvt_f64_f32(vget_low_f32(ps)));
+        vst1q_f64((double*)result + 2, vcvt_high_f64_f32(ps));
+
+        data += 4;
+        result += 4;
+    }
+
+    for (int i = 0; i < remainder; i++) {
+        union { uint64_t u; double d; } value;
+        value.d = f16_to_f32_hw(data[i]);
+        result[i] = value.u;
+    }
+}
+
+// fcvtns already rounds to nearest even, saturates and turns nan into 0
+void f16_to_i32_buffer_hw(uint16_t *data, int32_t *result, int data_size, float scale)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    float32x4_t s = vdupq_n_f32(scale);
+
+    for (int i = 0; i < size; i+=4) {
+        float32x4_t ps = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(data)));
+        vst1q_s32(result, vcvtnq_s32_f32(vmulq_f32(ps, s)));
+
+        data += 4;
+        result += 4;
+    }
+
+    for (int i = 0; i < remainder; i++) {
+        result[i] = f32_to_i32_scaled(f16_to_f32_hw(data[i]), scale);
+    }
+}
+
+#elif defined(__arm__)
+void f16_to_f64_buffer_hw(uint16_t *data, uint64_t *result, int data_size)
+{
+    union { uint64_t u; double d; } value;
+
+    for (int i =0; i < data_size; i++) {
+        value.d = f16_to_f32_hw(data[i]);
+        result[i] = value.u;
+    }
+}
+
+void f16_to_i32_buffer_hw(uint16_t *data, int32_t *result, int data_size, float scale)
+{
+    for (int i =0; i < data_size; i++) {
+        result[i] = f32_to_i32_scaled(f16_to_f32_hw(data[i]), scale);
+    }
+}
+
+#else
+void f16_to_f64_buffer_hw(uint16_t *data, uint64_t *result, int data_size)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)data));
+        _mm_storeu_pd((double*)result, _mm_cvtps_pd(ps));
+        _mm_storeu_pd((double*)result + 2, _mm_cvtps_pd(_mm_movehl_ps(ps, ps)));
+
+        data += 4;
+        result += 4;
+    }
+
+    if (remainder) {
+        uint16_t in_buf[4] = {0};
+        uint64_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        __m128 ps = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)&in_buf[0]));
+        _mm_storeu_pd((double*)&out_buf[0], _mm_cvtps_pd(ps));
+        _mm_storeu_pd((double*)&out_buf[2], _mm_cvtps_pd(_mm_movehl_ps(ps, ps)));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+void f16_to_i32_buffer_hw(uint16_t *data, int32_t *result, int data_size, float scale)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    __m128 s = _mm_set1_ps(scale);
+
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)data));
+        _mm_storeu_si128((__m128i*)result, cvtps_epi32_scaled_sse2(ps, s));
+
+        data += 4;
+        result += 4;
+    }
+
+    if (remainder) {
+        uint16_t in_buf[4] = {0};
+        int32_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        __m128 ps = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)&in_buf[0]));
+        _mm_storeu_si128((__m128i*)&out_buf[0], cvtps_epi32_scaled_sse2(ps, s));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+#endif
+
+// in place, the tails go through memcpy since the same bytes are read as one
+// type and written as the other
+#if defined(__aarch64__)
+void f32_to_f16_buffer_hw_inplace(uint32_t *data, int data_size)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    uint16_t *result = (uint16_t*)data;
+
+    // the 4 halves land on bytes of floats that were already loaded
+    for (int i = 0; i < size; i+=4) {
+        float32x4_t ps = vld1q_f32((const float*)data + i);
+        vst1_u16(result + i, vreinterpret_u16_f16(vcvt_f16_f32(ps)));
+    }
+
+    if (remainder) {
+        uint32_t in_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        memcpy(in_buf, data + size, remainder * sizeof(uint32_t));
+
+        float32x4_t ps = vld1q_f32((const float*)&in_buf[0]);
+        vst1_u16(&out_buf[0], vreinterpret_u16_f16(vcvt_f16_f32(ps)));
+
+        memcpy(result + size, out_buf, remainder * sizeof(uint16_t));
+    }
+}
+
+void f16_to_f32_buffer_hw_inplace(uint16_t *data, int data_size)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    uint32_t *result = (uint32_t*)data;
+
+    // back to front, the 4 floats only cover halves at or past the ones just loaded
+    if (remainder) {
+        uint16_t in_buf[4] = {0};
+        uint32_t out_buf[4] = {0};
+        memcpy(in_buf, data + size, remainder * sizeof(uint16_t));
+
+        float16x4_t ph = vreinterpret_f16_u16(vld1_u16(&in_buf[0]));
+        vst1q_u32(&out_buf[0], vreinterpretq_u32_f32(vcvt_f32_f16(ph)));
+
+        memcpy(result + size, out_buf, remainder * sizeof(uint32_t));
+    }
+
+    for (int i = size - 4; i >= 0; i-=4) {
+        float16x4_t ph = vreinterpret_f16_u16(vld1_u16(data + i));
+        vst1q_u32(result + i, vreinterpretq_u32_f32(vcvt_f32_f16(ph)));
+    }
+}
+
+#elif defined(__arm__)
+void f32_to_f16_buffer_hw_inplace(uint32_t *data, int data_size)
+{
+    for (int i = 0; i < data_size; i++) {
+        float v;
+        uint16_t h;
+        memcpy(&v, (char*)data + i * sizeof(float), sizeof(float));
+        h = to_f16(v);
+        memcpy((char*)data + i * sizeof(uint16_t), &h, sizeof(uint16_t));
+    }
+}
+
+void f16_to_f32_buffer_hw_inplace(uint16_t *data, int data_size)
+{
+    for (int i = data_size - 1; i >= 0; i--) {
+        uint16_t h;
+        uint32_t v;
+        memcpy(&h, (char*)data + i * sizeof(uint16_t), sizeof(uint16_t));
+        v = to_f32(h);
+        memcpy((char*)data + i * sizeof(uint32_t), &v, sizeof(uint32_t));
+    }
+}
+
+#else
+void f32_to_f16_buffer_hw_inplace(uint32_t *data, int data_size)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    uint16_t *result = (uint16_t*)data;
+
+    // the 4 halves land on bytes of floats that were already loaded
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = _mm_loadu_ps((float*)data + i);
+        __m128i ph = _mm_cvtps_ph(ps, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)(result + i), ph);
+    }
+
+    if (remainder) {
+        uint32_t in_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        memcpy(in_buf, data + size, remainder * sizeof(uint32_t));
+
+        __m128 ps = _mm_loadu_ps((float*)&in_buf[0]);
+        __m128i ph = _mm_cvtps_ph(ps, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)&out_buf[0], ph);
+
+        memcpy(result + size, out_buf, remainder * sizeof(uint16_t));
+    }
+}
+
+void f16_to_f32_buffer_hw_inplace(uint16_t *data, int data_size)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    uint32_t *result = (uint32_t*)data;
+
+    // back to front, the 4 floats only cover halves at or past the ones just loaded
+    if (remainder) {
+        uint16_t in_buf[4] = {0};
+        uint32_t out_buf[4] = {0};
+        memcpy(in_buf, data + size, remainder * sizeof(uint16_t));
+
+        __m128 p = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)&in_buf[0]));
+        _mm_storeu_si128((__m128i*)&out_buf[0], _mm_castps_si128(p));
+
+        memcpy(result + size, out_buf, remainder * sizeof(uint32_t));
+    }
+
+    for (int i = size - 4; i >= 0; i-=4) {
+        __m128 p = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)(data + i)));
+        _mm_storeu_si128((__m128i*)(result + i), _mm_castps_si128(p));
+    }
+}
+#endif
+
+#if defined(__aarch64__)
+// vld4q/vst4q do the deinterleave as part of the load and store
+static inline void rgba_to_planar4(const uint32_t *src, uint16_t *planes[4], int x)
+{
+    float32x4x4_t p = vld4q_f32((const float*)src);
+    vst1_u16(planes[0] + x, vreinterpret_u16_f16(vcvt_f16_f32(p.val[0])));
+    vst1_u16(planes[1] + x, vreinterpret_u16_f16(vcvt_f16_f32(p.val[1])));
+    vst1_u16(planes[2] + x, vreinterpret_u16_f16(vcvt_f16_f32(p.val[2])));
+    vst1_u16(planes[3] + x, vreinterpret_u16_f16(vcvt_f16_f32(p.val[3])));
+}
+
+static inline void planar_to_rgba4(uint16_t *planes[4], int x, uint32_t *dst)
+{
+    float32x4x4_t p;
+    p.val[0] = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(planes[0] + x)));
+    p.val[1] = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(planes[1] + x)));
+    p.val[2] = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(planes[2] + x)));
+    p.val[3] = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(planes[3] + x)));
+    vst4q_f32((float*)dst, p);
+}
+#elif !defined(__arm__)
+static inline void rgba_to_planar4(const uint32_t *src, uint16_t *planes[4], int x)
+{
+    __m128 r = _mm_loadu_ps((const float*)src);
+    __m128 g = _mm_loadu_ps((const float*)src + 4);
+    __m128 b = _mm_loadu_ps((const float*)src + 8);
+    __m128 a = _mm_loadu_ps((const float*)src + 12);
+    _MM_TRANSPOSE4_PS(r, g, b, a);
+    _mm_storel_epi64((__m128i*)(planes[0] + x), _mm_cvtps_ph(r, _MM_FROUND_TO_NEAREST_INT));
+    _mm_storel_epi64((__m128i*)(planes[1] + x), _mm_cvtps_ph(g, _MM_FROUND_TO_NEAREST_INT));
+    _mm_storel_epi64((__m128i*)(planes[2] + x), _mm_cvtps_ph(b, _MM_FROUND_TO_NEAREST_INT));
+    _mm_storel_epi64((__m128i*)(planes[3] + x), _mm_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT));
+}
+
+static inline void planar_to_rgba4(uint16_t *planes[4], int x, uint32_t *dst)
+{
+    __m128 r = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)(planes[0] + x)));
+    __m128 g = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)(planes[1] + x)));
+    __m128 b = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)(planes[2] + x)));
+    __m128 a = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)(planes[3] + x)));
+    _MM_TRANSPOSE4_PS(r, g, b, a);
+    _mm_storeu_ps((float*)dst, r);
+    _mm_storeu_ps((float*)dst + 4, g);
+    _mm_storeu_ps((float*)dst + 8, b);
+    _mm_storeu_ps((float*)dst + 12, a);
+}
+#endif
+
+#if defined(__arm__)
+void f32_rgba_to_f16_planar_hw(uint32_t *data, int data_stride, uint16_t *planes[4], int plane_stride, int width, int height)
+{
+    f32_rgba_to_f16_planar(f32_to_f16_buffer_hw, data, data_stride, planes, plane_stride, width, height);
+}
+
+void f16_planar_to_f32_rgba_hw(uint16_t *planes[4], int plane_stride, uint32_t *result, int result_stride, int width, int height)
+{
+    f16_planar_to_f32_rgba(f16_to_f32_buffer_hw, planes, plane_stride, result, result_stride, width, height);
+}
+#else
+// 4 pixels per step, the last few pixels of a row go through the same step on the stack
+void f32_rgba_to_f16_planar_hw(uint32_t *data, int data_stride, uint16_t *planes[4], int plane_stride, int width, int height)
+{
+    int size = width / 4 * 4;
+    int remainder = width - size;
+
+    for (int y = 0; y < height; y++) {
+        uint32_t *src = IMAGE_ROW(uint32_t, data, data_stride, y);
+        uint16_t *row[4];
+        for (int c = 0; c < 4; c++) {
+            row[c] = IMAGE_ROW(uint16_t, planes[c], plane_stride, y);
+        }
+
+        for (int x = 0; x < size; x+=4) {
+            rgba_to_planar4(src + x * 4, row, x);
+        }
+
+        if (remainder) {
+            uint32_t in_buf[16] = {0};
+            uint16_t out_buf[4][4];
+            uint16_t *out[4] = {out_buf[0], out_buf[1], out_buf[2], out_buf[3]};
+            for (int i = 0; i < remainder * 4; i++) {
+                in_buf[i] = src[size * 4 + i];
+            }
+
+            rgba_to_planar4(in_buf, out, 0);
+
+            for (int c = 0; c < 4; c++) {
+                for (int i = 0; i < remainder; i++) {
+                    row[c][size + i] = out_buf[c][i];
+                }
+            }
+        }
+    }
+}
+
+void f16_planar_to_f32_rgba_hw(uint16_t *planes[4], int plane_stride, uint32_t *result, int result_stride, int width, int height)
+{
+    int size = width / 4 * 4;
+    int remainder = width - size;
+
+    for (int y = 0; y < height; y++) {
+        uint32_t *dst = IMAGE_ROW(uint32_t, result, result_stride, y);
+        uint16_t *row[4];
+        for (int c = 0; c < 4; c++) {
+            row[c] = IMAGE_ROW(uint16_t, planes[c], plane_stride, y);
+        }
+
+        for (int x = 0; x < size; x+=4) {
+            planar_to_rgba4(row, x, dst + x * 4);
+        }
+
+        if (remainder) {
+            uint16_t in_buf[4][4] = {{0}};
+            uint32_t out_buf[16];
+            uint16_t *in[4] = {in_buf[0], in_buf[1], in_buf[2], in_buf[3]};
+            for (int c = 0; c < 4; c++) {
+                for (int i = 0; i < remainder; i++) {
+                    in_buf[c][i] = row[c][size + i];
+                }
+            }
+
+            planar_to_rgba4(in, 0, out_buf);
+
+            for (int i = 0; i < remainder * 4; i++) {
+                dst[size * 4 + i] = out_buf[i];
+            }
+        }
+    }
+}
+#endif
+
+#if defined(__aarch64__) || defined(__arm__)
+#define CHANNELS_CHUNK 256
+
+// no shuffle immediates needed here, convert a chunk on the stack then pack it
+void f32_to_f16_channels_hw(uint32_t *data, uint16_t *result, int pixels, int mask)
+{
+    uint16_t buf[CHANNELS_CHUNK * 4];
+    int count = f16_channel_count(mask);
+
+    for (int i = 0; i < pixels; i += CHANNELS_CHUNK) {
+        int n = pixels - i < CHANNELS_CHUNK ? pixels - i : CHANNELS_CHUNK;
+        f32_to_f16_buffer_hw(data + i * 4, buf, n * 4);
+        f16_pack_channels(buf, result, n, mask);
+        result += n * count;
+    }
+}
+
+#else
+#define CHANNELS_SHUFFLE_CASE(mask, a, b, c, d) \
+    case mask: return _mm_shufflehi_epi16(_mm_shufflelo_epi16(ph, _MM_SHUFFLE(d, c, b, a)), _MM_SHUFFLE(d, c, b, a));
+
+// the shuffles take immediates, each mask gets its own constant
+static inline __m128i shuffle_channels(__m128i ph, const int mask)
+{
+    switch (mask) {
+        F16_CHANNEL_SHUFFLES(CHANNELS_SHUFFLE_CASE)
+    }
+    return ph;
+}
+
+// 2 pixels, each is stored as 4 halves but the next one starts count halves later
+static inline void cvt2_channels(const uint32_t *data, uint16_t *result, const int mask, const int count)
+{
+    __m128i lo = _mm_cvtps_ph(_mm_loadu_ps((const float*)data), _MM_FROUND_TO_NEAREST_INT);
+    __m128i hi = _mm_cvtps_ph(_mm_loadu_ps((const float*)data + 4), _MM_FROUND_TO_NEAREST_INT);
+    __m128i ph = shuffle_channels(_mm_unpacklo_epi64(lo, hi), mask);
+    _mm_storel_epi64((__m128i*)result, ph);
+    _mm_storel_epi64((__m128i*)(result + count), _mm_unpackhi_epi64(ph, ph));
+}
+
+static inline void cvt_channels(uint32_t *data, uint16_t *result, int pixels, const int mask)
+{
+    const int count = f16_channel_count(mask);
+    // the extra halves of the last store still have to land inside result
+    int direct = pixels - (4 + count - 1) / count + 1;
+    int size = direct > 0 ? direct / 2 * 2 : 0;
+    int remainder = pixels - size;
+
+    for (int i = 0; i < size; i+=2) {
+        cvt2_channels(data, result, mask, count);
+
+        data += 8;
+        result += count * 2;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[16] = {0};
+        uint16_t out_buf[16] = {0};
+        for (int i = 0; i < remainder * 4; i++) {
+            in_buf[i] = data[i];
+        }
+
+        for (int i = 0; i < remainder; i+=2) {
+            cvt2_channels(&in_buf[i * 4], &out_buf[i * count], mask, count);
+        }
+
+        for (int i = 0; i < remainder * count; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+#define CHANNELS_CALL_CASE(mask, a, b, c, d) \
+    case mask: cvt_channels(data, result, pixels, mask); break;
+
+void f32_to_f16_channels_hw(uint32_t *data, uint16_t *result, int pixels, int mask)
+{
+    // pass the mask as a constant so each loop only has its own shuffle
+    switch (mask & F16_CHANNELS_RGBA) {
+        F16_CHANNEL_SHUFFLES(CHANNELS_CALL_CASE)
+        case F16_CHANNELS_RGBA: f32_to_f16_buffer_hw(data, result, pixels * 4); break;
+        default: break;
+    }
+}
+#endif
+
+// the multiply and add round separately, so the result matches a float loop
+// followed by the plain conversion. f16c doesn't imply fma either
+#if defined(__aarch64__)
+static inline void cvt_scale_bias(uint32_t *data, uint16_t *result, int data_size, float32x4_t scale, float32x4_t bias)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=4) {
+        float32x4_t ps = vaddq_f32(vmulq_f32(vld1q_f32((const float*)data), scale), bias);
+        vst1_u16(result, vreinterpret_u16_f16(vcvt_f16_f32(ps)));
+
+        data += 4;
+        result += 4;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        float32x4_t ps = vaddq_f32(vmulq_f32(vld1q_f32((const float*)&in_buf[0]), scale), bias);
+        vst1_u16(&out_buf[0], vreinterpret_u16_f16(vcvt_f16_f32(ps)));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+void f32_to_f16_buffer_hw_scale_bias(uint32_t *data, uint16_t *result, int data_size, float scale, float bias)
+{
+    cvt_scale_bias(data, result, data_size, vdupq_n_f32(scale), vdupq_n_f32(bias));
+}
+
+void f32_to_f16_buffer_hw_scale_bias4(uint32_t *data, uint16_t *result, int data_size, const float scale[4], const float bias[4])
+{
+    cvt_scale_bias(data, result, data_size, vld1q_f32(scale), vld1q_f32(bias));
+}
+
+#elif defined(__arm__)
+void f32_to_f16_buffer_hw_scale_bias(uint32_t *data, uint16_t *result, int data_size, float scale, float bias)
+{
+    int_float value;
+
+    for (int i = 0; i < data_size; i++) {
+        value.i = data[i];
+        result[i] = to_f16(value.f * scale + bias);
+    }
+}
+
+void f32_to_f16_buffer_hw_scale_bias4(uint32_t *data, uint16_t *result, int data_size, const float scale[4], const float bias[4])
+{
+    int_float value;
+
+    for (int i = 0; i < data_size; i++) {
+        value.i = data[i];
+        result[i] = to_f16(value.f * scale[i & 3] + bias[i & 3]);
+    }
+}
+
+#else
+// 4 lanes line up with the 4 channels as long as each step is 4 elements
+static inline void cvt_scale_bias(uint32_t *data, uint16_t *result, int data_size, __m128 scale, __m128 bias)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps((float*)data), scale), bias);
+        __m128i ph = _mm_cvtps_ph(ps, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)result, ph);
+
+        data += 4;
+        result += 4;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        __m128 ps = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps((float*)&in_buf[0]), scale), bias);
+        __m128i ph = _mm_cvtps_ph(ps, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)&out_buf[0], ph);
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+void f32_to_f16_buffer_hw_scale_bias(uint32_t *data, uint16_t *result, int data_size, float scale, float bias)
+{
+    cvt_scale_bias(data, result, data_size, _mm_set1_ps(scale), _mm_set1_ps(bias));
+}
+
+void f32_to_f16_buffer_hw_scale_bias4(uint32_t *data, uint16_t *result, int data_size, const float scale[4], const float bias[4])
+{
+    cvt_scale_bias(data, result, data_size, _mm_loadu_ps(scale), _mm_loadu_ps(bias));
+}
+#endif
+
+// reductions decode straight into registers, nothing is written back as floats
+#if defined(__aarch64__) || defined(__arm__)
+static inline float reduce_term(const uint16_t *a, const uint16_t *b, int i, const int dot)
+{
+    int_float x;
+    int_float y;
+
+    x.i = to_f32(a[i]);
+    if (!dot)
+        return x.f;
+    y.i = to_f32(b[i]);
+    return x.f * y.f;
+}
+
+static float sum_pairwise(const uint16_t *a, const uint16_t *b, int size, const int dot)
+{
+    if (size <= F16_PAIRWISE_BLOCK) {
+        float sum = 0.0f;
+        for (int i = 0; i < size; i++) {
+            sum += reduce_term(a, b, i, dot);
+        }
+        return sum;
+    }
+
+    int half = size / 2;
+    return sum_pairwise(a, b, half, dot) + sum_pairwise(a + half, dot ? b + half : b, size - half, dot);
+}
+
+static inline float reduce(const uint16_t *a, const uint16_t *b, int data_size, int mode, const int dot)
+{
+    F16Sum s;
+    f16_sum_init(&s);
+
+    if (mode == F16_SUM_PAIRWISE)
+        return sum_pairwise(a, b, data_size, dot);
+
+    for (int i = 0; i < data_size; i++) {
+        if (mode == F16_SUM_KAHAN)
+            f16_sum_add_kahan(&s, reduce_term(a, b, i, dot));
+        else
+            s.sum += reduce_term(a, b, i, dot);
+    }
+    return s.sum - s.c;
+}
+
+void f16_minmax_buffer_hw(uint16_t *data, int data_size, float *min, float *max)
+{
+    *min = INFINITY;
+    *max = -INFINITY;
+
+    // nan compares false both ways so it never gets in
+    for (int i = 0; i < data_size; i++) {
+        float v = reduce_term(data, NULL, i, 0);
+        if (v < *min)
+            *min = v;
+        if (v > *max)
+            *max = v;
+    }
+}
+
+#else
+static inline __m128 reduce_term(const uint16_t *a, const uint16_t *b, const int dot)
+{
+    __m128 ps = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)a));
+    if (dot)
+        ps = _mm_mul_ps(ps, _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)b)));
+    return ps;
+}
+
+// size is a multiple of 4, halves are split on a vector boundary
+static __m128 sum_pairwise(const uint16_t *a, const uint16_t *b, int size, const int dot)
+{
+    if (size <= F16_PAIRWISE_BLOCK) {
+        __m128 sum = _mm_setzero_ps();
+        for (int i = 0; i < size; i+=4) {
+            sum = _mm_add_ps(sum, reduce_term(a + i, dot ? b + i : b, dot));
+        }
+        return sum;
+    }
+
+    int half = size / 8 * 4;
+    return _mm_add_ps(sum_pairwise(a, b, half, dot), sum_pairwise(a + half, dot ? b + half : b, size - half, dot));
+}
+
+static inline float reduce(const uint16_t *a, const uint16_t *b, int data_size, int mode, const int dot)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    F16SumSSE2 acc;
+
+    f16_sum_sse2_init(&acc);
+
+    if (mode == F16_SUM_PAIRWISE) {
+        acc.sum = sum_pairwise(a, b, size, dot);
+    } else if (mode == F16_SUM_KAHAN) {
+        for (int i = 0; i < size; i+=4) {
+            f16_sum_sse2_add_kahan(&acc, reduce_term(a + i, dot ? b + i : b, dot));
+        }
+    } else {
+        for (int i = 0; i < size; i+=4) {
+            f16_sum_sse2_add(&acc, reduce_term(a + i, dot ? b + i : b, dot));
+        }
+    }
+
+    // zero halves add nothing to either sum
+    if (remainder) {
+        uint16_t a_buf[4] = {0};
+        uint16_t b_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            a_buf[i] = a[size + i];
+            b_buf[i] = dot ? b[size + i] : 0;
+        }
+
+        if (mode == F16_SUM_KAHAN)
+            f16_sum_sse2_add_kahan(&acc, reduce_term(a_buf, b_buf, dot));
+        else
+            f16_sum_sse2_add(&acc, reduce_term(a_buf, b_buf, dot));
+    }
+
+    return f16_sum_sse2_finish(&acc);
+}
+
+void f16_minmax_buffer_hw(uint16_t *data, int data_size, float *min, float *max)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    __m128 lo = _mm_set1_ps(INFINITY);
+    __m128 hi = _mm_set1_ps(-INFINITY);
+
+    for (int i = 0; i < size; i+=4) {
+        f16_minmax_sse2_add(&lo, &hi, _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)(data + i))));
+    }
+
+    // the tail is padded with nan, which min and max skip
+    if (remainder) {
+        uint16_t in_buf[4] = {0x7E00, 0x7E00, 0x7E00, 0x7E00};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[size + i];
+        }
+
+        f16_minmax_sse2_add(&lo, &hi, _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)&in_buf[0])));
+    }
+
+    f16_minmax_sse2_finish(lo, hi, min, max);
+}
+#endif
+
+float f16_sum_buffer_hw(uint16_t *data, int data_size, int mode)
+{
+    return reduce(data, NULL, data_size, mode, 0);
+}
+
+float f16_dot_buffer_hw(uint16_t *a, uint16_t *b, int data_size, int mode)
+{
+    return reduce(a, b, data_size, mode, 1);
+}
+
+// elementwise math on halves, see arith.h. result can be a or b, each
+// vector is loaded before it is stored
+#if defined(__aarch64__)
+static inline float32x4_t arith_neon(float32x4_t a, float32x4_t b, float32x4_t s, const int op)
+{
+    switch (op) {
+        case F16_OP_AXPY: return vaddq_f32(vmulq_f32(s, a), b);
+        case F16_OP_ADD:  return vaddq_f32(a, b);
+        case F16_OP_MUL:  return vmulq_f32(a, b);
+        default:          return vaddq_f32(a, vmulq_f32(s, vsubq_f32(b, a)));
+    }
+}
+
+static inline float16x4_t arith4(const uint16_t *a, const uint16_t *b, float32x4_t s, const int op)
+{
+    float32x4_t pa = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(a)));
+    float32x4_t pb = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(b)));
+    return vcvt_f16_f32(arith_neon(pa, pb, s, op));
+}
+
+static inline void arith_buffer(uint16_t *a, uint16_t *b, uint16_t *result, int data_size, float scale, const int op)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    float32x4_t s = vdupq_n_f32(scale);
+
+    for (int i = 0; i < size; i+=4) {
+        vst1_u16(result + i, vreinterpret_u16_f16(arith4(a + i, b + i, s, op)));
+    }
+
+    if (remainder) {
+        uint16_t a_buf[4] = {0};
+        uint16_t b_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            a_buf[i] = a[size + i];
+            b_buf[i] = b[size + i];
+        }
+
+        vst1_u16(&out_buf[0], vreinterpret_u16_f16(arith4(a_buf, b_buf, s, op)));
+
+        for (int i = 0; i < remainder; i++) {
+            result[size + i] = out_buf[i];
+        }
+    }
+}
+
+#elif defined(__arm__)
+static inline void arith_buffer(uint16_t *a, uint16_t *b, uint16_t *result, int data_size, float scale, const int op)
+{
+    for (int i = 0; i < data_size; i++) {
+        result[i] = to_f16(f16_arith_f32(f16_to_f32_hw(a[i]), f16_to_f32_hw(b[i]), scale, op));
+    }
+}
+
+#else
+static inline __m128i arith4(const uint16_t *a, const uint16_t *b, __m128 s, const int op)
+{
+    __m128 pa = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)a));
+    __m128 pb = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)b));
+    return _mm_cvtps_ph(f16_arith_sse2(pa, pb, s, op), _MM_FROUND_TO_NEAREST_INT);
+}
+
+static inline void arith_buffer(uint16_t *a, uint16_t *b, uint16_t *result, int data_size, float scale, const int op)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    __m128 s = _mm_set1_ps(scale);
+
+    for (int i = 0; i < size; i+=4) {
+        _mm_storel_epi64((__m128i*)(result + i), arith4(a + i, b + i, s, op));
+    }
+
+    if (remainder) {
+        uint16_t a_buf[4] = {0};
+        uint16_t b_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            a_buf[i] = a[size + i];
+            b_buf[i] = b[size + i];
+        }
+
+        _mm_storel_epi64((__m128i*)&out_buf[0], arith4(a_buf, b_buf, s, op));
+
+        for (int i = 0; i < remainder; i++) {
+            result[size + i] = out_buf[i];
+        }
+    }
+}
+#endif
+
+void f16_axpy_buffer_hw(uint16_t *x, uint16_t *y, int data_size, float a)
+{
+    arith_buffer(x, y, y, data_size, a, F16_OP_AXPY);
+}
+
+void f16_add_buffer_hw(uint16_t *a, uint16_t *b, uint16_t *result, int data_size)
+{
+    arith_buffer(a, b, result, data_size, 0.0f, F16_OP_ADD);
+}
+
+void f16_mul_buffer_hw(uint16_t *a, uint16_t *b, uint16_t *result, int data_size)
+{
+    arith_buffer(a, b, result, data_size, 0.0f, F16_OP_MUL);
+}
+
+void f16_lerp_buffer_hw(uint16_t *a, uint16_t *b, uint16_t *result, int data_size, float t)
+{
+    arith_buffer(a, b, result, data_size, t, F16_OP_LERP);
+}
+
+// integer pixels to half, see integer/integer.h. u16 / 65535 is rounded to odd as
+// a float first, so the half is rounded once
+#if defined(__aarch64__)
+// fcvtxn rounds the double quotient to odd
+static inline float16x4_t cvt4_u16_unorm(const uint16_t *data)
+{
+    uint32x4_t v = vmovl_u16(vld1_u16(data));
+    float64x2_t lo = vmulq_n_f64(vcvtq_f64_u64(vmovl_u32(vget_low_u32(v))), 1.0 / 65535.0);
+    float64x2_t hi = vmulq_n_f64(vcvtq_f64_u64(vmovl_u32(vget_high_u32(v))), 1.0 / 65535.0);
+    return vcvt_f16_f32(vcvtx_high_f32_f64(vcvtx_f32_f64(lo), hi));
+}
+
+static inline void cvt8_u16_unorm(const uint16_t *data, uint16_t *result)
+{
+    vst1q_u16(result, vreinterpretq_u16_f16(vcombine_f16(cvt4_u16_unorm(data), cvt4_u16_unorm(data + 4))));
+}
+
+static inline void cvt8_i16(const int16_t *data, uint16_t *result)
+{
+    int16x8_t v = vld1q_s16(data);
+    float16x4_t lo = vcvt_f16_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))));
+    float16x4_t hi = vcvt_f16_f32(vcvtq_f32_s32(vmovl_high_s16(v)));
+    vst1q_u16(result, vreinterpretq_u16_f16(vcombine_f16(lo, hi)));
+}
+
+#elif !defined(__arm__)
+static inline __m128i cvt4_u16_unorm(__m128i v)
+{
+    return _mm_cvtps_ph(u16_unorm_ps_odd_sse2(v), _MM_FROUND_TO_NEAREST_INT);
+}
+
+static inline void cvt8_u16_unorm(const uint16_t *data, uint16_t *result)
+{
+    __m128i v = _mm_loadu_si128((const __m128i*)data);
+    __m128i lo = cvt4_u16_unorm(_mm_unpacklo_epi16(v, _mm_setzero_si128()));
+    __m128i hi = cvt4_u16_unorm(_mm_unpackhi_epi16(v, _mm_setzero_si128()));
+    _mm_storeu_si128((__m128i*)result, _mm_unpacklo_epi64(lo, hi));
+}
+
+// every int16 is exact as a float, so there is only the one rounding to half
+static inline void cvt8_i16(const int16_t *data, uint16_t *result)
+{
+    __m128i v = _mm_loadu_si128((const __m128i*)data);
+    __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+    __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+    _mm_storeu_si128((__m128i*)result, _mm_unpacklo_epi64(_mm_cvtps_ph(lo, _MM_FROUND_TO_NEAREST_INT),
+                                                          _mm_cvtps_ph(hi, _MM_FROUND_TO_NEAREST_INT)));
+}
+#endif
+
+#if defined(__arm__)
+void u16_unorm_to_f16_buffer_hw(uint16_t *data, uint16_t *result, int data_size)
+{
+    u16_unorm_to_f16_buffer(data, result, data_size);
+}
+
+void i16_to_f16_buffer_hw(int16_t *data, uint16_t *result, int data_size)
+{
+    i16_to_f16_buffer(data, result, data_size);
+}
+
+#else
+void u16_unorm_to_f16_buffer_hw(uint16_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        cvt8_u16_unorm(data, result);
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder) {
+        uint16_t in_buf[8] = {0};
+        uint16_t out_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        cvt8_u16_unorm(in_buf, out_buf);
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+void i16_to_f16_buffer_hw(int16_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        cvt8_i16(data, result);
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder) {
+        int16_t in_buf[8] = {0};
+        uint16_t out_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        cvt8_i16(in_buf, out_buf);
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+#endif
+
+// first float that does not come back from a round trip through half, see
+// representable/representable.h. the conversion is the definition, so convert and compare
+#if defined(__aarch64__)
+// bit i set if element i does not come back
+static inline int inexact8(const uint32_t *data)
+{
+    static const uint32_t lane_bits[4] = {1, 2, 4, 8};
+    uint32x4_t lo = vld1q_u32(data);
+    uint32x4_t hi = vld1q_u32(data + 4);
+    float16x8_t h = vcombine_f16(vcvt_f16_f32(vreinterpretq_f32_u32(lo)), vcvt_f16_f32(vreinterpretq_f32_u32(hi)));
+    uint32x4_t lo_back = vreinterpretq_u32_f32(vcvt_f32_f16(vget_low_f16(h)));
+    uint32x4_t hi_back = vreinterpretq_u32_f32(vcvt_high_f32_f16(h));
+    uint32x4_t bits = vld1q_u32(lane_bits);
+    uint32_t lo_bits = vaddvq_u32(vbicq_u32(bits, vceqq_u32(lo, lo_back)));
+    uint32_t hi_bits = vaddvq_u32(vbicq_u32(bits, vceqq_u32(hi, hi_back)));
+    return (int)(lo_bits | (hi_bits << 4));
+}
+#elif !defined(__arm__)
+static inline int inexact8(const uint32_t *data)
+{
+    __m128i lo = _mm_loadu_si128((const __m128i*)data);
+    __m128i hi = _mm_loadu_si128((const __m128i*)(data + 4));
+    __m128i h = _mm_unpacklo_epi64(_mm_cvtps_ph(_mm_castsi128_ps(lo), _MM_FROUND_TO_NEAREST_INT),
+                                   _mm_cvtps_ph(_mm_castsi128_ps(hi), _MM_FROUND_TO_NEAREST_INT));
+    __m128i lo_back = _mm_castps_si128(_mm_cvtph_ps(h));
+    __m128i hi_back = _mm_castps_si128(_mm_cvtph_ps(_mm_srli_si128(h, 8)));
+    int lo_bits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(lo, lo_back)));
+    int hi_bits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(hi, hi_back)));
+    return (lo_bits | (hi_bits << 4)) ^ 0xFF;
+}
+#endif
+
+#if defined(__arm__)
+int f32_find_inexact_f16_hw(uint32_t *data, int data_size)
+{
+    return f32_find_inexact_f16(data, data_size);
+}
+
+#else
+static inline int first_bit(int bits)
+{
+    int i = 0;
+    while (!(bits & (1 << i)))
+        i++;
+    return i;
+}
+
+int f32_find_inexact_f16_hw(uint32_t *data, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+    int bits;
+
+    for (int i = 0; i < size; i+=8) {
+        bits = inexact8(data + i);
+        if (bits)
+            return i + first_bit(bits);
+    }
+
+    // zeros always come back, so the padding never reports
+    if (remainder) {
+        uint32_t in_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[size + i];
+        }
+
+        bits = inexact8(in_buf);
+        if (bits)
+            return size + first_bit(bits);
+    }
+
+    return data_size;
+}
+#endif
@@ -1,8 +1,77 @@
 
 #include <stdint.h>
+#include "../round_mode.h"
+#include "../special_values.h"
+#include "../convert_stats.h"
+#include "../widen.h"
+#include "../channels.h"
+#include "../reduce.h"
+#include "../arith.h"
 
 uint16_t f32_to_f16_hw(float f);
 float f16_to_f32_hw(uint16_t f);
 
 void f32_to_f16_buffer_hw(uint32_t *data, uint16_t *result, int data_size);
-void f16_to_f32_buffer_hw(uint16_t *data, uint32_t *result, int data_size);
\ No newline at end of file
+void f16_to_f32_buffer_hw(uint16_t *data, uint32_t *result, int data_size);
+
+// mode is one of the F16_ROUND_TO_* values in round_mode.h
+uint16_t f32_to_f16_hw_mode(float f, int mode);
+void f32_to_f16_buffer_hw_mode(uint32_t *data, uint16_t *result, int data_size, int mode);
+
+// flags are F16_SATURATE, F16_NAN_TO_ZERO and F16_NAN_CANONICAL from special_values.h
+void f32_to_f16_buffer_hw_special(uint32_t *data, uint16_t *result, int data_size, int flags);
+
+// same as the plain buffer function, stats is filled in from the same pass over data
+void f32_to_f16_buffer_hw_stats(uint32_t *data, uint16_t *result, int data_size, F16ConvertStats *stats);
+
+// correctly rounded double to half
+void f64_to_f16_buffer_hw(uint64_t *data, uint16_t *result, int data_size);
+
+// exact half to double
+void f16_to_f64_buffer_hw(uint16_t *data, uint64_t *result, int data_size);
+// half * scale to int32, see widen.h
+void f16_to_i32_buffer_hw(uint16_t *data, int32_t *result, int data_size, float scale);
+
+// in place, data must have room for data_size uint32_t. f32 to f16 packs the halves
+// into the front of data, f16 to f32 widens from the end back so nothing is read after it is overwritten
+void f32_to_f16_buffer_hw_inplace(uint32_t *data, int data_size);
+void f16_to_f32_buffer_hw_inplace(uint16_t *data, int data_size);
+
+// interleaved rgba floats to 4 half planes and back in one pass, see image/image.h
+void f32_rgba_to_f16_planar_hw(uint32_t *data, int data_stride, uint16_t *planes[4], int plane_stride, int width, int height);
+void f16_planar_to_f32_rgba_hw(uint16_t *planes[4], int plane_stride, uint32_t *result, int result_stride, int width, int height);
+
+// converts only the channels in mask (see channels.h) of rgba floats, packed in rgba order
+void f32_to_f16_channels_hw(uint32_t *data, uint16_t *result, int pixels, int mask);
+
+// half(x * scale + bias), for exposure and offset before the conversion. the 4 version
+// uses scale[i % 4] and bias[i % 4] for element i, so rgba pixels get a gain per channel
+void f32_to_f16_buffer_hw_scale_bias(uint32_t *data, uint16_t *result, int data_size, float scale, float bias);
+void f32_to_f16_buffer_hw_scale_bias4(uint32_t *data, uint16_t *result, int data_size, const float scale[4], const float bias[4]);
+
+// reductions without a float buffer, mode is one of the F16_SUM_* values in reduce.h.
+// min and max skip nan, they are INFINITY and -INFINITY if there is nothing else
+float f16_sum_buffer_hw(uint16_t *data, int data_size, int mode);
+float f16_dot_buffer_hw(uint16_t *a, uint16_t *b, int data_size, int mode);
+void f16_minmax_buffer_hw(uint16_t *data, int data_size, float *min, float *max);
+
+// elementwise math with halves in and out, see arith.h. axpy updates y in place,
+// result may be the same buffer as a or b
+void f16_axpy_buffer_hw(uint16_t *x, uint16_t *y, int data_size, float a);
+void f16_add_buffer_hw(uint16_t *a, uint16_t *b, uint16_t *result, int data_size);
+void f16_mul_buffer_hw(uint16_t *a, uint16_t *b, uint16_t *result, int data_size);
+void f16_lerp_buffer_hw(uint16_t *a, uint16_t *b, uint16_t *result, int data_size, float t);
+
+// u16 / 65535 and int16 pixels to half, u8 pixels go through the tables in integer/integer.h
+void u16_unorm_to_f16_buffer_hw(uint16_t *data, uint16_t *result, int data_size);
+void i16_to_f16_buffer_hw(int16_t *data, uint16_t *result, int data_size);
+
+// index of the first float that does not survive a round trip through half, data_size
+// if they all do, see representable/representable.h
+int f32_find_inexact_f16_hw(uint32_t *data, int data_size);
+
+#if defined(__aarch64__) || defined(__arm__)
+// one element at a time through _Float16, leaves vectorizing up to the compiler
+void f32_to_f16_buffer_hw_scalar(uint32_t *data, uint16_t *result, int data_size);
+void f16_to_f32_buffer_hw_scalar(uint16_t *data, uint32_t *result, int data_size);
+#endif
@@ -0,0 +1,69 @@
+#include "image.h"
+
+// pixels per scratch chunk, 4 channels of floats stay well inside L1
+#define IMAGE_CHUNK 256
+
+void f32_to_f16_image(f32_to_f16_buffer_func func, uint32_t *data, int data_stride,
+                      uint16_t *result, int result_stride, int width, int height)
+{
+    for (int y = 0; y < height; y++) {
+        func(IMAGE_ROW(uint32_t, data, data_stride, y), IMAGE_ROW(uint16_t, result, result_stride, y), width);
+    }
+}
+
+void f16_to_f32_image(f16_to_f32_buffer_func func, uint16_t *data, int data_stride,
+                      uint32_t *result, int result_stride, int width, int height)
+{
+    for (int y = 0; y < height; y++) {
+        func(IMAGE_ROW(uint16_t, data, data_stride, y), IMAGE_ROW(uint32_t, result, result_stride, y), width);
+    }
+}
+
+void f32_rgba_to_f16_planar(f32_to_f16_buffer_func func, uint32_t *data, int data_stride,
+                            uint16_t *planes[4], int plane_stride, int width, int height)
+{
+    uint32_t in_buf[4][IMAGE_CHUNK];
+
+    for (int y = 0; y < height; y++) {
+        uint32_t *src = IMAGE_ROW(uint32_t, data, data_stride, y);
+
+        for (int x = 0; x < width; x += IMAGE_CHUNK) {
+            int count = width - x < IMAGE_CHUNK ? width - x : IMAGE_CHUNK;
+
+            for (int i = 0; i < count; i++) {
+                for (int c = 0; c < 4; c++) {
+                    in_buf[c][i] = src[(x + i) * 4 + c];
+                }
+            }
+
+            for (int c = 0; c < 4; c++) {
+                uint16_t *dst = IMAGE_ROW(uint16_t, planes[c], plane_stride, y) + x;
+                func(in_buf[c], dst, count);
+            }
+        }
+    }
+}
+
+void f16_planar_to_f32_rgba(f16_to_f32_buffer_func func, uint16_t *planes[4], int plane_stride,
+                            uint32_t *result, int result_stride, int width, int height)
+{
+    uint32_t out_buf[4][IMAGE_CHUNK];
+
+    for (int y = 0; y < height; y++) {
+        uint32_t *dst = IMAGE_ROW(uint32_t, result, result_stride, y);
+
+        for (int x = 0; x < width; x += IMAGE_CHUNK) {
+            int count = width - x < IMAGE_CHUNK ? width - x : IMAGE_CHUNK;
+
+            for (int c = 0; c < 4; c++) {
+                func(IMAGE_ROW(uint16_t, planes[c], plane_stride, y) + x, out_buf[c], count);
+            }
+
+            for (int i = 0; i < count; i++) {
+                for (int c = 0; c < 4; c++) {
+                    dst[(x + i) * 4 + c] = out_buf[c][i];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 2D conversions. strides are in bytes so rows can be padded to any alignment,
+// the buffer functions are any of the kernels' f32_to_f16_buffer / f16_to_f32_buffer
+
+#define IMAGE_ROW(type, base, stride, y) ((type*)((char*)(base) + (size_t)(y) * (size_t)(stride)))
+
+typedef void (*f32_to_f16_buffer_func)(uint32_t *data, uint16_t *result, int data_size);
+typedef void (*f16_to_f32_buffer_func)(uint16_t *data, uint32_t *result, int data_size);
+
+// width is in elements, one call per row
+void f32_to_f16_image(f32_to_f16_buffer_func func, uint32_t *data, int data_stride,
+                      uint16_t *result, int result_stride, int width, int height);
+void f16_to_f32_image(f16_to_f32_buffer_func func, uint16_t *data, int data_stride,
+                      uint32_t *result, int result_stride, int width, int height);
+
+// interleaved rgba floats to 4 half planes and back, width is in pixels and
+// every plane uses plane_stride. these go through a small scratch buffer on the
+// stack a chunk of pixels at a time, the simd kernels have fused versions
+void f32_rgba_to_f16_planar(f32_to_f16_buffer_func func, uint32_t *data, int data_stride,
+                            uint16_t *planes[4], int plane_stride, int width, int height);
+void f16_planar_to_f32_rgba(f16_to_f32_buffer_func func, uint16_t *planes[4], int plane_stride,
+                            uint32_t *result, int result_stride, int width, int height);
+
+#endif // IMAGE_H
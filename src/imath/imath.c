@@ -1,4 +1,5 @@
 #include "imath.h"
+#include "../target_clones.h"
 #include "imath_half.h"
 
 uint16_t f32_to_f16_imath(float f)
@@ -11,7 +12,7 @@ float f16_to_f32_imath(uint16_t h)
     return imath_half_to_float(h);
 }
 
-void f32_to_f16_buffer_imath(uint32_t *data, uint16_t *result, int data_size)
+TARGET_CLONES void f32_to_f16_buffer_imath(uint32_t *data, uint16_t *result, int data_size)
 {
     imath_half_uif_t value;
     for (int i =0; i < data_size; i++) {
@@ -20,7 +21,7 @@ void f32_to_f16_buffer_imath(uint32_t *data, uint16_t *result, int data_size)
     }
 }
 
-void f16_to_f32_buffer_imath(uint16_t *data, uint32_t *result, int data_size)
+TARGET_CLONES void f16_to_f32_buffer_imath(uint16_t *data, uint32_t *result, int data_size)
 {
     imath_half_uif_t value;
     for (int i =0; i < data_size; i++) {
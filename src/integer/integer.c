@@ -0,0 +1,47 @@
+#include "integer.h"
+#include "../f64/f64.h"
+#include "../display/display.h"
+
+uint16_t f16_u8_unorm_table[256 + F16_U8_TABLE_PAD];
+uint16_t f16_u8_srgb_table[256 + F16_U8_TABLE_PAD];
+static int integer_ready = 0;
+
+void f16_integer_init(void)
+{
+    if (integer_ready)
+        return;
+
+    for (int k = 0; k < 256; k++) {
+        f16_u8_unorm_table[k] = f64_to_f16(k / 255.0);
+        f16_u8_srgb_table[k] = f64_to_f16(f16_srgb_decode(k / 255.0));
+    }
+    for (int k = 256; k < 256 + F16_U8_TABLE_PAD; k++) {
+        f16_u8_unorm_table[k] = 0;
+        f16_u8_srgb_table[k] = 0;
+    }
+
+    integer_ready = 1;
+}
+
+void u8_to_f16_buffer(const uint16_t *table, uint8_t *data, uint16_t *result, int data_size)
+{
+    for (int i = 0; i < data_size; i++) {
+        result[i] = table[data[i]];
+    }
+}
+
+// the division is rounded to double first, but v / 65535 repeats the 16 bits
+// of v forever, so it is never close enough to a half tie for that to matter
+void u16_unorm_to_f16_buffer(uint16_t *data, uint16_t *result, int data_size)
+{
+    for (int i = 0; i < data_size; i++) {
+        result[i] = f64_to_f16(data[i] / 65535.0);
+    }
+}
+
+void i16_to_f16_buffer(int16_t *data, uint16_t *result, int data_size)
+{
+    for (int i = 0; i < data_size; i++) {
+        result[i] = f64_to_f16((double)data[i]);
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef INTEGER_H
+#define INTEGER_H
+
+#include <stdint.h>
+
+// 8 and 16 bit integer pixels to half. every input has one correctly rounded half
+// and there are few enough inputs that every kernel is checked on all of them
+
+// u8 to half tables for k / 255 and for the srgb curve decoded to linear light.
+// the pad keeps a 32 bit gather of the last entry inside the table
+#define F16_U8_TABLE_PAD 1
+extern uint16_t f16_u8_unorm_table[256 + F16_U8_TABLE_PAD];
+extern uint16_t f16_u8_srgb_table[256 + F16_U8_TABLE_PAD];
+
+// builds the tables, they are only built once
+void f16_integer_init(void);
+
+// table is f16_u8_unorm_table or f16_u8_srgb_table
+void u8_to_f16_buffer(const uint16_t *table, uint8_t *data, uint16_t *result, int data_size);
+// v / 65535
+void u16_unorm_to_f16_buffer(uint16_t *data, uint16_t *result, int data_size);
+// the integer itself, past 2048 the odd ones round to nearest even
+void i16_to_f16_buffer(int16_t *data, uint16_t *result, int data_size);
+
+#endif // INTEGER_H
@@ -0,0 +1,109 @@
+#include "integer_avx2.h"
+#include "../round_to_odd.h"
+#include <immintrin.h>
+
+// the table is gathered 32 bits at a time from index * 2, the high
+// half of each lane belongs to the next entry and is masked off
+static inline __m128i cvt8_u8(const uint16_t *table, const uint8_t *data)
+{
+    __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)data));
+    __m256i v = _mm256_i32gather_epi32((const int*)table, index, 2);
+    v = _mm256_and_si256(v, _mm256_set1_epi32(0xFFFF));
+    // same lane fix up as lut8_f16 in lut_avx2.c
+    v = _mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm256_castsi256_si128(v);
+}
+
+// u16 / 65535 rounded to odd as a float first, so the half is rounded once
+static inline __m128i cvt8_u16_unorm(const uint16_t *data)
+{
+    __m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)data));
+    return _mm256_cvtps_ph(u16_unorm_ps_odd_avx2(v), _MM_FROUND_TO_NEAREST_INT);
+}
+
+static inline __m128i cvt8_i16(const int16_t *data)
+{
+    __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)data));
+    return _mm256_cvtps_ph(_mm256_cvtepi32_ps(v), _MM_FROUND_TO_NEAREST_INT);
+}
+
+void u8_to_f16_buffer_avx2(const uint16_t *table, uint8_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        _mm_storeu_si128((__m128i*)result, cvt8_u8(table, data));
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder) {
+        uint8_t in_buf[8] = {0};
+        uint16_t out_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        _mm_storeu_si128((__m128i*)&out_buf[0], cvt8_u8(table, in_buf));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+void u16_unorm_to_f16_buffer_avx2(uint16_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        _mm_storeu_si128((__m128i*)result, cvt8_u16_unorm(data));
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder) {
+        uint16_t in_buf[8] = {0};
+        uint16_t out_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        _mm_storeu_si128((__m128i*)&out_buf[0], cvt8_u16_unorm(in_buf));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+void i16_to_f16_buffer_avx2(int16_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        _mm_storeu_si128((__m128i*)result, cvt8_i16(data));
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder) {
+        int16_t in_buf[8] = {0};
+        uint16_t out_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        _mm_storeu_si128((__m128i*)&out_buf[0], cvt8_i16(in_buf));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
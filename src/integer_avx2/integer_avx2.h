@@ -0,0 +1,7 @@
+#include <stdint.h>
+#include "../integer/integer.h"
+
+// integer pixels to half with 8 lanes, u8 through gathers from the integer.h tables
+void u8_to_f16_buffer_avx2(const uint16_t *table, uint8_t *data, uint16_t *result, int data_size);
+void u16_unorm_to_f16_buffer_avx2(uint16_t *data, uint16_t *result, int data_size);
+void i16_to_f16_buffer_avx2(int16_t *data, uint16_t *result, int data_size);
@@ -0,0 +1,80 @@
+#include "integer_sse2.h"
+#include "../round_to_odd.h"
+#include "../maratyszcza_sse2/cvtps_ph_sse2.h"
+
+// rounded to odd as a float first, see round_to_odd.h
+static inline __m128i cvt4_u16_unorm(__m128i v)
+{
+    return cvtps_ph_sse2(u16_unorm_ps_odd_sse2(v), _MM_FROUND_TO_NEAREST_INT);
+}
+
+static inline void cvt8_u16_unorm(const uint16_t *data, uint16_t *result)
+{
+    __m128i v = _mm_loadu_si128((const __m128i*)data);
+    __m128i lo = cvt4_u16_unorm(_mm_unpacklo_epi16(v, _mm_setzero_si128()));
+    __m128i hi = cvt4_u16_unorm(_mm_unpackhi_epi16(v, _mm_setzero_si128()));
+    _mm_storeu_si128((__m128i*)result, _mm_unpacklo_epi64(lo, hi));
+}
+
+static inline void cvt8_i16(const int16_t *data, uint16_t *result)
+{
+    __m128i v = _mm_loadu_si128((const __m128i*)data);
+    __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+    __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+    _mm_storeu_si128((__m128i*)result, _mm_unpacklo_epi64(cvtps_ph_sse2(lo, _MM_FROUND_TO_NEAREST_INT),
+                                                          cvtps_ph_sse2(hi, _MM_FROUND_TO_NEAREST_INT)));
+}
+
+void u16_unorm_to_f16_buffer_sse2(uint16_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        cvt8_u16_unorm(data, result);
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder) {
+        uint16_t in_buf[8] = {0};
+        uint16_t out_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        cvt8_u16_unorm(in_buf, out_buf);
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+void i16_to_f16_buffer_sse2(int16_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        cvt8_i16(data, result);
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder) {
+        int16_t in_buf[8] = {0};
+        uint16_t out_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        cvt8_i16(in_buf, out_buf);
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
@@ -0,0 +1,6 @@
+#include <stdint.h>
+#include "../integer/integer.h"
+
+// u16 / 65535 and int16 pixels to half using only sse2, see hardware.h
+void u16_unorm_to_f16_buffer_sse2(uint16_t *data, uint16_t *result, int data_size);
+void i16_to_f16_buffer_sse2(int16_t *data, uint16_t *result, int data_size);
@@ -0,0 +1,132 @@
+#include "lut.h"
+#include "../threads.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define LUT_MAX_THREADS 64
+// slices start on a cache line of halves
+#define LUT_SLICE_ALIGN 32
+
+typedef union {
+        uint32_t i;
+        float    f;
+} int_float;
+
+int f16_lut_build(F16Lut *lut, f16_lut_func func, void *ctx, f16_to_f32_buffer_func decode, f32_to_f16_buffer_func encode)
+{
+    uint16_t *index = (uint16_t*) malloc(sizeof(uint16_t) * F16_LUT_SIZE);
+    int_float value;
+
+    lut->half = (uint16_t*) calloc(F16_LUT_SIZE + F16_LUT_PAD, sizeof(uint16_t));
+    lut->f32 = (uint32_t*) calloc(F16_LUT_SIZE + F16_LUT_PAD, sizeof(uint32_t));
+
+    if (!index || !lut->half || !lut->f32) {
+        free(index);
+        f16_lut_free(lut);
+        return -1;
+    }
+
+    for (int i = 0; i < F16_LUT_SIZE; i++) {
+        index[i] = (uint16_t)i;
+    }
+
+    decode(index, lut->f32, F16_LUT_SIZE);
+    for (int i = 0; i < F16_LUT_SIZE; i++) {
+        value.i = lut->f32[i];
+        value.f = func(value.f, ctx);
+        lut->f32[i] = value.i;
+    }
+    encode(lut->f32, lut->half, F16_LUT_SIZE);
+
+    free(index);
+    return 0;
+}
+
+void f16_lut_free(F16Lut *lut)
+{
+    free(lut->half);
+    free(lut->f32);
+    lut->half = NULL;
+    lut->f32 = NULL;
+}
+
+void f16_lut_apply_f16(const F16Lut *lut, uint16_t *data, uint16_t *result, int data_size)
+{
+    const uint16_t *table = lut->half;
+
+    for (int i = 0; i < data_size; i++) {
+        result[i] = table[data[i]];
+    }
+}
+
+void f16_lut_apply_f32(const F16Lut *lut, uint16_t *data, uint32_t *result, int data_size)
+{
+    const uint32_t *table = lut->f32;
+
+    for (int i = 0; i < data_size; i++) {
+        result[i] = table[data[i]];
+    }
+}
+
+typedef struct LutSlice {
+    const F16Lut *lut;
+    f16_lut_apply_f16_func f16_func;
+    f16_lut_apply_f32_func f32_func;
+    uint16_t *data;
+    void *result;
+    int offset;
+    int size;
+} LutSlice;
+
+static void apply_slice(void *arg)
+{
+    LutSlice *s = (LutSlice*)arg;
+
+    if (s->f16_func)
+        s->f16_func(s->lut, s->data + s->offset, (uint16_t*)s->result + s->offset, s->size);
+    else
+        s->f32_func(s->lut, s->data + s->offset, (uint32_t*)s->result + s->offset, s->size);
+}
+
+void f16_lut_apply_parallel(const F16Lut *lut, f16_lut_apply_f16_func f16_func, f16_lut_apply_f32_func f32_func,
+                            uint16_t *data, void *result, int data_size, int threads)
+{
+    Thread workers[LUT_MAX_THREADS];
+    LutSlice slices[LUT_MAX_THREADS];
+    int started[LUT_MAX_THREADS] = {0};
+    int slice_size;
+
+    if (threads < 1)
+        threads = 1;
+    if (threads > LUT_MAX_THREADS)
+        threads = LUT_MAX_THREADS;
+
+    // round the share up before aligning it, or the last data_size % threads elements are lost
+    slice_size = ((data_size + threads - 1) / threads + LUT_SLICE_ALIGN - 1) / LUT_SLICE_ALIGN * LUT_SLICE_ALIGN;
+
+    for (int t = 0; t < threads; t++) {
+        int offset = t * slice_size < data_size ? t * slice_size : data_size;
+        int size = data_size - offset < slice_size ? data_size - offset : slice_size;
+
+        slices[t].lut = lut;
+        slices[t].f16_func = f16_func;
+        slices[t].f32_func = f32_func;
+        slices[t].data = data;
+        slices[t].result = result;
+        slices[t].offset = offset;
+        slices[t].size = size;
+    }
+
+    // if a thread can't be started its slice is done here instead
+    for (int t = 0; t < threads - 1; t++) {
+        started[t] = thread_create(&workers[t], apply_slice, &slices[t]) == 0;
+        if (!started[t])
+            apply_slice(&slices[t]);
+    }
+    apply_slice(&slices[threads - 1]);
+
+    for (int t = 0; t < threads - 1; t++) {
+        if (started[t])
+            thread_join(&workers[t]);
+    }
+}
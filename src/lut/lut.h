@@ -0,0 +1,39 @@
+#ifndef LUT_H
+#define LUT_H
+
+#include <stdint.h>
+#include "../image/image.h"
+
+// a 1D curve applied to halves through a table with an entry for every half.
+// the table is built once from a callback, applying it is one load per value
+// however much work the callback does
+
+typedef float (*f16_lut_func)(float x, void *ctx);
+
+// both tables have one entry past the end, the gathers read 32 bits at a
+// time and the last half entry would otherwise read past the allocation
+#define F16_LUT_SIZE (UINT16_MAX + 1)
+#define F16_LUT_PAD 2
+
+typedef struct F16Lut {
+    uint16_t *half;     // half to half
+    uint32_t *f32;      // half to float bits
+} F16Lut;
+
+// decode and encode are any of the kernels' buffer functions, they set how the
+// callback sees its input and how its output is rounded to half. returns 0 on success
+int f16_lut_build(F16Lut *lut, f16_lut_func func, void *ctx, f16_to_f32_buffer_func decode, f32_to_f16_buffer_func encode);
+void f16_lut_free(F16Lut *lut);
+
+void f16_lut_apply_f16(const F16Lut *lut, uint16_t *data, uint16_t *result, int data_size);
+void f16_lut_apply_f32(const F16Lut *lut, uint16_t *data, uint32_t *result, int data_size);
+
+typedef void (*f16_lut_apply_f16_func)(const F16Lut *lut, uint16_t *data, uint16_t *result, int data_size);
+typedef void (*f16_lut_apply_f32_func)(const F16Lut *lut, uint16_t *data, uint32_t *result, int data_size);
+
+// splits the buffer into one slice per thread, the calling thread does the last one.
+// either func may be NULL, whichever is given is used
+void f16_lut_apply_parallel(const F16Lut *lut, f16_lut_apply_f16_func f16_func, f16_lut_apply_f32_func f32_func,
+                            uint16_t *data, void *result, int data_size, int threads);
+
+#endif // LUT_H
@@ -0,0 +1,196 @@
+#include "lut3d.h"
+#include <stdlib.h>
+#include <string.h>
+
+// pixels per pass, the corners of a whole chunk are decoded with one call
+#define LUT3D_CHUNK 64
+
+int f16_lut3d_build(F16Lut3d *lut, int size, int format, f16_lut3d_func func, void *ctx, f32_to_f16_buffer_func encode)
+{
+    int points = size * size * size;
+    float *f32 = (float*) malloc(sizeof(float) * points * 4);
+    float scale = 1.0f / (float)(size - 1);
+    float *p = f32;
+
+    lut->size = size;
+    lut->format = format;
+    lut->lattice = NULL;
+
+    if (!f32 || size < 2)
+        goto fail;
+
+    for (int b = 0; b < size; b++) {
+        for (int g = 0; g < size; g++) {
+            for (int r = 0; r < size; r++) {
+                float in[3] = {r * scale, g * scale, b * scale};
+                func(in, p, ctx);
+                p[3] = 0.0f;
+                p += 4;
+            }
+        }
+    }
+
+    if (format == F16_LUT3D_F32) {
+        lut->lattice = f32;
+        return 0;
+    }
+
+    lut->lattice = malloc(sizeof(uint16_t) * points * 4);
+    if (!lut->lattice)
+        goto fail;
+
+    encode((uint32_t*)f32, (uint16_t*)lut->lattice, points * 4);
+    free(f32);
+    return 0;
+
+fail:
+    free(f32);
+    return -1;
+}
+
+void f16_lut3d_free(F16Lut3d *lut)
+{
+    free(lut->lattice);
+    lut->lattice = NULL;
+}
+
+size_t f16_lut3d_bytes(const F16Lut3d *lut)
+{
+    size_t points = (size_t)lut->size * lut->size * lut->size;
+    return points * 4 * (lut->format == F16_LUT3D_F16 ? sizeof(uint16_t) : sizeof(float));
+}
+
+// lattice cell and position inside it along one axis
+static inline int cell(float v, int size, float *frac)
+{
+    float x;
+    int i;
+
+    if (!(v > 0.0f))
+        v = 0.0f;
+    if (v > 1.0f)
+        v = 1.0f;
+
+    x = v * (float)(size - 1);
+    i = (int)x;
+    if (i > size - 2)
+        i = size - 2;
+
+    *frac = x - (float)i;
+    return i;
+}
+
+static inline float min_f32(float a, float b) { return a < b ? a : b; }
+static inline float max_f32(float a, float b) { return a > b ? a : b; }
+
+// lattice offsets and weights of the corners one pixel blends, returns the corner count
+static inline int corners(const F16Lut3d *lut, int interp, const float *rgb, int *offset, float *weight)
+{
+    const int size = lut->size;
+    const int dr = 1;
+    const int dg = size;
+    const int db = size * size;
+    float fr, fg, fb;
+    int base;
+
+    base = cell(rgb[0], size, &fr) * dr + cell(rgb[1], size, &fg) * dg + cell(rgb[2], size, &fb) * db;
+
+    if (interp == F16_LUT3D_TRILINEAR) {
+        for (int c = 0; c < 8; c++) {
+            offset[c] = base + (c & 1 ? dr : 0) + (c & 2 ? dg : 0) + (c & 4 ? db : 0);
+            weight[c] = (c & 1 ? fr : 1.0f - fr) * (c & 2 ? fg : 1.0f - fg) * (c & 4 ? fb : 1.0f - fb);
+        }
+        return 8;
+    }
+
+    // the cube splits into 6 tetrahedra along its diagonal. the path from corner
+    // 000 to 111 steps along the axes in order of their fractions, largest first.
+    // ties give the corner picked between them zero weight, so any order of them works.
+    // the order comes from min and max and masks, the same code for all 6 cases
+    float hi = max_f32(fr, fg);
+    float lo = min_f32(fr, fg);
+    float mid = max_f32(lo, min_f32(hi, fb));
+    int r_hi = (fr >= fg) & (fr >= fb);
+    int g_hi = !r_hi & (fg >= fb);
+    int r_lo = (fr < fg) & (fr < fb);
+    int g_lo = !r_lo & (fg < fb);
+    int hi_step = r_hi * dr + g_hi * dg + !(r_hi | g_hi) * db;
+    int lo_step = r_lo * dr + g_lo * dg + !(r_lo | g_lo) * db;
+
+    hi = max_f32(hi, fb);
+    lo = min_f32(lo, fb);
+
+    offset[0] = base;
+    offset[1] = base + hi_step;
+    offset[2] = base + dr + dg + db - lo_step;
+    offset[3] = base + dr + dg + db;
+    weight[0] = 1.0f - hi;
+    weight[1] = hi - mid;
+    weight[2] = mid - lo;
+    weight[3] = lo;
+    return 4;
+}
+
+static inline void blend(const float *point[8], const float *weight, int count, float *out)
+{
+    float r = 0.0f;
+    float g = 0.0f;
+    float b = 0.0f;
+
+    for (int c = 0; c < count; c++) {
+        r += weight[c] * point[c][0];
+        g += weight[c] * point[c][1];
+        b += weight[c] * point[c][2];
+    }
+
+    out[0] = r;
+    out[1] = g;
+    out[2] = b;
+}
+
+void f16_lut3d_apply(const F16Lut3d *lut, int interp, f16_to_f32_buffer_func decode, f32_to_f16_buffer_func encode,
+                     uint16_t *data, uint16_t *result, int pixels)
+{
+    float rgba[LUT3D_CHUNK * 4];
+    int offset[LUT3D_CHUNK][8];
+    float weight[LUT3D_CHUNK][8];
+    // an f16 lattice has each pixel's corners copied out and decoded together
+    uint64_t corner_ph[LUT3D_CHUNK * 8];
+    float corner_ps[LUT3D_CHUNK * 8 * 4];
+    const float *f32 = (const float*)lut->lattice;
+    const uint64_t *f16 = (const uint64_t*)lut->lattice;
+
+    for (int i = 0; i < pixels; i += LUT3D_CHUNK) {
+        int n = pixels - i < LUT3D_CHUNK ? pixels - i : LUT3D_CHUNK;
+        int count = 0;
+
+        decode(data + i * 4, (uint32_t*)rgba, n * 4);
+
+        for (int p = 0; p < n; p++) {
+            count = corners(lut, interp, &rgba[p * 4], offset[p], weight[p]);
+        }
+
+        if (lut->format == F16_LUT3D_F16) {
+            for (int p = 0; p < n; p++) {
+                for (int c = 0; c < count; c++) {
+                    memcpy(&corner_ph[p * count + c], &f16[offset[p][c]], sizeof(uint64_t));
+                }
+            }
+            decode((uint16_t*)corner_ph, (uint32_t*)corner_ps, n * count * 4);
+        }
+
+        for (int p = 0; p < n; p++) {
+            const float *point[8];
+            for (int c = 0; c < count; c++) {
+                if (lut->format == F16_LUT3D_F16)
+                    point[c] = &corner_ps[(p * count + c) * 4];
+                else
+                    point[c] = &f32[offset[p][c] * 4];
+            }
+            // alpha at rgba[p * 4 + 3] is left as it was
+            blend(point, weight[p], count, &rgba[p * 4]);
+        }
+
+        encode((uint32_t*)rgba, result + i * 4, n * 4);
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef LUT3D_H
+#define LUT3D_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../image/image.h"
+
+// a color cube applied to rgba half pixels. each lattice point holds rgb and one
+// pad value so a point is 4 floats or 4 halves, alpha passes through untouched.
+// halves take half the cache of floats but the corners have to be decoded for every pixel
+
+#define F16_LUT3D_F32 0
+#define F16_LUT3D_F16 1
+
+#define F16_LUT3D_TRILINEAR   0 // 8 corners
+#define F16_LUT3D_TETRAHEDRAL 1 // 4 corners
+
+typedef void (*f16_lut3d_func)(const float in[3], float out[3], void *ctx);
+
+typedef struct F16Lut3d {
+    int size;       // points per axis, 33 and 65 are the usual sizes
+    int format;     // F16_LUT3D_F32 or F16_LUT3D_F16
+    void *lattice;  // size^3 points, red changes fastest
+} F16Lut3d;
+
+// samples func on the lattice over [0, 1], encode rounds an f16 lattice. returns 0 on success
+int f16_lut3d_build(F16Lut3d *lut, int size, int format, f16_lut3d_func func, void *ctx, f32_to_f16_buffer_func encode);
+void f16_lut3d_free(F16Lut3d *lut);
+size_t f16_lut3d_bytes(const F16Lut3d *lut);
+
+// inputs are clamped to [0, 1] and nan is treated as 0. decode and encode are any
+// of the kernels' buffer functions, they convert the pixels and an f16 lattice's corners
+void f16_lut3d_apply(const F16Lut3d *lut, int interp, f16_to_f32_buffer_func decode, f32_to_f16_buffer_func encode,
+                     uint16_t *data, uint16_t *result, int pixels);
+
+#endif // LUT3D_H
@@ -0,0 +1,350 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <float.h>
+#include <time.h>
+#include <math.h>
+
+#include "common.h"
+#include "platform_info.h"
+#include "f16_registry.h"
+#include "static_table/static_table.h"
+#include "lut3d/lut3d.h"
+
+// one 1080p rgba frame, it is applied again each run
+#define LUT3D_WIDTH 1920
+#define LUT3D_HEIGHT 1080
+#define LUT3D_PIXELS (LUT3D_WIDTH * LUT3D_HEIGHT)
+#define LUT3D_RUNS 10
+
+// odd so the last chunk is short, the guard halves after it must not change
+#define CHECK_PIXELS 4099
+
+#define HALF_ONE 0x3C00
+
+#define TIME_CALL(name, call, runs)                                         \
+    min_value = INFINITY;                                                   \
+    max_value = -INFINITY;                                                  \
+    average = 0.0;                                                          \
+    for (size_t j = 0; j < runs; j++) {                                     \
+        start = get_timer();                                                \
+        call;                                                               \
+        elapse = (double)((get_timer() - start)) / (double)freq;            \
+        min_value = MIN(min_value, elapse);                                 \
+        max_value = MAX(max_value, elapse);                                 \
+        average += elapse * 1.0 / (double)runs;                             \
+    }                                                                       \
+                                                                            \
+    printf("%-24s : %f %f %f secs %8.1f mpix/s\n", name, min_value, average, max_value, \
+           LUT3D_PIXELS / average / 1e6);                                   \
+    fprintf(f, "%s,%f,%f,%f\n", name, min_value, average, max_value)
+
+static const int lut3d_sizes[] = {33, 65};
+static const int lut3d_formats[] = {F16_LUT3D_F32, F16_LUT3D_F16};
+static const int lut3d_interps[] = {F16_LUT3D_TRILINEAR, F16_LUT3D_TETRAHEDRAL};
+
+static const char *format_name(int format)
+{
+    return format == F16_LUT3D_F16 ? "f16" : "f32";
+}
+
+static const char *interp_name(int interp)
+{
+    return interp == F16_LUT3D_TETRAHEDRAL ? "tetrahedral" : "trilinear";
+}
+
+static void identity(const float in[3], float out[3], void *ctx)
+{
+    (void)ctx;
+    out[0] = in[0];
+    out[1] = in[1];
+    out[2] = in[2];
+}
+
+// both interpolations reproduce a linear function, up to rounding
+static void mix(const float in[3], float out[3], void *ctx)
+{
+    (void)ctx;
+    out[0] = 0.6f * in[0] + 0.3f * in[1] + 0.1f * in[2];
+    out[1] = 0.2f * in[0] + 0.7f * in[1] + 0.1f * in[2];
+    out[2] = 0.1f * in[0] + 0.2f * in[1] + 0.7f * in[2];
+}
+
+// a look with some curvature, saturation then an s curve on each channel
+static void grade(const float in[3], float out[3], void *ctx)
+{
+    (void)ctx;
+    float luma = 0.2126f * in[0] + 0.7152f * in[1] + 0.0722f * in[2];
+
+    for (int c = 0; c < 3; c++) {
+        float v = luma + 1.4f * (in[c] - luma);
+        v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+        out[c] = v * v * (3.0f - 2.0f * v);
+    }
+}
+
+static float half_value(uint16_t h)
+{
+    int_float v;
+    v.u = f16_to_f32_static_table[h];
+    return v.f;
+}
+
+// the cube function run on every pixel instead of the lattice, what the lattice replaces
+static void apply_direct(f16_lut3d_func func, const F16Kernel *decode, const F16Kernel *encode,
+                         uint16_t *data, uint16_t *result, int pixels)
+{
+    float rgba[256 * 4];
+
+    for (int i = 0; i < pixels; i += 256) {
+        int n = pixels - i < 256 ? pixels - i : 256;
+        decode->f16_to_f32_buffer(data + i * 4, (uint32_t*)rgba, n * 4);
+        for (int p = 0; p < n; p++) {
+            float out[3];
+            func(&rgba[p * 4], out, NULL);
+            memcpy(&rgba[p * 4], out, sizeof(out));
+        }
+        encode->f32_to_f16_buffer((uint32_t*)rgba, result + i * 4, n * 4);
+    }
+}
+
+// identity must give back its input within one ulp of a half, the linear mix must be
+// within two half ulps of 1.0 of the function, alpha and the guard must not change
+static uint32_t check_lut3d(const F16Kernel *decode, const F16Kernel *encode)
+{
+    uint16_t *src = (uint16_t*) malloc(sizeof(uint16_t) * CHECK_PIXELS * 4);
+    uint16_t *dst = (uint16_t*) malloc(sizeof(uint16_t) * (CHECK_PIXELS * 4 + GUARD_COUNT));
+    uint32_t failed = 0;
+
+    if (!src || !dst) {
+        printf("malloc error\n");
+        failed = 1;
+        goto done;
+    }
+
+    // every half in [0, 1] on each channel plus a few out of range ones, alpha anything
+    for (int i = 0; i < CHECK_PIXELS * 4; i++) {
+        src[i] = (uint16_t)((i * 7919u) % (HALF_ONE + 1));
+    }
+    src[0] = 0xFC00; // -inf
+    src[1] = 0x7E00; // nan
+    src[2] = 0x7C00; // +inf
+    src[5] = 0xBC00; // -1
+    src[6] = 0x4000; // 2
+
+    for (size_t s = 0; s < ARRAY_SIZE(lut3d_sizes); s++) {
+        for (size_t k = 0; k < ARRAY_SIZE(lut3d_formats); k++) {
+            for (size_t m = 0; m < ARRAY_SIZE(lut3d_interps); m++) {
+                const int interp = lut3d_interps[m];
+                F16Lut3d id, lin;
+                uint32_t identity_errors = 0;
+                uint32_t other_errors = 0;
+                float max_error = 0.0f;
+
+                if (f16_lut3d_build(&id, lut3d_sizes[s], lut3d_formats[k], identity, NULL, encode->f32_to_f16_buffer) ||
+                    f16_lut3d_build(&lin, lut3d_sizes[s], lut3d_formats[k], mix, NULL, encode->f32_to_f16_buffer)) {
+                    printf("unable to build lut\n");
+                    failed++;
+                    continue;
+                }
+
+                guard_fill(dst + CHECK_PIXELS * 4, sizeof(uint16_t), GUARD_COUNT);
+
+                f16_lut3d_apply(&id, interp, decode->f16_to_f32_buffer, encode->f32_to_f16_buffer, src, dst, CHECK_PIXELS);
+                for (int p = 0; p < CHECK_PIXELS; p++) {
+                    for (int c = 0; c < 3; c++) {
+                        float in = half_value(src[p * 4 + c]);
+                        float v = !(in > 0.0f) ? 0.0f : (in > 1.0f ? 1.0f : in);
+                        float out = half_value(dst[p * 4 + c]);
+                        identity_errors += fabsf(out - v) > v / 1024.0f && fabsf(out - v) > 1.0f / 16777216.0f;
+                    }
+                    other_errors += dst[p * 4 + 3] != src[p * 4 + 3];
+                }
+
+                f16_lut3d_apply(&lin, interp, decode->f16_to_f32_buffer, encode->f32_to_f16_buffer, src, dst, CHECK_PIXELS);
+                for (int p = 0; p < CHECK_PIXELS; p++) {
+                    float in[3], want[3];
+                    for (int c = 0; c < 3; c++) {
+                        float v = half_value(src[p * 4 + c]);
+                        in[c] = !(v > 0.0f) ? 0.0f : (v > 1.0f ? 1.0f : v);
+                    }
+                    mix(in, want, NULL);
+                    for (int c = 0; c < 3; c++) {
+                        float e = fabsf(half_value(dst[p * 4 + c]) - want[c]);
+                        max_error = e > max_error ? e : max_error;
+                    }
+                    other_errors += dst[p * 4 + 3] != src[p * 4 + 3];
+                }
+
+                other_errors += guard_check(dst + CHECK_PIXELS * 4, sizeof(uint16_t), GUARD_COUNT);
+
+                if (max_error > 2.0f / 2048.0f)
+                    other_errors++;
+
+                printf("%2d %s %-12s: identity %u mismatches, linear max error %.6f, %u other errors\n",
+                       lut3d_sizes[s], format_name(lut3d_formats[k]), interp_name(interp),
+                       identity_errors, max_error, other_errors);
+                failed += identity_errors + other_errors;
+
+                f16_lut3d_free(&id);
+                f16_lut3d_free(&lin);
+            }
+        }
+    }
+
+done:
+    free(src);
+    free(dst);
+    return failed;
+}
+
+// largest difference of each lattice from the graded function in float, what the
+// lattice spacing and the storage format cost before anything is encoded
+static void print_accuracy(FILE *f, const F16Kernel *decode, const F16Kernel *encode, uint16_t *data)
+{
+    const int pixels = 1 << 16;
+    uint16_t *got = (uint16_t*) malloc(sizeof(uint16_t) * pixels * 4);
+
+    if (!got)
+        return;
+
+    printf("\n%-24s : %10s %10s\n", "lattice", "max error", "kbytes");
+    fprintf(f, "\naccuracy,graded\n%s,%s,%s\n", "name", "max error", "kbytes");
+    for (size_t s = 0; s < ARRAY_SIZE(lut3d_sizes); s++) {
+        for (size_t k = 0; k < ARRAY_SIZE(lut3d_formats); k++) {
+            for (size_t m = 0; m < ARRAY_SIZE(lut3d_interps); m++) {
+                F16Lut3d lut;
+                char name[64];
+                float max_error = 0.0f;
+
+                if (f16_lut3d_build(&lut, lut3d_sizes[s], lut3d_formats[k], grade, NULL, encode->f32_to_f16_buffer))
+                    continue;
+
+                f16_lut3d_apply(&lut, lut3d_interps[m], decode->f16_to_f32_buffer, encode->f32_to_f16_buffer, data, got, pixels);
+                for (int p = 0; p < pixels; p++) {
+                    float in[3], want[3];
+                    for (int c = 0; c < 3; c++) {
+                        in[c] = half_value(data[p * 4 + c]);
+                    }
+                    grade(in, want, NULL);
+                    for (int c = 0; c < 3; c++) {
+                        float e = fabsf(half_value(got[p * 4 + c]) - want[c]);
+                        max_error = e > max_error ? e : max_error;
+                    }
+                }
+
+                snprintf(name, sizeof(name), "%d %s %s", lut3d_sizes[s], format_name(lut3d_formats[k]), interp_name(lut3d_interps[m]));
+                printf("%-24s : %10.6f %10zu\n", name, max_error, f16_lut3d_bytes(&lut) / 1024);
+                fprintf(f, "%s,%f,%zu\n", name, max_error, f16_lut3d_bytes(&lut) / 1024);
+                f16_lut3d_free(&lut);
+            }
+        }
+    }
+
+    free(got);
+}
+
+static void time_lut3d(FILE *f, const F16Kernel *decode, const F16Kernel *encode, uint16_t *data, uint16_t *result, const char *desc)
+{
+    uint64_t freq = get_timer_frequency();
+    uint64_t start;
+    double elapse;
+    double average;
+    double min_value;
+    double max_value;
+
+    printf("\r\nruns: %d, pixels: %d, rgba f16 in [0, 1], %s\n\n", LUT3D_RUNS, LUT3D_PIXELS, desc);
+    printf("%-24s :      min      avg     max\n", "name");
+    fprintf(f, "\nperf_test,runs: %d pixels: %d %s\n%s,%s,%s,%s\n", LUT3D_RUNS, LUT3D_PIXELS, desc, "name", "min", "avg", "max");
+
+    TIME_CALL("direct", apply_direct(grade, decode, encode, data, result, LUT3D_PIXELS), LUT3D_RUNS);
+
+    for (size_t s = 0; s < ARRAY_SIZE(lut3d_sizes); s++) {
+        for (size_t k = 0; k < ARRAY_SIZE(lut3d_formats); k++) {
+            F16Lut3d lut;
+
+            if (f16_lut3d_build(&lut, lut3d_sizes[s], lut3d_formats[k], grade, NULL, encode->f32_to_f16_buffer)) {
+                printf("unable to build lut\n");
+                continue;
+            }
+
+            for (size_t m = 0; m < ARRAY_SIZE(lut3d_interps); m++) {
+                char name[64];
+                snprintf(name, sizeof(name), "%d %s %s", lut3d_sizes[s], format_name(lut3d_formats[k]), interp_name(lut3d_interps[m]));
+                TIME_CALL(name, f16_lut3d_apply(&lut, lut3d_interps[m], decode->f16_to_f32_buffer, encode->f32_to_f16_buffer,
+                                                data, result, LUT3D_PIXELS), LUT3D_RUNS);
+            }
+            f16_lut3d_free(&lut);
+        }
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int cpu_flags = f16_cpu_flags();
+    const char *csv_path = argc > 1 ? argv[1] : "lut3d_perf_result.csv";
+    uint32_t failed;
+    FILE *f;
+
+    f = fopen(csv_path, "wb");
+    if (!f) {
+        printf("unable to open csv file: %s'\n", csv_path);
+        return -1;
+    }
+
+    printf("CPU: %s %s\n", CPU_ARCH, get_cpu_model_name());
+    fprintf(f, "%s,%s\n", CPU_ARCH, get_cpu_model_name());
+    printf("%s %s\n", get_platform_name(), COMPILER_NAME);
+    fprintf(f, "%s,%s\n", get_platform_name(), COMPILER_NAME);
+    printf("csv file: %s\n", csv_path);
+
+    // pixels and f16 lattices go through the fastest exact kernels there are
+    const F16Kernel *decode = f16_kernel_find(F16_F16_TO_F32, "hardware", cpu_flags);
+    if (!decode)
+        decode = f16_kernel_find(F16_F16_TO_F32, "static_table", cpu_flags);
+    const F16Kernel *encode = f16_kernel_find(F16_F32_TO_F16, "hardware", cpu_flags);
+    if (!encode)
+        encode = f16_kernel_find(F16_F32_TO_F16, "no table", cpu_flags);
+    printf("decode: %s, encode: %s\n", decode->name, encode->name);
+
+    printf("\nchecking 3d luts\n");
+    failed = check_lut3d(decode, encode);
+
+    uint16_t *data = (uint16_t*) malloc(sizeof(uint16_t) * LUT3D_PIXELS * 4);
+    uint16_t *result = (uint16_t*) alloc_perf_buffer(sizeof(uint16_t) * LUT3D_PIXELS * 4);
+    if (!data || !result) {
+        printf("malloc error\n");
+        return -1;
+    }
+
+    // random pixels touch the whole lattice, the worst case for its cache footprint
+    srand(time(NULL));
+    for (int i = 0; i < LUT3D_PIXELS * 4; i++) {
+        data[i] = (uint16_t)(rand() % (HALF_ONE + 1));
+    }
+    print_accuracy(f, decode, encode, data);
+    time_lut3d(f, decode, encode, data, result, "random pixels");
+
+    // neighbouring pixels of a real image fall in the same few lattice cells
+    for (int y = 0; y < LUT3D_HEIGHT; y++) {
+        for (int x = 0; x < LUT3D_WIDTH; x++) {
+            uint16_t *p = &data[(y * LUT3D_WIDTH + x) * 4];
+            p[0] = (uint16_t)(x * HALF_ONE / LUT3D_WIDTH);
+            p[1] = (uint16_t)(y * HALF_ONE / LUT3D_HEIGHT);
+            p[2] = (uint16_t)((x + y) * HALF_ONE / (LUT3D_WIDTH + LUT3D_HEIGHT));
+            p[3] = HALF_ONE;
+        }
+    }
+    time_lut3d(f, decode, encode, data, result, "gradient");
+
+    free(data);
+    free(result);
+    fclose(f);
+
+    if (failed)
+        printf("\n%u 3d lut check failures\n", failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+#include "lut_avx2.h"
+#include <immintrin.h>
+
+// the half table is gathered 32 bits at a time from index * 2, the high
+// half of each lane belongs to the next entry and is masked off
+
+static inline __m128i lut8_f16(const uint16_t *table, const uint16_t *data)
+{
+    __m256i index = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)data));
+    __m256i v = _mm256_i32gather_epi32((const int*)table, index, 2);
+    v = _mm256_and_si256(v, _mm256_set1_epi32(0xFFFF));
+    // packus works within 128 bit lanes, put the two 64 bit halves back together
+    v = _mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm256_castsi256_si128(v);
+}
+
+static inline __m256i lut8_f32(const uint32_t *table, const uint16_t *data)
+{
+    __m256i index = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)data));
+    return _mm256_i32gather_epi32((const int*)table, index, 4);
+}
+
+void f16_lut_apply_f16_avx2(const F16Lut *lut, uint16_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        _mm_storeu_si128((__m128i*)result, lut8_f16(lut->half, data));
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder) {
+        uint16_t in_buf[8] = {0};
+        uint16_t out_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        _mm_storeu_si128((__m128i*)&out_buf[0], lut8_f16(lut->half, in_buf));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+void f16_lut_apply_f32_avx2(const F16Lut *lut, uint16_t *data, uint32_t *result, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        _mm256_storeu_si256((__m256i*)result, lut8_f32(lut->f32, data));
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder) {
+        uint16_t in_buf[8] = {0};
+        uint32_t out_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        _mm256_storeu_si256((__m256i*)&out_buf[0], lut8_f32(lut->f32, in_buf));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#include "lut_avx512.h"
+#include <immintrin.h>
+
+// the half table is gathered 32 bits at a time from index * 2, vpmovdw
+// keeps the low half of each lane which is the entry itself
+
+static inline __m256i lut16_f16(const uint16_t *table, const uint16_t *data)
+{
+    __m512i index = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)data));
+    return _mm512_cvtepi32_epi16(_mm512_i32gather_epi32(index, (const int*)table, 2));
+}
+
+static inline __m512i lut16_f32(const uint32_t *table, const uint16_t *data)
+{
+    __m512i index = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)data));
+    return _mm512_i32gather_epi32(index, (const int*)table, 4);
+}
+
+void f16_lut_apply_f16_avx512(const F16Lut *lut, uint16_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 16 * 16;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=16) {
+        _mm256_storeu_si256((__m256i*)result, lut16_f16(lut->half, data));
+
+        data += 16;
+        result += 16;
+    }
+
+    if (remainder) {
+        uint16_t in_buf[16] = {0};
+        uint16_t out_buf[16] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        _mm256_storeu_si256((__m256i*)&out_buf[0], lut16_f16(lut->half, in_buf));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+void f16_lut_apply_f32_avx512(const F16Lut *lut, uint16_t *data, uint32_t *result, int data_size)
+{
+    int size = data_size / 16 * 16;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=16) {
+        _mm512_storeu_si512((void*)result, lut16_f32(lut->f32, data));
+
+        data += 16;
+        result += 16;
+    }
+
+    if (remainder) {
+        uint16_t in_buf[16] = {0};
+        uint32_t out_buf[16] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        _mm512_storeu_si512((void*)&out_buf[0], lut16_f32(lut->f32, in_buf));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
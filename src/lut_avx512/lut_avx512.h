@@ -0,0 +1,6 @@
+#include <stdint.h>
+#include "../lut/lut.h"
+
+// f16_lut_apply_* with 16 lane gathers
+void f16_lut_apply_f16_avx512(const F16Lut *lut, uint16_t *data, uint16_t *result, int data_size);
+void f16_lut_apply_f32_avx512(const F16Lut *lut, uint16_t *data, uint32_t *result, int data_size);
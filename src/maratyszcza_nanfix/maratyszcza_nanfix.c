@@ -1,4 +1,5 @@
 #include "maratyszcza_nanfix.h"
+#include "../target_clones.h"
 
 // https://www.corsix.org/content/converting-fp32-to-fp16
 // https://github.com/Maratyszcza/FP16/blob/0a92994d729ff76a58f692d3028ca1b64b145d91/include/fp16/fp16.h#L223-L247
@@ -49,7 +50,7 @@ uint16_t f32_to_f16_maratyszcza_nanfix(float f)
     return fp16_ieee_from_fp32_value(value.i);
 }
 
-void f32_to_f16_buffer_maratyszcza_nanfix(uint32_t *data, uint16_t *result, int data_size)
+TARGET_CLONES void f32_to_f16_buffer_maratyszcza_nanfix(uint32_t *data, uint16_t *result, int data_size)
 {
     int_float value;
     for (int i =0; i < data_size; i++) {
@@ -0,0 +1,133 @@
+#ifndef MARATYSZCZA_CVTPS_PH_SSE2_H
+#define MARATYSZCZA_CVTPS_PH_SSE2_H
+
+// float to half with sse2 only, shared by the kernels that encode in registers
+// https://www.corsix.org/content/converting-fp32-to-fp16
+// https://github.com/Maratyszcza/FP16/blob/0a92994d729ff76a58f692d3028ca1b64b145d91/include/fp16/fp16.h#L223-L247
+
+#include <immintrin.h>
+
+static inline __m128i blendv_sse2(__m128i a, __m128i b, __m128i mask)
+{
+    return _mm_xor_si128(_mm_and_si128(_mm_xor_si128(a, b), mask), a);
+}
+
+
+// per lane mask of values whose magnitude rounds up
+static inline __m128i away_mask_sse2(__m128 a, int imm8)
+{
+    __m128i sign = _mm_srai_epi32(_mm_castps_si128(a), 31);
+    if (imm8 == _MM_FROUND_TO_POS_INF)
+        return _mm_xor_si128(sign, _mm_set1_epi32(-1));
+    if (imm8 == _MM_FROUND_TO_NEG_INF)
+        return sign;
+    return _mm_setzero_si128();
+}
+
+// truncate, or round the magnitude up on away lanes
+static inline __m128i cvtps_ph_sse2_directed(__m128 a, int imm8)
+{
+    __m128i x = _mm_castps_si128(a);
+    __m128i away = away_mask_sse2(a, imm8);
+
+    __m128i x_sign_mask = _mm_set1_epi32(0x80000000u);
+    __m128i x_sgn = _mm_and_si128(x, x_sign_mask);
+
+    __m128i x_exp_mask = _mm_set1_epi32(0x7f800000u);
+    __m128i x_exp = _mm_and_si128(x, x_exp_mask);
+
+    __m128 magic1 = _mm_castsi128_ps(_mm_set1_epi32(0x77800000u)); // 0x1.0p+112f
+    __m128 magic2 = _mm_castsi128_ps(_mm_set1_epi32(0x08800000u)); // 0x1.0p-110f
+
+    __m128i exp_max = _mm_set1_epi32(0x38800000u);
+    x_exp = _mm_castps_si128(_mm_max_ps(_mm_castsi128_ps(x_exp), _mm_castsi128_ps(exp_max))); // max(e, -14)
+    x_exp = _mm_add_epi32(x_exp, _mm_set1_epi32(15u << 23)); // e += 15
+    x = _mm_andnot_si128(x_sgn, x); // Discard sign
+
+    __m128 f = _mm_castsi128_ps(x);
+    __m128 magicf = _mm_castsi128_ps(x_exp);
+
+    f = _mm_mul_ps(_mm_mul_ps(f, magic1), magic2);
+
+    // the add rounds to nearest even, subtract magicf back out to see which way it went
+    __m128 sum = _mm_add_ps(f, magicf);
+    __m128 back = _mm_sub_ps(sum, magicf);
+    __m128i rounded_up = _mm_castps_si128(_mm_cmpgt_ps(back, f));
+    __m128i rounded_down = _mm_castps_si128(_mm_cmplt_ps(back, f));
+
+    __m128i u = _mm_castps_si128(sum);
+
+    __m128i h_exp = _mm_and_si128(_mm_srli_epi32(u, 13), _mm_set1_epi32(0x7c00u));
+    __m128i h_sig = _mm_and_si128(u, _mm_set1_epi32(0x0fffu));
+
+    __m128i nan_mask = _mm_cmpgt_epi32(x, x_exp_mask);
+    __m128i nan = _mm_and_si128(_mm_or_si128(_mm_srli_epi32(x, 13), _mm_set1_epi32(0x0200u)), _mm_set1_epi32(0x03FFu));
+    h_sig = blendv_sse2(h_sig, nan, nan_mask);
+
+    // f16 bits are ordered like the values, step one ulp toward or away from zero
+    __m128i h = _mm_add_epi32(h_exp, h_sig);
+    h = _mm_add_epi32(h, _mm_andnot_si128(away, rounded_up));
+    h = _mm_sub_epi32(h, _mm_and_si128(away, rounded_down));
+
+    // finite values past 2^16 scale to inf, truncate them to HALF_MAX
+    __m128i overflow = _mm_andnot_si128(_mm_cmpgt_epi32(x, _mm_set1_epi32(0x7f800000u - 1)),
+                                        _mm_cmpgt_epi32(x, _mm_set1_epi32(0x47800000u - 1)));
+    h = _mm_add_epi32(h, _mm_andnot_si128(away, overflow));
+
+    __m128i ph = _mm_add_epi32(_mm_srli_epi32(x_sgn, 16), h);
+
+    // pack u16 values into lower 8 bytes
+    ph = _mm_shufflehi_epi16(ph, (1 << 6 | 1 << 4 | 2 << 2 | 0 << 0));
+    ph = _mm_shufflelo_epi16(ph, (1 << 6 | 1 << 4 | 2 << 2 | 0 << 0));
+    return _mm_shuffle_epi32(ph, (1 << 6 | 1 << 4 | 2 << 2 | 0 << 0));
+}
+
+// drop in replacement for hardware instruction
+static inline __m128i cvtps_ph_sse2(__m128 a, int imm8)
+{
+    if (imm8 != _MM_FROUND_TO_NEAREST_INT)
+        return cvtps_ph_sse2_directed(a, imm8);
+
+    __m128i x = _mm_castps_si128(a);
+
+    __m128i x_sign_mask = _mm_set1_epi32(0x80000000u);
+    __m128i x_sgn = _mm_and_si128(x, x_sign_mask);
+
+    __m128i x_exp_mask = _mm_set1_epi32(0x7f800000u);
+    __m128i x_exp = _mm_and_si128(x, x_exp_mask);
+
+    __m128 magic1 = _mm_castsi128_ps(_mm_set1_epi32(0x77800000u)); // 0x1.0p+112f
+    __m128 magic2 = _mm_castsi128_ps(_mm_set1_epi32(0x08800000u)); // 0x1.0p-110f
+
+    // sse2 doesn't have _mm_max_epu32, but _mm_max_ps works
+    __m128i exp_max = _mm_set1_epi32(0x38800000u);
+    x_exp = _mm_castps_si128(_mm_max_ps(_mm_castsi128_ps(x_exp), _mm_castsi128_ps(exp_max))); // max(e, -14)
+    x_exp = _mm_add_epi32(x_exp, _mm_set1_epi32(15u << 23)); // e += 15
+    x = _mm_andnot_si128(x_sgn, x); // Discard sign
+
+    __m128 f = _mm_castsi128_ps(x);
+    __m128 magicf = _mm_castsi128_ps(x_exp);
+
+    // If 15 < e then inf, otherwise e += 2
+    f = _mm_mul_ps(_mm_mul_ps(f, magic1), magic2);
+    f = _mm_add_ps(f, magicf);
+
+    __m128i u = _mm_castps_si128(f);
+
+    __m128i h_exp = _mm_and_si128(_mm_srli_epi32(u, 13), _mm_set1_epi32(0x7c00u));
+    __m128i h_sig = _mm_and_si128(u, _mm_set1_epi32(0x0fffu));
+
+    // blend in nan values
+    __m128i nan_mask = _mm_cmpgt_epi32(x, x_exp_mask);
+    __m128i nan = _mm_and_si128(_mm_or_si128(_mm_srli_epi32(x, 13), _mm_set1_epi32(0x0200u)), _mm_set1_epi32(0x03FFu));
+    h_sig = blendv_sse2(h_sig, nan, nan_mask);
+
+    __m128i ph = _mm_add_epi32(_mm_srli_epi32(x_sgn, 16),_mm_add_epi32(h_exp, h_sig));
+
+    // pack u16 values into lower 8 bytes
+    ph = _mm_shufflehi_epi16(ph, (1 << 6 | 1 << 4 | 2 << 2 | 0 << 0));
+    ph = _mm_shufflelo_epi16(ph, (1 << 6 | 1 << 4 | 2 << 2 | 0 << 0));
+    return _mm_shuffle_epi32(ph, (1 << 6 | 1 << 4 | 2 << 2 | 0 << 0));
+}
+
+#endif // MARATYSZCZA_CVTPS_PH_SSE2_H
@@ -1,9 +1,9 @@
 #include "maratyszcza_sse2.h"
 #include <stdint.h>
+#include <string.h>
+#include "../image/image.h"
 #include <immintrin.h>
-
-// https://www.corsix.org/content/converting-fp32-to-fp16
-// https://github.com/Maratyszcza/FP16/blob/0a92994d729ff76a58f692d3028ca1b64b145d91/include/fp16/fp16.h#L223-L247
+#include "cvtps_ph_sse2.h"
 
 #define DEBUG_VERIFY 0
 
@@ -23,57 +23,6 @@ static inline uint16_t to_f16_hw(float v)
 }
 #endif
 
-static inline __m128i blendv_sse2(__m128i a, __m128i b, __m128i mask)
-{
-    return _mm_xor_si128(_mm_and_si128(_mm_xor_si128(a, b), mask), a);
-}
-
-// drop in replacement for hardware instruction
-static inline __m128i cvtps_ph_sse2(__m128 a, int imm8 /*unused always _MM_FROUND_TO_NEAREST_INT*/)
-{
-    __m128i x = _mm_castps_si128(a);
-
-    __m128i x_sign_mask = _mm_set1_epi32(0x80000000u);
-    __m128i x_sgn = _mm_and_si128(x, x_sign_mask);
-
-    __m128i x_exp_mask = _mm_set1_epi32(0x7f800000u);
-    __m128i x_exp = _mm_and_si128(x, x_exp_mask);
-
-    __m128 magic1 = _mm_castsi128_ps(_mm_set1_epi32(0x77800000u)); // 0x1.0p+112f
-    __m128 magic2 = _mm_castsi128_ps(_mm_set1_epi32(0x08800000u)); // 0x1.0p-110f
-
-    // sse2 doesn't have _mm_max_epu32, but _mm_max_ps works
-    __m128i exp_max = _mm_set1_epi32(0x38800000u);
-    x_exp = _mm_castps_si128(_mm_max_ps(_mm_castsi128_ps(x_exp), _mm_castsi128_ps(exp_max))); // max(e, -14)
-    x_exp = _mm_add_epi32(x_exp, _mm_set1_epi32(15u << 23)); // e += 15
-    x = _mm_andnot_si128(x_sgn, x); // Discard sign
-
-    __m128 f = _mm_castsi128_ps(x);
-    __m128 magicf = _mm_castsi128_ps(x_exp);
-
-    // If 15 < e then inf, otherwise e += 2
-    f = _mm_mul_ps(_mm_mul_ps(f, magic1), magic2);
-    f = _mm_add_ps(f, magicf);
-
-    __m128i u = _mm_castps_si128(f);
-
-    __m128i h_exp = _mm_and_si128(_mm_srli_epi32(u, 13), _mm_set1_epi32(0x7c00u));
-    __m128i h_sig = _mm_and_si128(u, _mm_set1_epi32(0x0fffu));
-
-    // blend in nan values
-    __m128i nan_mask = _mm_cmpgt_epi32(x, x_exp_mask);
-    __m128i nan = _mm_and_si128(_mm_or_si128(_mm_srli_epi32(x, 13), _mm_set1_epi32(0x0200u)), _mm_set1_epi32(0x03FFu));
-    h_sig = blendv_sse2(h_sig, nan, nan_mask);
-
-    __m128i ph = _mm_add_epi32(_mm_srli_epi32(x_sgn, 16),_mm_add_epi32(h_exp, h_sig));
-
-    // pack u16 values into lower 8 bytes
-    ph = _mm_shufflehi_epi16(ph, (1 << 6 | 1 << 4 | 2 << 2 | 0 << 0));
-    ph = _mm_shufflelo_epi16(ph, (1 << 6 | 1 << 4 | 2 << 2 | 0 << 0));
-    return _mm_shuffle_epi32(ph, (1 << 6 | 1 << 4 | 2 << 2 | 0 << 0));
-}
-
-
 static inline uint16_t to_f16(float v)
 {
     uint16_t result[8] = {0};
@@ -149,3 +98,310 @@ void f32_to_f16_buffer_maratyszcza_sse2(uint32_t *data, uint16_t *result, int da
 #endif
 
 }
+
+static inline void cvt_buffer_mode(uint32_t *data, uint16_t *result, int data_size, const int imm8)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = _mm_loadu_ps((float*)data);
+        __m128i ph = cvtps_ph_sse2(ps, imm8);
+        _mm_storel_epi64((__m128i*)result, ph);
+
+        data += 4;
+        result += 4;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        __m128 ps = _mm_loadu_ps((float*)&in_buf[0]);
+        __m128i ph = cvtps_ph_sse2(ps, imm8);
+        _mm_storel_epi64((__m128i*)&out_buf[0], ph);
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+uint16_t f32_to_f16_maratyszcza_sse2_mode(float f, int mode)
+{
+    uint16_t result[8] = {0};
+    __m128 ps =_mm_set1_ps(f);
+    __m128i ph;
+
+    switch (mode) {
+        case F16_ROUND_TO_NEG_INF: ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_NEG_INF);     break;
+        case F16_ROUND_TO_POS_INF: ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_POS_INF);     break;
+        case F16_ROUND_TO_ZERO:    ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_ZERO);        break;
+        default:                   ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_NEAREST_INT); break;
+    }
+
+    _mm_storeu_si128((__m128i*)result, ph);
+
+    return result[0];
+}
+
+void f32_to_f16_buffer_maratyszcza_sse2_mode(uint32_t *data, uint16_t *result, int data_size, int mode)
+{
+    // pass the mode as a constant so each loop only has its own rounding code
+    switch (mode) {
+        case F16_ROUND_TO_NEG_INF: cvt_buffer_mode(data, result, data_size, _MM_FROUND_TO_NEG_INF); break;
+        case F16_ROUND_TO_POS_INF: cvt_buffer_mode(data, result, data_size, _MM_FROUND_TO_POS_INF); break;
+        case F16_ROUND_TO_ZERO:    cvt_buffer_mode(data, result, data_size, _MM_FROUND_TO_ZERO);    break;
+        default: f32_to_f16_buffer_maratyszcza_sse2(data, result, data_size); break;
+    }
+}
+
+static inline __m128i cvt8_special(const uint32_t *data, int flags)
+{
+    __m128i lo = cvtps_ph_sse2(_mm_loadu_ps((const float*)data), _MM_FROUND_TO_NEAREST_INT);
+    __m128i hi = cvtps_ph_sse2(_mm_loadu_ps((const float*)data + 4), _MM_FROUND_TO_NEAREST_INT);
+    return f16_fix_special_sse2(_mm_unpacklo_epi64(lo, hi), flags);
+}
+
+void f32_to_f16_buffer_maratyszcza_sse2_special(uint32_t *data, uint16_t *result, int data_size, int flags)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        _mm_storeu_si128((__m128i*)result, cvt8_special(data, flags));
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[8] = {0};
+        uint16_t out_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        _mm_storeu_si128((__m128i*)&out_buf[0], cvt8_special(in_buf, flags));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+void f32_to_f16_buffer_maratyszcza_sse2_stats(uint32_t *data, uint16_t *result, int data_size, F16ConvertStats *stats)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    F16StatsSSE2 acc;
+
+    f16_stats_init(stats);
+    f16_stats_sse2_init(&acc);
+
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = _mm_loadu_ps((float*)data);
+        __m128i ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)result, ph);
+        f16_stats_sse2_add(&acc, ps);
+
+        data += 4;
+        result += 4;
+    }
+
+    f16_stats_sse2_finish(&acc, stats);
+
+    // zero padding the tail would count as a finite value, so it goes one at a time
+    f32_to_f16_buffer_maratyszcza_sse2(data, result, remainder);
+    for (int i = 0; i < remainder; i++) {
+        f16_stats_add(stats, data[i]);
+    }
+}
+
+// the 4 halves land on bytes of floats that were already loaded
+void f32_to_f16_buffer_maratyszcza_sse2_inplace(uint32_t *data, int data_size)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    uint16_t *result = (uint16_t*)data;
+
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = _mm_loadu_ps((float*)data + i);
+        __m128i ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)(result + i), ph);
+    }
+
+    // memcpy, the same bytes are read as floats and written as halves
+    if (remainder) {
+        uint32_t in_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        memcpy(in_buf, data + size, remainder * sizeof(uint32_t));
+
+        __m128 ps = _mm_loadu_ps((float*)&in_buf[0]);
+        __m128i ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)&out_buf[0], ph);
+
+        memcpy(result + size, out_buf, remainder * sizeof(uint16_t));
+    }
+}
+
+static inline void rgba_to_planar4(const uint32_t *src, uint16_t *planes[4], int x)
+{
+    __m128 r = _mm_loadu_ps((const float*)src);
+    __m128 g = _mm_loadu_ps((const float*)src + 4);
+    __m128 b = _mm_loadu_ps((const float*)src + 8);
+    __m128 a = _mm_loadu_ps((const float*)src + 12);
+    _MM_TRANSPOSE4_PS(r, g, b, a);
+    _mm_storel_epi64((__m128i*)(planes[0] + x), cvtps_ph_sse2(r, _MM_FROUND_TO_NEAREST_INT));
+    _mm_storel_epi64((__m128i*)(planes[1] + x), cvtps_ph_sse2(g, _MM_FROUND_TO_NEAREST_INT));
+    _mm_storel_epi64((__m128i*)(planes[2] + x), cvtps_ph_sse2(b, _MM_FROUND_TO_NEAREST_INT));
+    _mm_storel_epi64((__m128i*)(planes[3] + x), cvtps_ph_sse2(a, _MM_FROUND_TO_NEAREST_INT));
+}
+
+// 4 pixels per step, the last few pixels of a row go through the same step on the stack
+void f32_rgba_to_f16_planar_maratyszcza_sse2(uint32_t *data, int data_stride, uint16_t *planes[4], int plane_stride, int width, int height)
+{
+    int size = width / 4 * 4;
+    int remainder = width - size;
+
+    for (int y = 0; y < height; y++) {
+        uint32_t *src = IMAGE_ROW(uint32_t, data, data_stride, y);
+        uint16_t *row[4];
+        for (int c = 0; c < 4; c++) {
+            row[c] = IMAGE_ROW(uint16_t, planes[c], plane_stride, y);
+        }
+
+        for (int x = 0; x < size; x+=4) {
+            rgba_to_planar4(src + x * 4, row, x);
+        }
+
+        if (remainder) {
+            uint32_t in_buf[16] = {0};
+            uint16_t out_buf[4][4];
+            uint16_t *out[4] = {out_buf[0], out_buf[1], out_buf[2], out_buf[3]};
+            for (int i = 0; i < remainder * 4; i++) {
+                in_buf[i] = src[size * 4 + i];
+            }
+
+            rgba_to_planar4(in_buf, out, 0);
+
+            for (int c = 0; c < 4; c++) {
+                for (int i = 0; i < remainder; i++) {
+                    row[c][size + i] = out_buf[c][i];
+                }
+            }
+        }
+    }
+}
+
+#define CHANNELS_SHUFFLE_CASE(mask, a, b, c, d) \
+    case mask: return _mm_shufflehi_epi16(_mm_shufflelo_epi16(ph, _MM_SHUFFLE(d, c, b, a)), _MM_SHUFFLE(d, c, b, a));
+
+// the shuffles take immediates, each mask gets its own constant
+static inline __m128i shuffle_channels(__m128i ph, const int mask)
+{
+    switch (mask) {
+        F16_CHANNEL_SHUFFLES(CHANNELS_SHUFFLE_CASE)
+    }
+    return ph;
+}
+
+// 2 pixels, each is stored as 4 halves but the next one starts count halves later
+static inline void cvt2_channels(const uint32_t *data, uint16_t *result, const int mask, const int count)
+{
+    __m128i lo = cvtps_ph_sse2(_mm_loadu_ps((const float*)data), _MM_FROUND_TO_NEAREST_INT);
+    __m128i hi = cvtps_ph_sse2(_mm_loadu_ps((const float*)data + 4), _MM_FROUND_TO_NEAREST_INT);
+    __m128i ph = shuffle_channels(_mm_unpacklo_epi64(lo, hi), mask);
+    _mm_storel_epi64((__m128i*)result, ph);
+    _mm_storel_epi64((__m128i*)(result + count), _mm_unpackhi_epi64(ph, ph));
+}
+
+static inline void cvt_channels(uint32_t *data, uint16_t *result, int pixels, const int mask)
+{
+    const int count = f16_channel_count(mask);
+    // the extra halves of the last store still have to land inside result
+    int direct = pixels - (4 + count - 1) / count + 1;
+    int size = direct > 0 ? direct / 2 * 2 : 0;
+    int remainder = pixels - size;
+
+    for (int i = 0; i < size; i+=2) {
+        cvt2_channels(data, result, mask, count);
+
+        data += 8;
+        result += count * 2;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[16] = {0};
+        uint16_t out_buf[16] = {0};
+        for (int i = 0; i < remainder * 4; i++) {
+            in_buf[i] = data[i];
+        }
+
+        for (int i = 0; i < remainder; i+=2) {
+            cvt2_channels(&in_buf[i * 4], &out_buf[i * count], mask, count);
+        }
+
+        for (int i = 0; i < remainder * count; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+#define CHANNELS_CALL_CASE(mask, a, b, c, d) \
+    case mask: cvt_channels(data, result, pixels, mask); break;
+
+void f32_to_f16_channels_maratyszcza_sse2(uint32_t *data, uint16_t *result, int pixels, int mask)
+{
+    // pass the mask as a constant so each loop only has its own shuffle
+    switch (mask & F16_CHANNELS_RGBA) {
+        F16_CHANNEL_SHUFFLES(CHANNELS_CALL_CASE)
+        case F16_CHANNELS_RGBA: f32_to_f16_buffer_maratyszcza_sse2(data, result, pixels * 4); break;
+        default: break;
+    }
+}
+
+// the multiply and add round separately, matching a float loop before the conversion
+static inline void cvt_scale_bias(uint32_t *data, uint16_t *result, int data_size, __m128 scale, __m128 bias)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps((float*)data), scale), bias);
+        __m128i ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)result, ph);
+
+        data += 4;
+        result += 4;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        __m128 ps = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps((float*)&in_buf[0]), scale), bias);
+        __m128i ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)&out_buf[0], ph);
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+void f32_to_f16_buffer_maratyszcza_sse2_scale_bias(uint32_t *data, uint16_t *result, int data_size, float scale, float bias)
+{
+    cvt_scale_bias(data, result, data_size, _mm_set1_ps(scale), _mm_set1_ps(bias));
+}
+
+void f32_to_f16_buffer_maratyszcza_sse2_scale_bias4(uint32_t *data, uint16_t *result, int data_size, const float scale[4], const float bias[4])
+{
+    cvt_scale_bias(data, result, data_size, _mm_loadu_ps(scale), _mm_loadu_ps(bias));
+}
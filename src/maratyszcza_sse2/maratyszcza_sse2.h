@@ -1,4 +1,31 @@
 #include <stdint.h>
+#include "../round_mode.h"
+#include "../special_values.h"
+#include "../convert_stats.h"
+#include "../channels.h"
 
 uint16_t f32_to_f16_maratyszcza_sse2(float f);
-void f32_to_f16_buffer_maratyszcza_sse2(uint32_t *data, uint16_t *result, int data_size);
\ No newline at end of file
+void f32_to_f16_buffer_maratyszcza_sse2(uint32_t *data, uint16_t *result, int data_size);
+
+// mode is one of the F16_ROUND_TO_* values in round_mode.h
+uint16_t f32_to_f16_maratyszcza_sse2_mode(float f, int mode);
+void f32_to_f16_buffer_maratyszcza_sse2_mode(uint32_t *data, uint16_t *result, int data_size, int mode);
+
+// flags are F16_SATURATE, F16_NAN_TO_ZERO and F16_NAN_CANONICAL from special_values.h
+void f32_to_f16_buffer_maratyszcza_sse2_special(uint32_t *data, uint16_t *result, int data_size, int flags);
+
+// same as the plain buffer function, stats is filled in from the same pass over data
+void f32_to_f16_buffer_maratyszcza_sse2_stats(uint32_t *data, uint16_t *result, int data_size, F16ConvertStats *stats);
+
+// in place, the halves are packed into the front of data
+void f32_to_f16_buffer_maratyszcza_sse2_inplace(uint32_t *data, int data_size);
+
+// interleaved rgba floats to 4 half planes in one pass, see image/image.h
+void f32_rgba_to_f16_planar_maratyszcza_sse2(uint32_t *data, int data_stride, uint16_t *planes[4], int plane_stride, int width, int height);
+
+// converts only the channels in mask (see channels.h) of rgba floats, packed in rgba order
+void f32_to_f16_channels_maratyszcza_sse2(uint32_t *data, uint16_t *result, int pixels, int mask);
+
+// half(x * scale + bias), the 4 version uses scale[i % 4] and bias[i % 4] for element i
+void f32_to_f16_buffer_maratyszcza_sse2_scale_bias(uint32_t *data, uint16_t *result, int data_size, float scale, float bias);
+void f32_to_f16_buffer_maratyszcza_sse2_scale_bias4(uint32_t *data, uint16_t *result, int data_size, const float scale[4], const float bias[4]);
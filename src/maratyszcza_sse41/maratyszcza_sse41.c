@@ -0,0 +1,93 @@
+#include "maratyszcza_sse41.h"
+#include <stdint.h>
+#include <immintrin.h>
+
+// https://www.corsix.org/content/converting-fp32-to-fp16
+// https://github.com/Maratyszcza/FP16/blob/0a92994d729ff76a58f692d3028ca1b64b145d91/include/fp16/fp16.h#L223-L247
+
+// same as maratyszcza_sse2 but uses the sse4.1 max, blend and pack instructions
+
+static inline __m128i cvtps_ph_sse41(__m128 a)
+{
+    __m128i x = _mm_castps_si128(a);
+
+    __m128i x_sign_mask = _mm_set1_epi32(0x80000000u);
+    __m128i x_sgn = _mm_and_si128(x, x_sign_mask);
+
+    __m128i x_exp_mask = _mm_set1_epi32(0x7f800000u);
+    __m128i x_exp = _mm_and_si128(x, x_exp_mask);
+
+    __m128 magic1 = _mm_castsi128_ps(_mm_set1_epi32(0x77800000u)); // 0x1.0p+112f
+    __m128 magic2 = _mm_castsi128_ps(_mm_set1_epi32(0x08800000u)); // 0x1.0p-110f
+
+    __m128i exp_max = _mm_set1_epi32(0x38800000u);
+    x_exp = _mm_max_epu32(x_exp, exp_max); // max(e, -14)
+    x_exp = _mm_add_epi32(x_exp, _mm_set1_epi32(15u << 23)); // e += 15
+    x = _mm_andnot_si128(x_sgn, x); // Discard sign
+
+    __m128 f = _mm_castsi128_ps(x);
+    __m128 magicf = _mm_castsi128_ps(x_exp);
+
+    // If 15 < e then inf, otherwise e += 2
+    f = _mm_mul_ps(_mm_mul_ps(f, magic1), magic2);
+    f = _mm_add_ps(f, magicf);
+
+    __m128i u = _mm_castps_si128(f);
+
+    __m128i h_exp = _mm_and_si128(_mm_srli_epi32(u, 13), _mm_set1_epi32(0x7c00u));
+    __m128i h_sig = _mm_and_si128(u, _mm_set1_epi32(0x0fffu));
+
+    // blend in nan values
+    __m128i nan_mask = _mm_cmpgt_epi32(x, x_exp_mask);
+    __m128i nan = _mm_and_si128(_mm_or_si128(_mm_srli_epi32(x, 13), _mm_set1_epi32(0x0200u)), _mm_set1_epi32(0x03FFu));
+    h_sig = _mm_blendv_epi8(h_sig, nan, nan_mask);
+
+    __m128i ph = _mm_add_epi32(_mm_srli_epi32(x_sgn, 16),_mm_add_epi32(h_exp, h_sig));
+
+    // pack u16 values into lower 8 bytes
+    return _mm_packus_epi32(ph, ph);
+}
+
+static inline uint16_t to_f16(float v)
+{
+    __m128 ps =_mm_set1_ps(v);
+    __m128i ph = cvtps_ph_sse41(ps);
+
+    return (uint16_t)_mm_extract_epi16(ph, 0);
+}
+
+uint16_t f32_to_f16_maratyszcza_sse41(float f)
+{
+    return to_f16(f);
+}
+
+void f32_to_f16_buffer_maratyszcza_sse41(uint32_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = _mm_loadu_ps((float*)data);
+        __m128i ph = cvtps_ph_sse41(ps);
+        _mm_storel_epi64((__m128i*)result, ph);
+
+        data += 4;
+        result += 4;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        __m128 ps = _mm_loadu_ps((float*)&in_buf[0]);
+        __m128i ph = cvtps_ph_sse41(ps);
+         _mm_storel_epi64((__m128i*)&out_buf[0], ph);
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
@@ -0,0 +1,4 @@
+#include <stdint.h>
+
+uint16_t f32_to_f16_maratyszcza_sse41(float f);
+void f32_to_f16_buffer_maratyszcza_sse41(uint32_t *data, uint16_t *result, int data_size);
@@ -0,0 +1,98 @@
+#include "maratyszcza_vec.h"
+#include <string.h>
+
+#if defined(HAVE_VECTOR_EXT)
+
+// https://www.corsix.org/content/converting-fp32-to-fp16
+// https://github.com/Maratyszcza/FP16/blob/0a92994d729ff76a58f692d3028ca1b64b145d91/include/fp16/fp16.h#L223-L247
+
+// same algorithm as maratyszcza_sse2 but written with gcc/clang vector extensions
+// so the compiler picks the instructions for the target (sse, avx2, neon, sve...)
+
+typedef uint32_t vec_u32 __attribute__((vector_size(VEC_LANES * sizeof(uint32_t))));
+typedef float    vec_f32 __attribute__((vector_size(VEC_LANES * sizeof(float))));
+typedef uint16_t vec_u16 __attribute__((vector_size(VEC_LANES * sizeof(uint16_t))));
+
+// b where mask is set, otherwise a
+static inline vec_u32 blendv_vec(vec_u32 a, vec_u32 b, vec_u32 mask)
+{
+    return ((a ^ b) & mask) ^ a;
+}
+
+static inline vec_u16 cvtps_ph_vec(vec_u32 x)
+{
+    vec_u32 x_sgn = x & 0x80000000u;
+    vec_u32 x_exp = x & 0x7f800000u;
+
+    vec_u32 exp_min = (vec_u32){0} + 0x38800000u;
+    x_exp = blendv_vec(x_exp, exp_min, (vec_u32)(x_exp < exp_min)); // max(e, -14)
+    x_exp += 15u << 23; // e += 15
+    x &= 0x7fffffffu; // Discard sign
+
+    vec_f32 f = (vec_f32)x;
+    vec_f32 magic = (vec_f32)x_exp;
+
+    // If 15 < e then inf, otherwise e += 2
+    f = (f * 0x1.0p+112f) * 0x1.0p-110f;
+    f += magic;
+
+    vec_u32 u = (vec_u32)f;
+    vec_u32 h_exp = (u >> 13) & 0x7c00u;
+    vec_u32 h_sig = u & 0x0fffu;
+
+    // blend in nan values, keeping the payload like hardware
+    vec_u32 nan_mask = (vec_u32)(x > 0x7f800000u);
+    vec_u32 nan = ((x >> 13) | 0x0200u) & 0x03FFu;
+    h_sig = blendv_vec(h_sig, nan, nan_mask);
+
+    vec_u32 h = (x_sgn >> 16) + h_exp + h_sig;
+    return __builtin_convertvector(h, vec_u16);
+}
+
+uint16_t f32_to_f16_maratyszcza_vec(float f)
+{
+    float src[VEC_LANES] = {f};
+    uint16_t dst[VEC_LANES];
+    vec_u32 x;
+
+    memcpy(&x, src, sizeof(x));
+    vec_u16 h = cvtps_ph_vec(x);
+    memcpy(dst, &h, sizeof(h));
+
+    return dst[0];
+}
+
+void f32_to_f16_buffer_maratyszcza_vec(uint32_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / VEC_LANES * VEC_LANES;
+    int remainder = data_size - size;
+    vec_u32 x;
+    vec_u16 h;
+
+    for (int i = 0; i < size; i+=VEC_LANES) {
+        memcpy(&x, data, sizeof(x));
+        h = cvtps_ph_vec(x);
+        memcpy(result, &h, sizeof(h));
+
+        data += VEC_LANES;
+        result += VEC_LANES;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[VEC_LANES] = {0};
+        uint16_t out_buf[VEC_LANES] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        memcpy(&x, in_buf, sizeof(x));
+        h = cvtps_ph_vec(x);
+        memcpy(out_buf, &h, sizeof(h));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,5 @@
+#include <stdint.h>
+#include "../platform_info.h"
+
+uint16_t f32_to_f16_maratyszcza_vec(float f);
+void f32_to_f16_buffer_maratyszcza_vec(uint32_t *data, uint16_t *result, int data_size);
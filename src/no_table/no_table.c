@@ -1,4 +1,5 @@
 #include "no_table.h"
+#include "../target_clones.h"
 
 typedef union {
         uint32_t i;
@@ -49,7 +50,7 @@ uint16_t f32_to_f16_no_table(float f)
     return float2half_full(value.i);
 }
 
-void f32_to_f16_buffer_no_table(uint32_t *data, uint16_t *result, int data_size)
+TARGET_CLONES void f32_to_f16_buffer_no_table(uint32_t *data, uint16_t *result, int data_size)
 {
     int_float value;
     for (int i =0; i < data_size; i++) {
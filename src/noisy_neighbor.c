@@ -0,0 +1,153 @@
+#include "noisy_neighbor.h"
+#include "threads.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+
+#define CACHE_LINE 64
+
+typedef struct NoisyNeighbor {
+    Thread thread;
+    uint8_t *buffer;
+    size_t size;
+    thread_flag running;
+    int self_pinned;
+    ThreadAffinity saved;
+    char placement[128];
+} NoisyNeighbor;
+
+static NoisyNeighbor neighbor;
+
+void noisy_neighbor_default_options(NoisyNeighborOptions *opt)
+{
+    opt->enabled = 0;
+    opt->size = NOISY_NEIGHBOR_DEFAULT_SIZE;
+    opt->cpu = -1;
+}
+
+// the whole string has to be a number that fits in an int, -1 if it is not
+static long parse_number(const char *text)
+{
+    char *end;
+    long v = strtol(text, &end, 10);
+
+    if (end == text || *end || v < 0 || v > INT_MAX)
+        return -1;
+    return v;
+}
+
+int noisy_neighbor_parse_arg(NoisyNeighborOptions *opt, const char *arg)
+{
+    if (!strcmp(arg, "--noisy-neighbor")) {
+        opt->enabled = 1;
+        return 1;
+    }
+
+    if (!strncmp(arg, "--noisy-size=", 13)) {
+        long kb = parse_number(arg + 13);
+        if (kb <= 0)
+            return -1;
+        opt->size = (size_t)kb * 1024;
+        opt->enabled = 1;
+        return 1;
+    }
+
+    if (!strncmp(arg, "--noisy-cpu=", 12)) {
+        long cpu = parse_number(arg + 12);
+        if (cpu < 0)
+            return -1;
+        opt->cpu = (int)cpu;
+        opt->enabled = 1;
+        return 1;
+    }
+
+    return 0;
+}
+
+static void noisy_neighbor_run(void *arg)
+{
+    NoisyNeighbor *n = (NoisyNeighbor*)arg;
+
+    // read modify write every cache line so lines are evicted dirty
+    while (thread_flag_get(&n->running)) {
+        for (size_t i = 0; i < n->size; i += CACHE_LINE) {
+            n->buffer[i] += 1;
+        }
+    }
+}
+
+static int pick_cpu(int requested)
+{
+    int count = get_cpu_count();
+
+    if (requested >= 0)
+        return requested < count ? requested : -1;
+
+    int sibling = get_cpu_sibling(0);
+    if (sibling >= 0)
+        return sibling;
+
+    return count > 1 ? 1 : -1;
+}
+
+int noisy_neighbor_start(const NoisyNeighborOptions *opt)
+{
+    NoisyNeighbor *n = &neighbor;
+
+    n->size = opt->size;
+    n->buffer = (uint8_t*)malloc(n->size);
+    if (!n->buffer)
+        return -1;
+
+    memset(n->buffer, 0, n->size);
+    thread_flag_set(&n->running, 1);
+
+    if (thread_create(&n->thread, noisy_neighbor_run, n)) {
+        free(n->buffer);
+        n->buffer = NULL;
+        return -1;
+    }
+
+    int cpu = pick_cpu(opt->cpu);
+    int pinned = cpu >= 0 && !thread_set_affinity(&n->thread, cpu);
+
+    // only pin the benchmark if its affinity can be put back afterwards
+    n->self_pinned = pinned && !thread_get_affinity_self(&n->saved) && !thread_set_affinity_self(0);
+
+    if (pinned) {
+        snprintf(n->placement, sizeof(n->placement), "cpu %d%s, benchmark %s",
+                 cpu, cpu == get_cpu_sibling(0) ? " (sibling hyperthread)" : "",
+                 n->self_pinned ? "on cpu 0" : "unpinned");
+    } else if (get_cpu_count() > 1) {
+        snprintf(n->placement, sizeof(n->placement), "unpinned");
+    } else {
+        snprintf(n->placement, sizeof(n->placement), "unpinned, single cpu so the co-runner time slices with the benchmark");
+    }
+
+    return 0;
+}
+
+void noisy_neighbor_stop(void)
+{
+    NoisyNeighbor *n = &neighbor;
+
+    if (!n->buffer)
+        return;
+
+    thread_flag_set(&n->running, 0);
+    thread_join(&n->thread);
+    free(n->buffer);
+    n->buffer = NULL;
+
+    if (n->self_pinned)
+        thread_restore_affinity_self(&n->saved);
+    n->self_pinned = 0;
+}
+
+const char *noisy_neighbor_placement(void)
+{
+    return neighbor.placement;
+}
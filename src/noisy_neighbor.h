@@ -0,0 +1,28 @@
+#ifndef NOISY_NEIGHBOR_H
+#define NOISY_NEIGHBOR_H
+
+#include <stddef.h>
+
+#define NOISY_NEIGHBOR_DEFAULT_SIZE (32 * 1024 * 1024)
+
+typedef struct NoisyNeighborOptions {
+    int enabled;
+    size_t size; // bytes the co-runner keeps cycling through
+    int cpu;     // cpu to pin the co-runner to, -1 picks sibling hyperthread or second core
+} NoisyNeighborOptions;
+
+void noisy_neighbor_default_options(NoisyNeighborOptions *opt);
+
+// parses --noisy-neighbor, --noisy-size=<KB>, --noisy-cpu=<n>
+// returns 1 if arg was a noisy neighbor option, -1 if it was one with a bad value
+int noisy_neighbor_parse_arg(NoisyNeighborOptions *opt, const char *arg);
+
+// starts a thread that keeps thrashing the cache until noisy_neighbor_stop.
+// the calling thread is pinned too, stop puts its old affinity back
+int noisy_neighbor_start(const NoisyNeighborOptions *opt);
+void noisy_neighbor_stop(void);
+
+// human readable description of where the co-runner is running
+const char *noisy_neighbor_placement(void);
+
+#endif // NOISY_NEIGHBOR_H
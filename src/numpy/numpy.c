@@ -1,4 +1,5 @@
 #include "numpy.h"
+#include "../target_clones.h"
 
 // https://www.corsix.org/content/converting-fp32-to-fp16
 // https://github.com/numpy/numpy/blob/13a5c4e569269aa4da6784e2ba83107b53f73bc9/numpy/core/src/npymath/halffloat.c#L244-L365
@@ -79,7 +80,7 @@ uint16_t f32_to_f16_numpy(float f)
     return numpy_floatbits_to_halfbits(value.i);
 }
 
-void f32_to_f16_buffer_numpy(uint32_t *data, uint16_t *result, int data_size)
+TARGET_CLONES void f32_to_f16_buffer_numpy(uint32_t *data, uint16_t *result, int data_size)
 {
     int_float value;
     for (int i =0; i < data_size; i++) {
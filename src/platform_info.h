@@ -37,6 +37,22 @@
 #define COMPILER_NAME "Unknown Compiler"
 #endif
 
+// gcc/clang vector extensions with __builtin_convertvector
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 9)
+#define HAVE_VECTOR_EXT
+
+// u32 lanes per vector in maratyszcza_vec and ryg_vec, one native register.
+// vectors wider than the target are split into halves that go through memory,
+// 8 lanes on plain sse2 ran at half the speed of maratyszcza_sse2
+#if defined(__AVX512F__)
+#define VEC_LANES 16
+#elif defined(__AVX2__)
+#define VEC_LANES 8
+#else
+#define VEC_LANES 4
+#endif
+#endif
+
 #if defined(_WIN32)
   #define PLATFORM_NAME "Windows"
 #elif defined(__APPLE__) && defined(__MACH__)
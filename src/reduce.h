@@ -0,0 +1,109 @@
+#ifndef REDUCE_H
+#define REDUCE_H
+
+#include <stdint.h>
+#include <math.h>
+
+// how the f16_sum_buffer_* and f16_dot_buffer_* kernels add up their terms.
+// each lane keeps its own sum, the lanes are only added together at the end
+#define F16_SUM_NAIVE    0 // plain running sum
+#define F16_SUM_KAHAN    1 // compensated, the rounding error of each add is carried to the next
+#define F16_SUM_PAIRWISE 2 // naive sums of F16_PAIRWISE_BLOCK terms, added together as a tree
+
+#define F16_PAIRWISE_BLOCK 1024
+
+// compensated sum, value is sum - c
+typedef struct F16Sum {
+    float sum;
+    float c;
+} F16Sum;
+
+static inline void f16_sum_init(F16Sum *s)
+{
+    s->sum = 0.0f;
+    s->c = 0.0f;
+}
+
+static inline void f16_sum_add_kahan(F16Sum *s, float v)
+{
+    float y = v - s->c;
+    float t = s->sum + y;
+    s->c = (t - s->sum) - y;
+    s->sum = t;
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+
+typedef struct F16SumSSE2 {
+    __m128 sum;
+    __m128 c;
+} F16SumSSE2;
+
+static inline void f16_sum_sse2_init(F16SumSSE2 *acc)
+{
+    acc->sum = _mm_setzero_ps();
+    acc->c = _mm_setzero_ps();
+}
+
+static inline void f16_sum_sse2_add(F16SumSSE2 *acc, __m128 ps)
+{
+    acc->sum = _mm_add_ps(acc->sum, ps);
+}
+
+static inline void f16_sum_sse2_add_kahan(F16SumSSE2 *acc, __m128 ps)
+{
+    __m128 y = _mm_sub_ps(ps, acc->c);
+    __m128 t = _mm_add_ps(acc->sum, y);
+    acc->c = _mm_sub_ps(_mm_sub_ps(t, acc->sum), y);
+    acc->sum = t;
+}
+
+// the lane sums and what each one is still missing go through one more compensated sum
+static inline float f16_sum_sse2_finish(const F16SumSSE2 *acc)
+{
+    float sum[4];
+    float c[4];
+    F16Sum s;
+
+    _mm_storeu_ps(sum, acc->sum);
+    _mm_storeu_ps(c, acc->c);
+
+    f16_sum_init(&s);
+    for (int i = 0; i < 4; i++) {
+        f16_sum_add_kahan(&s, sum[i]);
+        f16_sum_add_kahan(&s, -c[i]);
+    }
+    return s.sum - s.c;
+}
+
+// _mm_min_ps and _mm_max_ps return the second operand if either is nan,
+// so with the running value second nan lanes never get in
+static inline void f16_minmax_sse2_add(__m128 *min, __m128 *max, __m128 ps)
+{
+    *min = _mm_min_ps(ps, *min);
+    *max = _mm_max_ps(ps, *max);
+}
+
+static inline void f16_minmax_sse2_finish(__m128 min, __m128 max, float *min_value, float *max_value)
+{
+    float lanes[4];
+
+    *min_value = INFINITY;
+    *max_value = -INFINITY;
+
+    _mm_storeu_ps(lanes, min);
+    for (int i = 0; i < 4; i++) {
+        if (lanes[i] < *min_value)
+            *min_value = lanes[i];
+    }
+
+    _mm_storeu_ps(lanes, max);
+    for (int i = 0; i < 4; i++) {
+        if (lanes[i] > *max_value)
+            *max_value = lanes[i];
+    }
+}
+#endif
+
+#endif // REDUCE_H
@@ -0,0 +1,10 @@
+#include "representable.h"
+
+int f32_find_inexact_f16(uint32_t *data, int data_size)
+{
+    for (int i = 0; i < data_size; i++) {
+        if (!f32_fits_f16(data[i]))
+            return i;
+    }
+    return data_size;
+}
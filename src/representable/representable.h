@@ -0,0 +1,35 @@
+#ifndef REPRESENTABLE_H
+#define REPRESENTABLE_H
+
+#include <stdint.h>
+
+// finds the first float that does not come back bit for bit from float -> half -> float,
+// to pick half or float storage for a channel before converting it. a float comes back
+// if it is +/-0, +/-inf, a multiple of 2^-24 no bigger than HALF_MAX with at most 11
+// significant bits, or a quiet nan whose payload fits in a half.
+// signaling nans are quieted by the conversion and float denormals flush to zero, so
+// neither comes back. the kernels return the index of the first float that does not,
+// or data_size if they all do
+
+// one float, the definition the kernels are checked against
+static inline int f32_fits_f16(uint32_t u)
+{
+    uint32_t abs = u & 0x7FFFFFFF;
+    uint32_t exp = abs >> 23;
+    int drop;
+
+    if (abs > 0x7F800000)
+        return (abs & 0x00401FFF) == 0x00400000;
+    if (abs == 0 || abs == 0x7F800000)
+        return 1;
+    if (abs > 0x477FE000 || exp < 103)
+        return 0;
+
+    // normal halves keep 10 mantissa bits, denormals one less per binade below 2^-14
+    drop = exp >= 113 ? 13 : 126 - (int)exp;
+    return (abs & ((1u << drop) - 1)) == 0;
+}
+
+int f32_find_inexact_f16(uint32_t *data, int data_size);
+
+#endif // REPRESENTABLE_H
@@ -0,0 +1,71 @@
+#include "representable_sse2.h"
+#include <emmintrin.h>
+
+// all ones in lanes that do not survive f32_fits_f16
+static inline __m128i inexact_mask(__m128i x)
+{
+    __m128i abs = _mm_and_si128(x, _mm_set1_epi32(0x7FFFFFFF));
+
+    // below 2^-14 a float survives if it is a multiple of 2^-24. adding 0.5 rounds it to
+    // one, compared as bits so float denormals never match even with denormals as zero
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128i snapped = _mm_castps_si128(_mm_sub_ps(_mm_add_ps(_mm_castsi128_ps(abs), half), half));
+    __m128i denormal = _mm_cmplt_epi32(abs, _mm_set1_epi32(0x38800000));
+    __m128i denormal_inexact = _mm_andnot_si128(_mm_cmpeq_epi32(snapped, abs), denormal);
+
+    // above it the low 13 mantissa bits have to be zero, that covers quiet nans too
+    __m128i low_bits = _mm_and_si128(x, _mm_set1_epi32(0x1FFF));
+    __m128i normal_inexact = _mm_andnot_si128(denormal, _mm_xor_si128(_mm_cmpeq_epi32(low_bits, _mm_setzero_si128()),
+                                                                      _mm_set1_epi32(-1)));
+
+    // finite values past HALF_MAX and signaling nans
+    __m128i above_max = _mm_cmpgt_epi32(abs, _mm_set1_epi32(0x477FE000));
+    __m128i below_quiet = _mm_cmplt_epi32(abs, _mm_set1_epi32(0x7FC00000));
+    __m128i inf = _mm_cmpeq_epi32(abs, _mm_set1_epi32(0x7F800000));
+    __m128i out_of_range = _mm_andnot_si128(inf, _mm_and_si128(above_max, below_quiet));
+
+    return _mm_or_si128(_mm_or_si128(denormal_inexact, normal_inexact), out_of_range);
+}
+
+// bit i set if element i does not survive
+static inline int inexact8(const uint32_t *data)
+{
+    __m128i lo = inexact_mask(_mm_loadu_si128((const __m128i*)data));
+    __m128i hi = inexact_mask(_mm_loadu_si128((const __m128i*)(data + 4)));
+    return _mm_movemask_ps(_mm_castsi128_ps(lo)) | (_mm_movemask_ps(_mm_castsi128_ps(hi)) << 4);
+}
+
+static inline int first_bit(int bits)
+{
+    int i = 0;
+    while (!(bits & (1 << i)))
+        i++;
+    return i;
+}
+
+int f32_find_inexact_f16_sse2(uint32_t *data, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+    int bits;
+
+    for (int i = 0; i < size; i+=8) {
+        bits = inexact8(data + i);
+        if (bits)
+            return i + first_bit(bits);
+    }
+
+    // zeros always survive, so the padding never reports
+    if (remainder) {
+        uint32_t in_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[size + i];
+        }
+
+        bits = inexact8(in_buf);
+        if (bits)
+            return size + first_bit(bits);
+    }
+
+    return data_size;
+}
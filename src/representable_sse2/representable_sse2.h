@@ -0,0 +1,6 @@
+#include <stdint.h>
+#include "../representable/representable.h"
+
+// first float that does not survive a round trip through half, see representable.h.
+// checks the exponent and mantissa bits directly instead of converting
+int f32_find_inexact_f16_sse2(uint32_t *data, int data_size);
@@ -0,0 +1,11 @@
+#ifndef ROUND_MODE_H
+#define ROUND_MODE_H
+
+// rounding modes for the *_mode conversions,
+// values match the _MM_FROUND_TO_* immediates passed to _mm_cvtps_ph
+#define F16_ROUND_TO_NEAREST 0
+#define F16_ROUND_TO_NEG_INF 1
+#define F16_ROUND_TO_POS_INF 2
+#define F16_ROUND_TO_ZERO    3
+
+#endif // ROUND_MODE_H
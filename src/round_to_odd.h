@@ -0,0 +1,100 @@
+#ifndef ROUND_TO_ODD_H
+#define ROUND_TO_ODD_H
+
+// narrowing double to float with round to odd, then float to half with
+// round to nearest even gives the correctly rounded half. the float keeps
+// 13 more bits than a half needs, and the odd bit marks any lost value so
+// the second rounding can't land on a false tie.
+// nan lanes are left to the plain conversion, the payload is truncated.
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+
+// 2 doubles to the low 2 floats
+static inline __m128i cvtpd_ps_odd_sse2(__m128d pd)
+{
+    __m128d sign = _mm_set1_pd(-0.0);
+    __m128 ps = _mm_cvtpd_ps(pd);
+    __m128d back = _mm_cvtps_pd(ps);
+
+    // the 64 bit compare masks are all ones, so either half works as a 32 bit mask
+    __m128d inexact = _mm_and_pd(_mm_cmpneq_pd(back, pd), _mm_cmpord_pd(pd, pd));
+    __m128d away = _mm_and_pd(inexact, _mm_cmpgt_pd(_mm_andnot_pd(sign, back), _mm_andnot_pd(sign, pd)));
+    __m128i inexact_mask = _mm_shuffle_epi32(_mm_castpd_si128(inexact), _MM_SHUFFLE(3, 3, 2, 0));
+    __m128i away_mask = _mm_shuffle_epi32(_mm_castpd_si128(away), _MM_SHUFFLE(3, 3, 2, 0));
+
+    // step back toward zero if the nearest rounding went away, then set the odd bit
+    __m128i bits = _mm_add_epi32(_mm_castps_si128(ps), away_mask);
+    return _mm_or_si128(bits, _mm_and_si128(inexact_mask, _mm_set1_epi32(1)));
+}
+
+// 4 doubles to 4 floats
+static inline __m128 cvtpd_ps_odd_sse2_x2(__m128d lo, __m128d hi)
+{
+    return _mm_castsi128_ps(_mm_unpacklo_epi64(cvtpd_ps_odd_sse2(lo), cvtpd_ps_odd_sse2(hi)));
+}
+
+// 4 zero extended u16 to v / 65535 as floats rounded to odd. in binary v / 65535 is the
+// 16 bits of v repeating, v * 2^-16 + v * 2^-32 are the first 32 of them and err is
+// what the float add dropped. the bits after those are worth less than 2^-32 and are
+// never all zero, so the sum went away from zero exactly when err is negative.
+// 0 and 65535 get the odd bit too, they are nowhere near a half tie
+static inline __m128 u16_unorm_ps_odd_sse2(__m128i v)
+{
+    __m128 ps = _mm_cvtepi32_ps(v);
+    __m128 a = _mm_mul_ps(ps, _mm_set1_ps(1.0f / 65536.0f));
+    __m128 b = _mm_mul_ps(ps, _mm_set1_ps(1.0f / 4294967296.0f));
+    __m128 sum = _mm_add_ps(a, b);
+    __m128 err = _mm_add_ps(_mm_sub_ps(a, sum), b);
+    __m128i away_mask = _mm_castps_si128(_mm_cmplt_ps(err, _mm_setzero_ps()));
+
+    __m128i bits = _mm_add_epi32(_mm_castps_si128(sum), away_mask);
+    return _mm_castsi128_ps(_mm_or_si128(bits, _mm_set1_epi32(1)));
+}
+#endif
+
+#if defined(__AVX__)
+#include <immintrin.h>
+
+// 4 doubles to 4 floats
+static inline __m128 cvtpd_ps_odd_avx(__m256d pd)
+{
+    __m256d sign = _mm256_set1_pd(-0.0);
+    __m128 ps = _mm256_cvtpd_ps(pd);
+    __m256d back = _mm256_cvtps_pd(ps);
+
+    __m256d inexact = _mm256_cmp_pd(back, pd, _CMP_NEQ_OQ);
+    __m256d away = _mm256_and_pd(inexact, _mm256_cmp_pd(_mm256_andnot_pd(sign, back), _mm256_andnot_pd(sign, pd), _CMP_GT_OQ));
+
+    // the even dwords of the 64 bit masks line up with the 4 floats
+    __m128 inexact_lo = _mm256_castps256_ps128(_mm256_castpd_ps(inexact));
+    __m128 inexact_hi = _mm256_extractf128_ps(_mm256_castpd_ps(inexact), 1);
+    __m128 away_lo = _mm256_castps256_ps128(_mm256_castpd_ps(away));
+    __m128 away_hi = _mm256_extractf128_ps(_mm256_castpd_ps(away), 1);
+    __m128i inexact_mask = _mm_castps_si128(_mm_shuffle_ps(inexact_lo, inexact_hi, _MM_SHUFFLE(2, 0, 2, 0)));
+    __m128i away_mask = _mm_castps_si128(_mm_shuffle_ps(away_lo, away_hi, _MM_SHUFFLE(2, 0, 2, 0)));
+
+    __m128i bits = _mm_add_epi32(_mm_castps_si128(ps), away_mask);
+    return _mm_castsi128_ps(_mm_or_si128(bits, _mm_and_si128(inexact_mask, _mm_set1_epi32(1))));
+}
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+// 8 lane u16_unorm_ps_odd_sse2
+static inline __m256 u16_unorm_ps_odd_avx2(__m256i v)
+{
+    __m256 ps = _mm256_cvtepi32_ps(v);
+    __m256 a = _mm256_mul_ps(ps, _mm256_set1_ps(1.0f / 65536.0f));
+    __m256 b = _mm256_mul_ps(ps, _mm256_set1_ps(1.0f / 4294967296.0f));
+    __m256 sum = _mm256_add_ps(a, b);
+    __m256 err = _mm256_add_ps(_mm256_sub_ps(a, sum), b);
+    __m256i away_mask = _mm256_castps_si256(_mm256_cmp_ps(err, _mm256_setzero_ps(), _CMP_LT_OQ));
+
+    __m256i bits = _mm256_add_epi32(_mm256_castps_si256(sum), away_mask);
+    return _mm256_castsi256_ps(_mm256_or_si256(bits, _mm256_set1_epi32(1)));
+}
+#endif
+
+#endif // ROUND_TO_ODD_H
@@ -1,4 +1,5 @@
 #include "ryg.h"
+#include "../target_clones.h"
 
 // https://www.corsix.org/content/converting-fp32-to-fp16
 // https://gist.github.com/rygorous/2156668
@@ -52,7 +53,7 @@ uint16_t f32_to_f16_ryg(float f)
     return float_to_half_fast3_rtne(value.u);
 }
 
-void f32_to_f16_buffer_ryg(uint32_t *data, uint16_t *result, int data_size)
+TARGET_CLONES void f32_to_f16_buffer_ryg(uint32_t *data, uint16_t *result, int data_size)
 {
     int_float value;
     for (int i =0; i < data_size; i++) {
@@ -89,7 +90,7 @@ float f16_to_f32_ryg(uint16_t h)
   return half_to_float_ryg(h);
 }
 
-void f16_to_f32_buffer_ryg(uint16_t *data, uint32_t *result, int data_size)
+TARGET_CLONES void f16_to_f32_buffer_ryg(uint16_t *data, uint32_t *result, int data_size)
 {
     int_float value;
     for (int i =0; i < data_size; i++) {
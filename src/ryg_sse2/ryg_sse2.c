@@ -1,37 +1,11 @@
 #include "ryg_sse2.h"
+#include "../round_to_odd.h"
 #include <immintrin.h>
+#include <string.h>
+#include "../image/image.h"
+#include "sse2_cvtph_ps.h"
 
 
-static inline __m128 sse2_cvtph_ps(__m128i a)
-{
-    __m128 magic      = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
-    __m128 was_infnan = _mm_castsi128_ps(_mm_set1_epi32((127 + 16) << 23));
-    __m128i sign, nan_mask, inf_mask, ou, ou_nan, ou_inf;
-    __m128 o;
-    // the values to unpack are in the lower 64 bits
-    // | 0 1 | 2 3 | 4 5 | 6 7 | 8 9 | 10 11 | 12 13 | 14 15
-    // | 0 1 | 0 1 | 2 3 | 2 3 | 4 5 |  4  5 | 6   7 | 6   7
-    a = _mm_unpacklo_epi16(a, a);
-
-    // extract sign
-    sign = _mm_slli_epi32(_mm_and_si128(a, _mm_set1_epi32(0x8000)), 16);
-
-    // extract exponent/mantissa bits
-    o = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(a, _mm_set1_epi32(0x7fff)), 13));
-
-    // magic multiply
-    o = _mm_mul_ps(o, magic);
-
-    ou = _mm_castps_si128(o);
-    nan_mask = _mm_castps_si128(_mm_cmpgt_ps(o, was_infnan));
-    inf_mask = _mm_cmpeq_epi32(ou, _mm_castps_si128(was_infnan));
-
-    ou_nan = _mm_and_si128(nan_mask, _mm_set1_epi32(0x01FF << 22));
-    ou_inf = _mm_and_si128(inf_mask, _mm_set1_epi32(0x00FF << 23));
-
-    return  _mm_castsi128_ps(_mm_or_si128(ou, _mm_or_si128(sign, _mm_or_si128(ou_nan, ou_inf))));
-}
-
 float f16_to_f32_ryg_sse2(uint16_t v)
 {
     float result[4];
@@ -76,9 +50,75 @@ static inline __m128i blendv_sse2(__m128i a, __m128i b, __m128i mask)
     return _mm_xor_si128(_mm_and_si128(_mm_xor_si128(a, b), mask), a);
 }
 
+
+// per lane mask of values whose magnitude rounds up
+static inline __m128i away_mask_sse2(__m128 a, int imm8)
+{
+    __m128i sign = _mm_srai_epi32(_mm_castps_si128(a), 31);
+    if (imm8 == _MM_FROUND_TO_POS_INF)
+        return _mm_xor_si128(sign, _mm_set1_epi32(-1));
+    if (imm8 == _MM_FROUND_TO_NEG_INF)
+        return sign;
+    return _mm_setzero_si128();
+}
+
+// truncate, or round the magnitude up on away lanes
+static inline __m128i cvtps_ph_sse2_directed(__m128 a, int imm8)
+{
+    __m128i denorm_magic = _mm_set1_epi32(((127u - 14u) + (23u - 10u)) << 23);
+    __m128i away = away_mask_sse2(a, imm8);
+
+    __m128i x_sgn = _mm_and_si128(_mm_castps_si128(a), _mm_set1_epi32(0x80000000u));
+    __m128i x =  _mm_andnot_si128(x_sgn, _mm_castps_si128(a));
+    __m128i x_shift = _mm_srli_epi32(x, 13);
+
+    __m128i subnormal_mask =  _mm_cmplt_epi32(x, _mm_set1_epi32(0x38800000u));
+    __m128i infnan_mask = _mm_cmpgt_epi32(x, _mm_set1_epi32(0x47800000u - 1));
+    __m128i inf_mask = _mm_cmpgt_epi32(x, _mm_set1_epi32(0x7f800000u - 1));
+    __m128i nan_mask = _mm_cmpgt_epi32(x, _mm_set1_epi32(0x7f800000u));
+
+    // a bias of 0xfff + odd gives nearest even, 0x1fff carries any discarded bit
+    __m128i norm = _mm_add_epi32(x, _mm_set1_epi32((15u - 127u) << 23));
+    norm = _mm_add_epi32(norm, _mm_and_si128(away, _mm_set1_epi32(0x1fffu)));
+    norm = _mm_srli_epi32(norm, 13);
+
+    // the magic add rounds to nearest even, subtract it back out to see which way it went
+    __m128 sum = _mm_add_ps(_mm_castsi128_ps(denorm_magic), _mm_castsi128_ps(x));
+    __m128 back = _mm_sub_ps(sum, _mm_castsi128_ps(denorm_magic));
+    __m128i rounded_up = _mm_castps_si128(_mm_cmpgt_ps(back, _mm_castsi128_ps(x)));
+    __m128i inexact = _mm_castps_si128(_mm_cmpneq_ps(back, _mm_castsi128_ps(x)));
+
+    __m128i denorm = _mm_sub_epi32(_mm_castps_si128(sum), denorm_magic);
+    denorm = _mm_add_epi32(denorm, rounded_up);
+    denorm = _mm_sub_epi32(denorm, _mm_and_si128(inexact, away));
+
+    __m128i nan = _mm_and_si128(x_shift, _mm_set1_epi32(0x03FFu));
+    nan = _mm_or_si128(nan, _mm_set1_epi32(0x7e00u));
+    nan = _mm_and_si128(nan, nan_mask);
+
+    // finite values past HALF_MAX truncate to HALF_MAX, away lanes carry into inf
+    __m128i overflow = _mm_sub_epi32(_mm_set1_epi32(0x7bff), away);
+    __m128i inf = blendv_sse2(overflow, _mm_set1_epi32(0x7c00), inf_mask);
+    __m128i infnan = _mm_or_si128(inf, nan);
+
+    x = blendv_sse2(norm, denorm, subnormal_mask);
+    x = blendv_sse2(x, infnan, infnan_mask);
+
+    x_sgn = _mm_srli_epi32(x_sgn, 16);
+    x = _mm_or_si128(x, x_sgn);
+
+    // pack u16 values into lower 8 bytes
+    x = _mm_shufflehi_epi16(x, (1 << 6 | 1 << 4 | 2 << 2 | 0 << 0));
+    x = _mm_shufflelo_epi16(x, (1 << 6 | 1 << 4 | 2 << 2 | 0 << 0));
+    return _mm_shuffle_epi32(x, (1 << 6 | 1 << 4 | 2 << 2 | 0 << 0));
+}
+
 // drop in replacement for hardware instruction
-static inline __m128i cvtps_ph_sse2(__m128 a, int imm8 /*unused always _MM_FROUND_TO_NEAREST_INT*/)
+static inline __m128i cvtps_ph_sse2(__m128 a, int imm8)
 {
+    if (imm8 != _MM_FROUND_TO_NEAREST_INT)
+        return cvtps_ph_sse2_directed(a, imm8);
+
     __m128i denorm_magic = _mm_set1_epi32(((127u - 14u) + (23u - 10u)) << 23);
 
     __m128i x_sgn = _mm_and_si128(_mm_castps_si128(a), _mm_set1_epi32(0x80000000u));
@@ -190,3 +230,463 @@ void f32_to_f16_buffer_ryg_sse2(uint32_t *data, uint16_t *result, int data_size)
 #endif
 
 }
+
+static inline void cvt_buffer_mode(uint32_t *data, uint16_t *result, int data_size, const int imm8)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = _mm_loadu_ps((float*)data);
+        __m128i ph = cvtps_ph_sse2(ps, imm8);
+        _mm_storel_epi64((__m128i*)result, ph);
+
+        data += 4;
+        result += 4;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        __m128 ps = _mm_loadu_ps((float*)&in_buf[0]);
+        __m128i ph = cvtps_ph_sse2(ps, imm8);
+        _mm_storel_epi64((__m128i*)&out_buf[0], ph);
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+uint16_t f32_to_f16_ryg_sse2_mode(float f, int mode)
+{
+    uint16_t result[8] = {0};
+    __m128 ps =_mm_set1_ps(f);
+    __m128i ph;
+
+    switch (mode) {
+        case F16_ROUND_TO_NEG_INF: ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_NEG_INF);     break;
+        case F16_ROUND_TO_POS_INF: ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_POS_INF);     break;
+        case F16_ROUND_TO_ZERO:    ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_ZERO);        break;
+        default:                   ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_NEAREST_INT); break;
+    }
+
+    _mm_storeu_si128((__m128i*)result, ph);
+
+    return result[0];
+}
+
+void f32_to_f16_buffer_ryg_sse2_mode(uint32_t *data, uint16_t *result, int data_size, int mode)
+{
+    // pass the mode as a constant so each loop only has its own rounding code
+    switch (mode) {
+        case F16_ROUND_TO_NEG_INF: cvt_buffer_mode(data, result, data_size, _MM_FROUND_TO_NEG_INF); break;
+        case F16_ROUND_TO_POS_INF: cvt_buffer_mode(data, result, data_size, _MM_FROUND_TO_POS_INF); break;
+        case F16_ROUND_TO_ZERO:    cvt_buffer_mode(data, result, data_size, _MM_FROUND_TO_ZERO);    break;
+        default: f32_to_f16_buffer_ryg_sse2(data, result, data_size); break;
+    }
+}
+
+static inline __m128i cvt8_special(const uint32_t *data, int flags)
+{
+    __m128i lo = cvtps_ph_sse2(_mm_loadu_ps((const float*)data), _MM_FROUND_TO_NEAREST_INT);
+    __m128i hi = cvtps_ph_sse2(_mm_loadu_ps((const float*)data + 4), _MM_FROUND_TO_NEAREST_INT);
+    return f16_fix_special_sse2(_mm_unpacklo_epi64(lo, hi), flags);
+}
+
+void f32_to_f16_buffer_ryg_sse2_special(uint32_t *data, uint16_t *result, int data_size, int flags)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=8) {
+        _mm_storeu_si128((__m128i*)result, cvt8_special(data, flags));
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[8] = {0};
+        uint16_t out_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        _mm_storeu_si128((__m128i*)&out_buf[0], cvt8_special(in_buf, flags));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+void f32_to_f16_buffer_ryg_sse2_stats(uint32_t *data, uint16_t *result, int data_size, F16ConvertStats *stats)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    F16StatsSSE2 acc;
+
+    f16_stats_init(stats);
+    f16_stats_sse2_init(&acc);
+
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = _mm_loadu_ps((float*)data);
+        __m128i ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)result, ph);
+        f16_stats_sse2_add(&acc, ps);
+
+        data += 4;
+        result += 4;
+    }
+
+    f16_stats_sse2_finish(&acc, stats);
+
+    // zero padding the tail would count as a finite value, so it goes one at a time
+    f32_to_f16_buffer_ryg_sse2(data, result, remainder);
+    for (int i = 0; i < remainder; i++) {
+        f16_stats_add(stats, data[i]);
+    }
+}
+
+// round to odd through float, see round_to_odd.h
+void f64_to_f16_buffer_ryg_sse2(uint64_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = cvtpd_ps_odd_sse2_x2(_mm_loadu_pd((double*)data), _mm_loadu_pd((double*)data + 2));
+        __m128i ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)result, ph);
+
+        data += 4;
+        result += 4;
+    }
+
+    if (remainder) {
+        uint64_t in_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        __m128 ps = cvtpd_ps_odd_sse2_x2(_mm_loadu_pd((double*)&in_buf[0]), _mm_loadu_pd((double*)&in_buf[2]));
+        __m128i ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)&out_buf[0], ph);
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+void f16_to_f64_buffer_ryg_sse2(uint16_t *data, uint64_t *result, int data_size)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = sse2_cvtph_ps(_mm_loadl_epi64((const __m128i*)data));
+        _mm_storeu_pd((double*)result, _mm_cvtps_pd(ps));
+        _mm_storeu_pd((double*)result + 2, _mm_cvtps_pd(_mm_movehl_ps(ps, ps)));
+
+        data += 4;
+        result += 4;
+    }
+
+    if (remainder) {
+        uint16_t in_buf[4] = {0};
+        uint64_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        __m128 ps = sse2_cvtph_ps(_mm_loadl_epi64((const __m128i*)&in_buf[0]));
+        _mm_storeu_pd((double*)&out_buf[0], _mm_cvtps_pd(ps));
+        _mm_storeu_pd((double*)&out_buf[2], _mm_cvtps_pd(_mm_movehl_ps(ps, ps)));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+void f16_to_i32_buffer_ryg_sse2(uint16_t *data, int32_t *result, int data_size, float scale)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    __m128 s = _mm_set1_ps(scale);
+
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = sse2_cvtph_ps(_mm_loadl_epi64((const __m128i*)data));
+        _mm_storeu_si128((__m128i*)result, cvtps_epi32_scaled_sse2(ps, s));
+
+        data += 4;
+        result += 4;
+    }
+
+    if (remainder) {
+        uint16_t in_buf[4] = {0};
+        int32_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        __m128 ps = sse2_cvtph_ps(_mm_loadl_epi64((const __m128i*)&in_buf[0]));
+        _mm_storeu_si128((__m128i*)&out_buf[0], cvtps_epi32_scaled_sse2(ps, s));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+// in place, the tails go through memcpy since the same bytes are read as one
+// type and written as the other
+void f32_to_f16_buffer_ryg_sse2_inplace(uint32_t *data, int data_size)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    uint16_t *result = (uint16_t*)data;
+
+    // the 4 halves land on bytes of floats that were already loaded
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = _mm_loadu_ps((float*)data + i);
+        __m128i ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)(result + i), ph);
+    }
+
+    if (remainder) {
+        uint32_t in_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        memcpy(in_buf, data + size, remainder * sizeof(uint32_t));
+
+        __m128 ps = _mm_loadu_ps((float*)&in_buf[0]);
+        __m128i ph = cvtps_ph_sse2(ps, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)&out_buf[0], ph);
+
+        memcpy(result + size, out_buf, remainder * sizeof(uint16_t));
+    }
+}
+
+void f16_to_f32_buffer_ryg_sse2_inplace(uint16_t *data, int data_size)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    uint32_t *result = (uint32_t*)data;
+
+    // back to front, the 4 floats only cover halves at or past the ones just loaded
+    if (remainder) {
+        uint16_t in_buf[4] = {0};
+        uint32_t out_buf[4] = {0};
+        memcpy(in_buf, data + size, remainder * sizeof(uint16_t));
+
+        __m128 p = sse2_cvtph_ps(_mm_loadl_epi64((const __m128i*)&in_buf[0]));
+        _mm_storeu_si128((__m128i*)&out_buf[0], _mm_castps_si128(p));
+
+        memcpy(result + size, out_buf, remainder * sizeof(uint32_t));
+    }
+
+    for (int i = size - 4; i >= 0; i-=4) {
+        __m128 p = sse2_cvtph_ps(_mm_loadl_epi64((const __m128i*)(data + i)));
+        _mm_storeu_si128((__m128i*)(result + i), _mm_castps_si128(p));
+    }
+}
+
+static inline void rgba_to_planar4(const uint32_t *src, uint16_t *planes[4], int x)
+{
+    __m128 r = _mm_loadu_ps((const float*)src);
+    __m128 g = _mm_loadu_ps((const float*)src + 4);
+    __m128 b = _mm_loadu_ps((const float*)src + 8);
+    __m128 a = _mm_loadu_ps((const float*)src + 12);
+    _MM_TRANSPOSE4_PS(r, g, b, a);
+    _mm_storel_epi64((__m128i*)(planes[0] + x), cvtps_ph_sse2(r, _MM_FROUND_TO_NEAREST_INT));
+    _mm_storel_epi64((__m128i*)(planes[1] + x), cvtps_ph_sse2(g, _MM_FROUND_TO_NEAREST_INT));
+    _mm_storel_epi64((__m128i*)(planes[2] + x), cvtps_ph_sse2(b, _MM_FROUND_TO_NEAREST_INT));
+    _mm_storel_epi64((__m128i*)(planes[3] + x), cvtps_ph_sse2(a, _MM_FROUND_TO_NEAREST_INT));
+}
+
+static inline void planar_to_rgba4(uint16_t *planes[4], int x, uint32_t *dst)
+{
+    __m128 r = sse2_cvtph_ps(_mm_loadl_epi64((const __m128i*)(planes[0] + x)));
+    __m128 g = sse2_cvtph_ps(_mm_loadl_epi64((const __m128i*)(planes[1] + x)));
+    __m128 b = sse2_cvtph_ps(_mm_loadl_epi64((const __m128i*)(planes[2] + x)));
+    __m128 a = sse2_cvtph_ps(_mm_loadl_epi64((const __m128i*)(planes[3] + x)));
+    _MM_TRANSPOSE4_PS(r, g, b, a);
+    _mm_storeu_ps((float*)dst, r);
+    _mm_storeu_ps((float*)dst + 4, g);
+    _mm_storeu_ps((float*)dst + 8, b);
+    _mm_storeu_ps((float*)dst + 12, a);
+}
+
+// 4 pixels per step, the last few pixels of a row go through the same step on the stack
+void f32_rgba_to_f16_planar_ryg_sse2(uint32_t *data, int data_stride, uint16_t *planes[4], int plane_stride, int width, int height)
+{
+    int size = width / 4 * 4;
+    int remainder = width - size;
+
+    for (int y = 0; y < height; y++) {
+        uint32_t *src = IMAGE_ROW(uint32_t, data, data_stride, y);
+        uint16_t *row[4];
+        for (int c = 0; c < 4; c++) {
+            row[c] = IMAGE_ROW(uint16_t, planes[c], plane_stride, y);
+        }
+
+        for (int x = 0; x < size; x+=4) {
+            rgba_to_planar4(src + x * 4, row, x);
+        }
+
+        if (remainder) {
+            uint32_t in_buf[16] = {0};
+            uint16_t out_buf[4][4];
+            uint16_t *out[4] = {out_buf[0], out_buf[1], out_buf[2], out_buf[3]};
+            for (int i = 0; i < remainder * 4; i++) {
+                in_buf[i] = src[size * 4 + i];
+            }
+
+            rgba_to_planar4(in_buf, out, 0);
+
+            for (int c = 0; c < 4; c++) {
+                for (int i = 0; i < remainder; i++) {
+                    row[c][size + i] = out_buf[c][i];
+                }
+            }
+        }
+    }
+}
+
+void f16_planar_to_f32_rgba_ryg_sse2(uint16_t *planes[4], int plane_stride, uint32_t *result, int result_stride, int width, int height)
+{
+    int size = width / 4 * 4;
+    int remainder = width - size;
+
+    for (int y = 0; y < height; y++) {
+        uint32_t *dst = IMAGE_ROW(uint32_t, result, result_stride, y);
+        uint16_t *row[4];
+        for (int c = 0; c < 4; c++) {
+            row[c] = IMAGE_ROW(uint16_t, planes[c], plane_stride, y);
+        }
+
+        for (int x = 0; x < size; x+=4) {
+            planar_to_rgba4(row, x, dst + x * 4);
+        }
+
+        if (remainder) {
+            uint16_t in_buf[4][4] = {{0}};
+            uint32_t out_buf[16];
+            uint16_t *in[4] = {in_buf[0], in_buf[1], in_buf[2], in_buf[3]};
+            for (int c = 0; c < 4; c++) {
+                for (int i = 0; i < remainder; i++) {
+                    in_buf[c][i] = row[c][size + i];
+                }
+            }
+
+            planar_to_rgba4(in, 0, out_buf);
+
+            for (int i = 0; i < remainder * 4; i++) {
+                dst[size * 4 + i] = out_buf[i];
+            }
+        }
+    }
+}
+
+// reductions decode straight into registers, nothing is written back as floats
+static inline __m128 reduce_term(const uint16_t *a, const uint16_t *b, const int dot)
+{
+    __m128 ps = sse2_cvtph_ps(_mm_loadl_epi64((const __m128i*)a));
+    if (dot)
+        ps = _mm_mul_ps(ps, sse2_cvtph_ps(_mm_loadl_epi64((const __m128i*)b)));
+    return ps;
+}
+
+// size is a multiple of 4, halves are split on a vector boundary
+static __m128 sum_pairwise(const uint16_t *a, const uint16_t *b, int size, const int dot)
+{
+    if (size <= F16_PAIRWISE_BLOCK) {
+        __m128 sum = _mm_setzero_ps();
+        for (int i = 0; i < size; i+=4) {
+            sum = _mm_add_ps(sum, reduce_term(a + i, dot ? b + i : b, dot));
+        }
+        return sum;
+    }
+
+    int half = size / 8 * 4;
+    return _mm_add_ps(sum_pairwise(a, b, half, dot), sum_pairwise(a + half, dot ? b + half : b, size - half, dot));
+}
+
+static inline float reduce(const uint16_t *a, const uint16_t *b, int data_size, int mode, const int dot)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    F16SumSSE2 acc;
+
+    f16_sum_sse2_init(&acc);
+
+    if (mode == F16_SUM_PAIRWISE) {
+        acc.sum = sum_pairwise(a, b, size, dot);
+    } else if (mode == F16_SUM_KAHAN) {
+        for (int i = 0; i < size; i+=4) {
+            f16_sum_sse2_add_kahan(&acc, reduce_term(a + i, dot ? b + i : b, dot));
+        }
+    } else {
+        for (int i = 0; i < size; i+=4) {
+            f16_sum_sse2_add(&acc, reduce_term(a + i, dot ? b + i : b, dot));
+        }
+    }
+
+    // zero halves add nothing to either sum
+    if (remainder) {
+        uint16_t a_buf[4] = {0};
+        uint16_t b_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            a_buf[i] = a[size + i];
+            b_buf[i] = dot ? b[size + i] : 0;
+        }
+
+        if (mode == F16_SUM_KAHAN)
+            f16_sum_sse2_add_kahan(&acc, reduce_term(a_buf, b_buf, dot));
+        else
+            f16_sum_sse2_add(&acc, reduce_term(a_buf, b_buf, dot));
+    }
+
+    return f16_sum_sse2_finish(&acc);
+}
+
+void f16_minmax_buffer_ryg_sse2(uint16_t *data, int data_size, float *min, float *max)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+    __m128 lo = _mm_set1_ps(INFINITY);
+    __m128 hi = _mm_set1_ps(-INFINITY);
+
+    for (int i = 0; i < size; i+=4) {
+        f16_minmax_sse2_add(&lo, &hi, sse2_cvtph_ps(_mm_loadl_epi64((const __m128i*)(data + i))));
+    }
+
+    // the tail is padded with nan, which min and max skip
+    if (remainder) {
+        uint16_t in_buf[4] = {0x7E00, 0x7E00, 0x7E00, 0x7E00};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[size + i];
+        }
+
+        f16_minmax_sse2_add(&lo, &hi, sse2_cvtph_ps(_mm_loadl_epi64((const __m128i*)&in_buf[0])));
+    }
+
+    f16_minmax_sse2_finish(lo, hi, min, max);
+}
+
+float f16_sum_buffer_ryg_sse2(uint16_t *data, int data_size, int mode)
+{
+    return reduce(data, NULL, data_size, mode, 0);
+}
+
+float f16_dot_buffer_ryg_sse2(uint16_t *a, uint16_t *b, int data_size, int mode)
+{
+    return reduce(a, b, data_size, mode, 1);
+}
@@ -1,7 +1,43 @@
 #include <stdint.h>
+#include "../round_mode.h"
+#include "../special_values.h"
+#include "../convert_stats.h"
+#include "../widen.h"
+#include "../reduce.h"
 
 uint16_t f32_to_f16_ryg_sse2(float f);
 float f16_to_f32_ryg_sse2(uint16_t h);
 
 void f16_to_f32_buffer_ryg_sse2(uint16_t *data, uint32_t *result, int data_size);
-void f32_to_f16_buffer_ryg_sse2(uint32_t *data, uint16_t *result, int data_size);
\ No newline at end of file
+void f32_to_f16_buffer_ryg_sse2(uint32_t *data, uint16_t *result, int data_size);
+
+// mode is one of the F16_ROUND_TO_* values in round_mode.h
+uint16_t f32_to_f16_ryg_sse2_mode(float f, int mode);
+void f32_to_f16_buffer_ryg_sse2_mode(uint32_t *data, uint16_t *result, int data_size, int mode);
+
+// flags are F16_SATURATE, F16_NAN_TO_ZERO and F16_NAN_CANONICAL from special_values.h
+void f32_to_f16_buffer_ryg_sse2_special(uint32_t *data, uint16_t *result, int data_size, int flags);
+
+// same as the plain buffer function, stats is filled in from the same pass over data
+void f32_to_f16_buffer_ryg_sse2_stats(uint32_t *data, uint16_t *result, int data_size, F16ConvertStats *stats);
+
+// correctly rounded double to half
+void f64_to_f16_buffer_ryg_sse2(uint64_t *data, uint16_t *result, int data_size);
+
+// exact half to double
+void f16_to_f64_buffer_ryg_sse2(uint16_t *data, uint64_t *result, int data_size);
+// half * scale to int32, see widen.h
+void f16_to_i32_buffer_ryg_sse2(uint16_t *data, int32_t *result, int data_size, float scale);
+
+// in place, data must have room for data_size uint32_t, see hardware.h
+void f32_to_f16_buffer_ryg_sse2_inplace(uint32_t *data, int data_size);
+void f16_to_f32_buffer_ryg_sse2_inplace(uint16_t *data, int data_size);
+
+// interleaved rgba floats to 4 half planes and back in one pass, see image/image.h
+void f32_rgba_to_f16_planar_ryg_sse2(uint32_t *data, int data_stride, uint16_t *planes[4], int plane_stride, int width, int height);
+void f16_planar_to_f32_rgba_ryg_sse2(uint16_t *planes[4], int plane_stride, uint32_t *result, int result_stride, int width, int height);
+
+// reductions without a float buffer, see hardware.h
+float f16_sum_buffer_ryg_sse2(uint16_t *data, int data_size, int mode);
+float f16_dot_buffer_ryg_sse2(uint16_t *a, uint16_t *b, int data_size, int mode);
+void f16_minmax_buffer_ryg_sse2(uint16_t *data, int data_size, float *min, float *max);
@@ -0,0 +1,150 @@
+#include "ryg_sse41.h"
+#include <immintrin.h>
+
+// same as ryg_sse2 but uses the sse4.1 zero extend, blend and pack instructions
+
+static inline __m128 sse41_cvtph_ps(__m128i a)
+{
+    __m128 magic      = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+    __m128 was_infnan = _mm_castsi128_ps(_mm_set1_epi32((127 + 16) << 23));
+    __m128i sign, nan_mask, inf_mask, ou, ou_nan, ou_inf;
+    __m128 o;
+
+    // the values to unpack are in the lower 64 bits
+    a = _mm_cvtepu16_epi32(a);
+
+    // extract sign
+    sign = _mm_slli_epi32(_mm_and_si128(a, _mm_set1_epi32(0x8000)), 16);
+
+    // extract exponent/mantissa bits
+    o = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(a, _mm_set1_epi32(0x7fff)), 13));
+
+    // magic multiply
+    o = _mm_mul_ps(o, magic);
+
+    ou = _mm_castps_si128(o);
+    nan_mask = _mm_castps_si128(_mm_cmpgt_ps(o, was_infnan));
+    inf_mask = _mm_cmpeq_epi32(ou, _mm_castps_si128(was_infnan));
+
+    ou_nan = _mm_and_si128(nan_mask, _mm_set1_epi32(0x01FF << 22));
+    ou_inf = _mm_and_si128(inf_mask, _mm_set1_epi32(0x00FF << 23));
+
+    return  _mm_castsi128_ps(_mm_or_si128(ou, _mm_or_si128(sign, _mm_or_si128(ou_nan, ou_inf))));
+}
+
+float f16_to_f32_ryg_sse41(uint16_t v)
+{
+    __m128 ps = sse41_cvtph_ps(_mm_set1_epi16(v));
+    return _mm_cvtss_f32(ps);
+}
+
+void f16_to_f32_buffer_ryg_sse41(uint16_t *data, uint32_t *result, int data_size)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=4) {
+        __m128i ph = _mm_loadl_epi64((const __m128i*)data);
+        __m128 p = sse41_cvtph_ps(ph);
+        _mm_storeu_si128((__m128i*)result, _mm_castps_si128(p));
+
+        data += 4;
+        result += 4;
+    }
+
+    if (remainder) {
+        uint16_t in_buf[4] = {0};
+        uint32_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        __m128i ph = _mm_loadl_epi64((const __m128i*)&in_buf[0]);
+        __m128 p = sse41_cvtph_ps(ph);
+        _mm_storeu_si128((__m128i*)&out_buf[0], _mm_castps_si128(p));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+static inline __m128i cvtps_ph_sse41(__m128 a)
+{
+    __m128i denorm_magic = _mm_set1_epi32(((127u - 14u) + (23u - 10u)) << 23);
+
+    __m128i x_sgn = _mm_and_si128(_mm_castps_si128(a), _mm_set1_epi32(0x80000000u));
+    __m128i x =  _mm_andnot_si128(x_sgn, _mm_castps_si128(a));
+    __m128i x_shift = _mm_srli_epi32(x, 13);
+
+    __m128i subnormal_mask =  _mm_cmplt_epi32(x, _mm_set1_epi32(0x38800000u));
+    __m128i infnan_mask = _mm_cmpgt_epi32(x, _mm_set1_epi32(0x47800000u - 1));
+    __m128i nan_mask = _mm_cmpgt_epi32(x, _mm_set1_epi32(0x7f800000u));
+
+    __m128i mant_odd =_mm_and_si128(x_shift, _mm_set1_epi32(1));
+    __m128i norm = _mm_add_epi32(x, _mm_set1_epi32(((15u - 127u) << 23) + 0xfffu));
+    norm = _mm_add_epi32(norm, mant_odd);
+    norm = _mm_srli_epi32(norm, 13);
+
+    __m128i denorm = _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(denorm_magic), _mm_castsi128_ps(x)));
+    denorm = _mm_sub_epi32(denorm, denorm_magic);
+
+    __m128i nan = _mm_and_si128(x_shift, _mm_set1_epi32(0x03FFu));
+    nan = _mm_or_si128(nan, _mm_set1_epi32(0x7e00u));
+    nan = _mm_and_si128(nan, nan_mask);
+    __m128i inf = _mm_set1_epi32(0x7c00);
+    __m128i infnan = _mm_or_si128(inf, nan);
+
+    x = _mm_blendv_epi8(norm, denorm, subnormal_mask);
+    x = _mm_blendv_epi8(x, infnan, infnan_mask);
+
+    x_sgn = _mm_srli_epi32(x_sgn, 16);
+    x = _mm_or_si128(x, x_sgn);
+
+    // pack u16 values into lower 8 bytes
+    return _mm_packus_epi32(x, x);
+}
+
+static inline uint16_t to_f16(float v)
+{
+    __m128 ps =_mm_set1_ps(v);
+    __m128i ph = cvtps_ph_sse41(ps);
+
+    return (uint16_t)_mm_extract_epi16(ph, 0);
+}
+
+uint16_t f32_to_f16_ryg_sse41(float f)
+{
+    return to_f16(f);
+}
+
+void f32_to_f16_buffer_ryg_sse41(uint32_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 4 * 4;
+    int remainder = data_size - size;
+
+    for (int i = 0; i < size; i+=4) {
+        __m128 ps = _mm_loadu_ps((float*)data);
+        __m128i ph = cvtps_ph_sse41(ps);
+        _mm_storel_epi64((__m128i*)result, ph);
+
+        data += 4;
+        result += 4;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[4] = {0};
+        uint16_t out_buf[4] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        __m128 ps = _mm_loadu_ps((float*)&in_buf[0]);
+        __m128i ph = cvtps_ph_sse41(ps);
+         _mm_storel_epi64((__m128i*)&out_buf[0], ph);
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
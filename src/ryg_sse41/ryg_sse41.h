@@ -0,0 +1,7 @@
+#include <stdint.h>
+
+uint16_t f32_to_f16_ryg_sse41(float f);
+float f16_to_f32_ryg_sse41(uint16_t h);
+
+void f16_to_f32_buffer_ryg_sse41(uint16_t *data, uint32_t *result, int data_size);
+void f32_to_f16_buffer_ryg_sse41(uint32_t *data, uint16_t *result, int data_size);
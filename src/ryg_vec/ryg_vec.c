@@ -0,0 +1,83 @@
+#include "ryg_vec.h"
+#include <string.h>
+
+#if defined(HAVE_VECTOR_EXT)
+
+// https://fgiesen.wordpress.com/2012/03/28/half-to-float-done-quic/
+
+// same algorithm as ryg_sse2 but written with gcc/clang vector extensions
+// so the compiler picks the instructions for the target (sse, avx2, neon, sve...)
+
+typedef uint32_t vec_u32 __attribute__((vector_size(VEC_LANES * sizeof(uint32_t))));
+typedef float    vec_f32 __attribute__((vector_size(VEC_LANES * sizeof(float))));
+typedef uint16_t vec_u16 __attribute__((vector_size(VEC_LANES * sizeof(uint16_t))));
+
+static inline vec_u32 cvtph_ps_vec(vec_u16 a)
+{
+    vec_u32 h = __builtin_convertvector(a, vec_u32);
+
+    // exponent/mantissa bits
+    vec_u32 ou = (h & 0x7fffu) << 13;
+
+    // magic multiply, 0x1.0p+112f is (254 - 15) << 23
+    vec_f32 o = (vec_f32)ou * 0x1.0p+112f;
+    ou = (vec_u32)o;
+
+    // 65536.0f is (127 + 16) << 23, anything at or above it was inf/nan
+    vec_u32 nan_mask = (vec_u32)(o > 65536.0f);
+    vec_u32 inf_mask = (vec_u32)(ou == 0x47800000u);
+
+    vec_u32 ou_nan = nan_mask & (0x01FFu << 22);
+    vec_u32 ou_inf = inf_mask & (0x00FFu << 23);
+    vec_u32 sign = (h & 0x8000u) << 16;
+
+    return ou | sign | ou_nan | ou_inf;
+}
+
+float f16_to_f32_ryg_vec(uint16_t h)
+{
+    uint16_t src[VEC_LANES] = {h};
+    float dst[VEC_LANES];
+    vec_u16 a;
+
+    memcpy(&a, src, sizeof(a));
+    vec_u32 o = cvtph_ps_vec(a);
+    memcpy(dst, &o, sizeof(o));
+
+    return dst[0];
+}
+
+void f16_to_f32_buffer_ryg_vec(uint16_t *data, uint32_t *result, int data_size)
+{
+    int size = data_size / VEC_LANES * VEC_LANES;
+    int remainder = data_size - size;
+    vec_u16 a;
+    vec_u32 o;
+
+    for (int i = 0; i < size; i+=VEC_LANES) {
+        memcpy(&a, data, sizeof(a));
+        o = cvtph_ps_vec(a);
+        memcpy(result, &o, sizeof(o));
+
+        data += VEC_LANES;
+        result += VEC_LANES;
+    }
+
+    if (remainder) {
+        uint16_t in_buf[VEC_LANES] = {0};
+        uint32_t out_buf[VEC_LANES] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        memcpy(&a, in_buf, sizeof(a));
+        o = cvtph_ps_vec(a);
+        memcpy(out_buf, &o, sizeof(o));
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,5 @@
+#include <stdint.h>
+#include "../platform_info.h"
+
+float f16_to_f32_ryg_vec(uint16_t h);
+void f16_to_f32_buffer_ryg_vec(uint16_t *data, uint32_t *result, int data_size);
@@ -0,0 +1,53 @@
+#ifndef SPECIAL_VALUES_H
+#define SPECIAL_VALUES_H
+
+#include <stdint.h>
+
+// flags for the *_special conversions, applied to the f16 bits right after converting
+#define F16_SATURATE      (1 << 0) // +/-inf becomes +/-HALF_MAX
+#define F16_NAN_TO_ZERO   (1 << 1) // nan becomes +0, wins over F16_NAN_CANONICAL
+#define F16_NAN_CANONICAL (1 << 2) // nan becomes the quiet nan 0x7e00
+
+static inline uint16_t f16_fix_special(uint16_t h, int flags)
+{
+    uint16_t abs = h & 0x7FFF;
+    uint16_t nan_mask = -(uint16_t)(abs > 0x7C00);
+
+    // masks instead of branches, overflow and nan are common in real data
+    // 0x7c00 - 1 is HALF_MAX, the sign bit is left alone
+    if (flags & F16_SATURATE)
+        h -= (abs == 0x7C00);
+
+    if (flags & F16_NAN_TO_ZERO)
+        h &= ~nan_mask;
+    else if (flags & F16_NAN_CANONICAL)
+        h = (h & ~nan_mask) | (0x7E00 & nan_mask);
+
+    return h;
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+
+// same as f16_fix_special on 8 packed f16 values
+static inline __m128i f16_fix_special_sse2(__m128i ph, int flags)
+{
+    __m128i abs = _mm_and_si128(ph, _mm_set1_epi16(0x7FFF));
+    __m128i nan_mask = _mm_cmpgt_epi16(abs, _mm_set1_epi16(0x7C00));
+
+    if (flags & F16_SATURATE) {
+        __m128i inf_mask = _mm_cmpeq_epi16(abs, _mm_set1_epi16(0x7C00));
+        ph = _mm_add_epi16(ph, inf_mask);
+    }
+
+    if (flags & F16_NAN_TO_ZERO) {
+        ph = _mm_andnot_si128(nan_mask, ph);
+    } else if (flags & F16_NAN_CANONICAL) {
+        ph = _mm_or_si128(_mm_andnot_si128(nan_mask, ph), _mm_and_si128(nan_mask, _mm_set1_epi16(0x7E00)));
+    }
+
+    return ph;
+}
+#endif
+
+#endif // SPECIAL_VALUES_H
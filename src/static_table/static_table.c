@@ -0,0 +1,38 @@
+#include "static_table.h"
+#include "../half2float_table.h"
+
+typedef union {
+        uint32_t i;
+        float    f;
+} int_float;
+
+float f16_to_f32_static_table_func(uint16_t h)
+{
+    int_float v;
+    v.i = f16_to_f32_static_table[h];
+    return v.f;
+}
+
+void f16_to_f32_buffer_static_table(uint16_t *data, uint32_t *result, int data_size)
+{
+    for (int i =0; i < data_size; i++) {
+        result[i] = f16_to_f32_static_table[data[i]];
+    }
+}
+
+void f16_to_f64_buffer_static_table(uint16_t *data, uint64_t *result, int data_size)
+{
+    union { uint64_t u; double d; } value;
+
+    for (int i =0; i < data_size; i++) {
+        value.d = f16_to_f32_static_table_func(data[i]);
+        result[i] = value.u;
+    }
+}
+
+void f16_to_i32_buffer_static_table(uint16_t *data, int32_t *result, int data_size, float scale)
+{
+    for (int i =0; i < data_size; i++) {
+        result[i] = f32_to_i32_scaled(f16_to_f32_static_table_func(data[i]), scale);
+    }
+}
@@ -0,0 +1,13 @@
+#include <stdint.h>
+#include "../widen.h"
+
+// f16 to f32 lookup generated from hardware, used as the reference for half2float
+extern uint32_t f16_to_f32_static_table[];
+
+float f16_to_f32_static_table_func(uint16_t h);
+void f16_to_f32_buffer_static_table(uint16_t *data, uint32_t *result, int data_size);
+
+// exact half to double
+void f16_to_f64_buffer_static_table(uint16_t *data, uint64_t *result, int data_size);
+// half * scale to int32, see widen.h
+void f16_to_i32_buffer_static_table(uint16_t *data, int32_t *result, int data_size, float scale);
@@ -0,0 +1,72 @@
+#include "stochastic.h"
+
+typedef union {
+        uint32_t i;
+        float    f;
+} int_float;
+
+static uint64_t splitmix64(uint64_t *s)
+{
+    uint64_t z = (*s += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+void f16_stochastic_seed(F16StochasticState *state, uint64_t seed, uint64_t stream)
+{
+    uint64_t s = seed ^ (stream * 0xda942042e4dd58b5ull);
+
+    for (int i = 0; i < F16_STOCHASTIC_LANES; i++) {
+        uint32_t v = (uint32_t)(splitmix64(&s) >> 32);
+        // xorshift never leaves zero
+        state->lanes[i] = v ? v : 0x6d2b79f5u;
+    }
+}
+
+static inline uint32_t xorshift32(uint32_t x)
+{
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+static inline uint16_t to_f16_stochastic(uint32_t f, uint32_t r)
+{
+    int_float value;
+    uint32_t x = f & 0x7FFFFFFF;
+    uint16_t sign = (f >> 16) & 0x8000;
+    uint16_t h;
+
+    if (x > 0x7F800000) {
+        // quiet nan, keeps the payload like hardware
+        h = 0x7E00 | ((x >> 13) & 0x03FF);
+    } else if (x >= 0x47800000) {
+        h = 0x7C00;
+    } else if (x >= 0x38800000) {
+        // random 13 bits carry into the kept mantissa with probability discarded/2^13
+        h = (x - (112u << 23) + (r >> 19)) >> 13;
+    } else {
+        // denormals in units of 2^-24 are exact in float, round up if u < fraction
+        value.i = x;
+        float d = value.f * 16777216.0f;
+        uint32_t t = (uint32_t)d;
+        float frac = d - (float)t;
+        float u = (float)(r >> 9) * (1.0f / 8388608.0f);
+        h = t + (u < frac);
+    }
+
+    return h | sign;
+}
+
+void f32_to_f16_buffer_stochastic(F16StochasticState *state, uint32_t *data, uint16_t *result, int data_size)
+{
+    for (int i = 0; i < data_size; i += F16_STOCHASTIC_LANES) {
+        for (int j = 0; j < F16_STOCHASTIC_LANES; j++) {
+            state->lanes[j] = xorshift32(state->lanes[j]);
+            if (i + j < data_size)
+                result[i + j] = to_f16_stochastic(data[i + j], state->lanes[j]);
+        }
+    }
+}
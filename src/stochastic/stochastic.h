@@ -0,0 +1,20 @@
+#ifndef STOCHASTIC_H
+#define STOCHASTIC_H
+
+#include <stdint.h>
+
+// one xorshift32 generator per lane, the sse2 and avx2 kernels
+// both consume 8 lanes per step so every version gives the same output
+#define F16_STOCHASTIC_LANES 8
+
+typedef struct F16StochasticState {
+    uint32_t lanes[F16_STOCHASTIC_LANES];
+} F16StochasticState;
+
+// streams with the same seed are independent, use one per thread or image
+void f16_stochastic_seed(F16StochasticState *state, uint64_t seed, uint64_t stream);
+
+// portable version, rounds each value up with probability equal to the discarded fraction
+void f32_to_f16_buffer_stochastic(F16StochasticState *state, uint32_t *data, uint16_t *result, int data_size);
+
+#endif // STOCHASTIC_H
@@ -0,0 +1,81 @@
+#include "stochastic_avx2.h"
+#include <immintrin.h>
+
+// same rounding as f32_to_f16_buffer_stochastic, all 8 lanes in one vector
+
+static inline __m256i xorshift32_avx2(__m256i x)
+{
+    x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+    x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+    return x;
+}
+
+static inline __m128i cvtps_ph_stochastic_avx2(__m256 a, __m256i r)
+{
+    __m256i x_sgn = _mm256_and_si256(_mm256_castps_si256(a), _mm256_set1_epi32(0x80000000u));
+    __m256i x =  _mm256_andnot_si256(x_sgn, _mm256_castps_si256(a));
+
+    __m256i subnormal_mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(0x38800000u), x);
+    __m256i infnan_mask = _mm256_cmpgt_epi32(x, _mm256_set1_epi32(0x47800000u - 1));
+    __m256i nan_mask = _mm256_cmpgt_epi32(x, _mm256_set1_epi32(0x7f800000u));
+
+    // random 13 bits carry into the kept mantissa with probability discarded/2^13
+    __m256i norm = _mm256_add_epi32(x, _mm256_set1_epi32((15u - 127u) << 23));
+    norm = _mm256_add_epi32(norm, _mm256_srli_epi32(r, 19));
+    norm = _mm256_srli_epi32(norm, 13);
+
+    // denormals in units of 2^-24 are exact in float, round up if u < fraction
+    __m256 d = _mm256_mul_ps(_mm256_castsi256_ps(x), _mm256_set1_ps(16777216.0f));
+    __m256i t = _mm256_cvttps_epi32(d);
+    __m256 frac = _mm256_sub_ps(d, _mm256_cvtepi32_ps(t));
+    __m256 u = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(r, 9)), _mm256_set1_ps(1.0f / 8388608.0f));
+    __m256i denorm = _mm256_sub_epi32(t, _mm256_castps_si256(_mm256_cmp_ps(u, frac, _CMP_LT_OQ)));
+
+    __m256i nan = _mm256_and_si256(_mm256_srli_epi32(x, 13), _mm256_set1_epi32(0x03FFu));
+    nan = _mm256_or_si256(nan, _mm256_set1_epi32(0x7e00u));
+    nan = _mm256_and_si256(nan, nan_mask);
+    __m256i infnan = _mm256_or_si256(_mm256_set1_epi32(0x7c00), nan);
+
+    x = _mm256_blendv_epi8(norm, denorm, subnormal_mask);
+    x = _mm256_blendv_epi8(x, infnan, infnan_mask);
+    x = _mm256_or_si256(x, _mm256_srli_epi32(x_sgn, 16));
+
+    // every lane fits in 16 bits so the unsigned saturation never kicks in
+    return _mm_packus_epi32(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+}
+
+void f32_to_f16_buffer_stochastic_avx2(F16StochasticState *state, uint32_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    __m256i s = _mm256_loadu_si256((const __m256i*)&state->lanes[0]);
+
+    for (int i = 0; i < size; i+=8) {
+        s = xorshift32_avx2(s);
+        __m128i ph = cvtps_ph_stochastic_avx2(_mm256_loadu_ps((const float*)data), s);
+        _mm_storeu_si128((__m128i*)result, ph);
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[8] = {0};
+        uint16_t out_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        s = xorshift32_avx2(s);
+        __m128i ph = cvtps_ph_stochastic_avx2(_mm256_loadu_ps((const float*)&in_buf[0]), s);
+        _mm_storeu_si128((__m128i*)&out_buf[0], ph);
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+
+    _mm256_storeu_si256((__m256i*)&state->lanes[0], s);
+}
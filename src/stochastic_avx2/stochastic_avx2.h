@@ -0,0 +1,4 @@
+#include <stdint.h>
+#include "../stochastic/stochastic.h"
+
+void f32_to_f16_buffer_stochastic_avx2(F16StochasticState *state, uint32_t *data, uint16_t *result, int data_size);
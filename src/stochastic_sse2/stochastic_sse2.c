@@ -0,0 +1,104 @@
+#include "stochastic_sse2.h"
+#include <immintrin.h>
+
+// same rounding as f32_to_f16_buffer_stochastic, lanes 0-3 and 4-7 are two vectors
+
+static inline __m128i xorshift32_sse2(__m128i x)
+{
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+    return x;
+}
+
+static inline __m128i blendv_sse2(__m128i a, __m128i b, __m128i mask)
+{
+    return _mm_xor_si128(_mm_and_si128(_mm_xor_si128(a, b), mask), a);
+}
+
+// returns f16 values in the low 16 bits of each 32 bit lane
+static inline __m128i cvtps_ph_stochastic_sse2(__m128 a, __m128i r)
+{
+    __m128i x_sgn = _mm_and_si128(_mm_castps_si128(a), _mm_set1_epi32(0x80000000u));
+    __m128i x =  _mm_andnot_si128(x_sgn, _mm_castps_si128(a));
+
+    __m128i subnormal_mask =  _mm_cmplt_epi32(x, _mm_set1_epi32(0x38800000u));
+    __m128i infnan_mask = _mm_cmpgt_epi32(x, _mm_set1_epi32(0x47800000u - 1));
+    __m128i nan_mask = _mm_cmpgt_epi32(x, _mm_set1_epi32(0x7f800000u));
+
+    // random 13 bits carry into the kept mantissa with probability discarded/2^13
+    __m128i norm = _mm_add_epi32(x, _mm_set1_epi32((15u - 127u) << 23));
+    norm = _mm_add_epi32(norm, _mm_srli_epi32(r, 19));
+    norm = _mm_srli_epi32(norm, 13);
+
+    // denormals in units of 2^-24 are exact in float, round up if u < fraction
+    __m128 d = _mm_mul_ps(_mm_castsi128_ps(x), _mm_set1_ps(16777216.0f));
+    __m128i t = _mm_cvttps_epi32(d);
+    __m128 frac = _mm_sub_ps(d, _mm_cvtepi32_ps(t));
+    __m128 u = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(r, 9)), _mm_set1_ps(1.0f / 8388608.0f));
+    __m128i denorm = _mm_sub_epi32(t, _mm_castps_si128(_mm_cmplt_ps(u, frac)));
+
+    __m128i nan = _mm_and_si128(_mm_srli_epi32(x, 13), _mm_set1_epi32(0x03FFu));
+    nan = _mm_or_si128(nan, _mm_set1_epi32(0x7e00u));
+    nan = _mm_and_si128(nan, nan_mask);
+    __m128i infnan = _mm_or_si128(_mm_set1_epi32(0x7c00), nan);
+
+    x = blendv_sse2(norm, denorm, subnormal_mask);
+    x = blendv_sse2(x, infnan, infnan_mask);
+
+    return _mm_or_si128(x, _mm_srli_epi32(x_sgn, 16));
+}
+
+static inline __m128i pack_lo_sse2(__m128i x)
+{
+    // pack u16 values into lower 8 bytes
+    x = _mm_shufflehi_epi16(x, (1 << 6 | 1 << 4 | 2 << 2 | 0 << 0));
+    x = _mm_shufflelo_epi16(x, (1 << 6 | 1 << 4 | 2 << 2 | 0 << 0));
+    return _mm_shuffle_epi32(x, (1 << 6 | 1 << 4 | 2 << 2 | 0 << 0));
+}
+
+static inline __m128i cvt8_stochastic_sse2(const uint32_t *data, __m128i *s0, __m128i *s1)
+{
+    *s0 = xorshift32_sse2(*s0);
+    *s1 = xorshift32_sse2(*s1);
+
+    __m128i lo = cvtps_ph_stochastic_sse2(_mm_loadu_ps((const float*)data), *s0);
+    __m128i hi = cvtps_ph_stochastic_sse2(_mm_loadu_ps((const float*)data + 4), *s1);
+
+    return _mm_unpacklo_epi64(pack_lo_sse2(lo), pack_lo_sse2(hi));
+}
+
+void f32_to_f16_buffer_stochastic_sse2(F16StochasticState *state, uint32_t *data, uint16_t *result, int data_size)
+{
+    int size = data_size / 8 * 8;
+    int remainder = data_size - size;
+
+    __m128i s0 = _mm_loadu_si128((const __m128i*)&state->lanes[0]);
+    __m128i s1 = _mm_loadu_si128((const __m128i*)&state->lanes[4]);
+
+    for (int i = 0; i < size; i+=8) {
+        __m128i ph = cvt8_stochastic_sse2(data, &s0, &s1);
+        _mm_storeu_si128((__m128i*)result, ph);
+
+        data += 8;
+        result += 8;
+    }
+
+    if (remainder) {
+        uint32_t in_buf[8] = {0};
+        uint16_t out_buf[8] = {0};
+        for (int i = 0; i < remainder; i++) {
+            in_buf[i] = data[i];
+        }
+
+        __m128i ph = cvt8_stochastic_sse2(in_buf, &s0, &s1);
+        _mm_storeu_si128((__m128i*)&out_buf[0], ph);
+
+        for (int i = 0; i < remainder; i++) {
+            result[i] = out_buf[i];
+        }
+    }
+
+    _mm_storeu_si128((__m128i*)&state->lanes[0], s0);
+    _mm_storeu_si128((__m128i*)&state->lanes[4], s1);
+}
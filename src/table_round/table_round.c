@@ -72,6 +72,43 @@ static inline uint16_t to_f16(uint32_t f)
     return h;
 }
 
+// truncate, then round the magnitude up when the mode points away from zero
+static inline uint16_t to_f16_directed(uint32_t f, const int mode)
+{
+    uint16_t h;
+    const Float2HalfTables *t = &f2h_table;
+
+    int i = (f >> 23) & 0x01FF;
+    int shift = t->shifttable[i] >> 1;
+    uint32_t abs = f & 0x7FFFFFFF;
+    uint16_t sign = f >> 31;
+
+    uint16_t keep_nan = (abs > 0x7F800000) << 9;
+    // finite values past HALF_MAX
+    uint16_t overflow = (abs - 0x47800000u) < (0x7F800000u - 0x47800000u);
+    // any discarded bit makes the result inexact, inf and nan never are
+    uint16_t inexact = overflow | ((abs != 0) & (abs < 0x7F800000) & (((f | 0x00800000) & ((1u << shift) - 1)) != 0));
+    uint16_t away = mode == F16_ROUND_TO_POS_INF ? !sign :
+                    mode == F16_ROUND_TO_NEG_INF ? sign : 0;
+
+    h = t->basetable[i] + ((f & 0x007FFFFF) >> shift);
+
+    // overflow comes out of the table as inf, step back to HALF_MAX
+    h -= overflow;
+
+    // rounding HALF_MAX away from zero carries back into inf
+    h += inexact & away;
+
+    h |= keep_nan;
+    return h;
+}
+
+static inline void to_f16_directed_buffer(uint32_t *data, uint16_t *result, int data_size, const int mode)
+{
+    for (int i =0; i < data_size; i++) {
+        result[i] = to_f16_directed(data[i], mode);
+    }
+}
 
 void init_table_round()
 {
@@ -92,4 +129,45 @@ void f32_to_f16_buffer_table_round(uint32_t *data, uint16_t *result, int data_si
         value.i = data[i];
         result[i] = to_f16(value.i);
     }
-}
\ No newline at end of file
+}
+
+uint16_t f32_to_f16_table_round_mode(float f, int mode)
+{
+    int_float value;
+    value.f = f;
+
+    switch (mode) {
+        case F16_ROUND_TO_NEG_INF: return to_f16_directed(value.i, F16_ROUND_TO_NEG_INF);
+        case F16_ROUND_TO_POS_INF: return to_f16_directed(value.i, F16_ROUND_TO_POS_INF);
+        case F16_ROUND_TO_ZERO:    return to_f16_directed(value.i, F16_ROUND_TO_ZERO);
+        default:                   return to_f16(value.i);
+    }
+}
+
+void f32_to_f16_buffer_table_round_mode(uint32_t *data, uint16_t *result, int data_size, int mode)
+{
+    // pass the mode as a constant so each loop only has its own rounding code
+    switch (mode) {
+        case F16_ROUND_TO_NEG_INF: to_f16_directed_buffer(data, result, data_size, F16_ROUND_TO_NEG_INF); break;
+        case F16_ROUND_TO_POS_INF: to_f16_directed_buffer(data, result, data_size, F16_ROUND_TO_POS_INF); break;
+        case F16_ROUND_TO_ZERO:    to_f16_directed_buffer(data, result, data_size, F16_ROUND_TO_ZERO);    break;
+        default: f32_to_f16_buffer_table_round(data, result, data_size); break;
+    }
+}
+
+void f32_to_f16_buffer_table_round_special(uint32_t *data, uint16_t *result, int data_size, int flags)
+{
+    for (int i =0; i < data_size; i++) {
+        result[i] = f16_fix_special(to_f16(data[i]), flags);
+    }
+}
+
+void f32_to_f16_buffer_table_round_stats(uint32_t *data, uint16_t *result, int data_size, F16ConvertStats *stats)
+{
+    f16_stats_init(stats);
+
+    for (int i =0; i < data_size; i++) {
+        result[i] = to_f16(data[i]);
+        f16_stats_add(stats, data[i]);
+    }
+}
@@ -1,6 +1,19 @@
 #include <stdint.h>
+#include "../round_mode.h"
+#include "../special_values.h"
+#include "../convert_stats.h"
 
 void init_table_round();
 
 uint16_t f32_to_f16_table_round(float f);
-void f32_to_f16_buffer_table_round(uint32_t *data, uint16_t *result, int data_size);
\ No newline at end of file
+void f32_to_f16_buffer_table_round(uint32_t *data, uint16_t *result, int data_size);
+
+// mode is one of the F16_ROUND_TO_* values in round_mode.h
+uint16_t f32_to_f16_table_round_mode(float f, int mode);
+void f32_to_f16_buffer_table_round_mode(uint32_t *data, uint16_t *result, int data_size, int mode);
+
+// flags are F16_SATURATE, F16_NAN_TO_ZERO and F16_NAN_CANONICAL from special_values.h
+void f32_to_f16_buffer_table_round_special(uint32_t *data, uint16_t *result, int data_size, int flags);
+
+// same as the plain buffer function, stats is filled in from the same pass over data
+void f32_to_f16_buffer_table_round_stats(uint32_t *data, uint16_t *result, int data_size, F16ConvertStats *stats);
@@ -0,0 +1,18 @@
+#include "target_clones.h"
+
+const char *get_target_clone_name()
+{
+#if defined(HAVE_TARGET_CLONES)
+    // same priority the ifunc resolver uses
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return "avx512f";
+    if (__builtin_cpu_supports("avx2"))
+        return "avx2";
+    if (__builtin_cpu_supports("sse4.1"))
+        return "sse4.1";
+    return "default";
+#else
+    return "none";
+#endif
+}
@@ -0,0 +1,21 @@
+#ifndef TARGET_CLONES_H
+#define TARGET_CLONES_H
+
+// builds a copy of a function for each isa and picks one at load time,
+// lets us see what auto-vectorization gives the scalar kernels on one machine.
+// needs gcc/clang and ifunc support so only x86 linux for now
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__linux__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define HAVE_TARGET_CLONES
+#define TARGET_CLONES __attribute__((target_clones("default", "sse4.1", "avx2", "avx512f")))
+#endif
+#endif
+
+#ifndef TARGET_CLONES
+#define TARGET_CLONES
+#endif
+
+// name of the clone the loader dispatches to, "none" without multiversioning
+const char *get_target_clone_name();
+
+#endif // TARGET_CLONES_H
@@ -0,0 +1,227 @@
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
+#include "threads.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if _WIN32
+
+static DWORD WINAPI thread_entry(LPVOID arg)
+{
+    Thread *t = (Thread*)arg;
+    t->func(t->arg);
+    return 0;
+}
+
+int thread_create(Thread *t, thread_func func, void *arg)
+{
+    t->func = func;
+    t->arg = arg;
+    t->handle = CreateThread(NULL, 0, thread_entry, t, 0, NULL);
+    return t->handle ? 0 : -1;
+}
+
+void thread_join(Thread *t)
+{
+    WaitForSingleObject(t->handle, INFINITE);
+    CloseHandle(t->handle);
+}
+
+int thread_set_affinity(Thread *t, int cpu)
+{
+    if (cpu < 0 || cpu >= (int)(sizeof(DWORD_PTR) * 8))
+        return -1;
+    return SetThreadAffinityMask(t->handle, (DWORD_PTR)1 << cpu) ? 0 : -1;
+}
+
+int thread_set_affinity_self(int cpu)
+{
+    if (cpu < 0 || cpu >= (int)(sizeof(DWORD_PTR) * 8))
+        return -1;
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) ? 0 : -1;
+}
+
+// SetThreadAffinityMask is the only way to read the mask, set the process mask and put it back
+int thread_get_affinity_self(ThreadAffinity *affinity)
+{
+    DWORD_PTR process_mask;
+    DWORD_PTR system_mask;
+    DWORD_PTR old;
+
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+        return -1;
+
+    old = SetThreadAffinityMask(GetCurrentThread(), process_mask);
+    if (!old)
+        return -1;
+
+    SetThreadAffinityMask(GetCurrentThread(), old);
+    memset(affinity, 0, sizeof(*affinity));
+    affinity->mask[0] = old;
+    return 0;
+}
+
+int thread_restore_affinity_self(const ThreadAffinity *affinity)
+{
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)affinity->mask[0]) ? 0 : -1;
+}
+
+int get_cpu_count(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+}
+
+int get_cpu_sibling(int cpu)
+{
+    SYSTEM_LOGICAL_PROCESSOR_INFORMATION info[256];
+    DWORD size = sizeof(info);
+
+    if (!GetLogicalProcessorInformation(info, &size))
+        return -1;
+
+    for (DWORD i = 0; i < size / sizeof(info[0]); i++) {
+        ULONG_PTR mask = info[i].ProcessorMask;
+        if (info[i].Relationship != RelationProcessorCore || !(mask & ((ULONG_PTR)1 << cpu)))
+            continue;
+
+        for (int j = 0; j < (int)(sizeof(mask) * 8); j++) {
+            if (j != cpu && (mask & ((ULONG_PTR)1 << j)))
+                return j;
+        }
+    }
+    return -1;
+}
+
+#else
+#include <unistd.h>
+
+static void *thread_entry(void *arg)
+{
+    Thread *t = (Thread*)arg;
+    t->func(t->arg);
+    return NULL;
+}
+
+int thread_create(Thread *t, thread_func func, void *arg)
+{
+    t->func = func;
+    t->arg = arg;
+    return pthread_create(&t->handle, NULL, thread_entry, t) == 0 ? 0 : -1;
+}
+
+void thread_join(Thread *t)
+{
+    pthread_join(t->handle, NULL);
+}
+
+#if defined(__linux__)
+static int set_affinity(pthread_t handle, int cpu)
+{
+    cpu_set_t set;
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return -1;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(handle, sizeof(set), &set) == 0 ? 0 : -1;
+}
+
+int thread_get_affinity_self(ThreadAffinity *affinity)
+{
+    cpu_set_t set;
+
+    if (sizeof(set) > sizeof(affinity->mask) || pthread_getaffinity_np(pthread_self(), sizeof(set), &set))
+        return -1;
+
+    memset(affinity, 0, sizeof(*affinity));
+    memcpy(affinity->mask, &set, sizeof(set));
+    return 0;
+}
+
+int thread_restore_affinity_self(const ThreadAffinity *affinity)
+{
+    cpu_set_t set;
+
+    memcpy(&set, affinity->mask, sizeof(set));
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 ? 0 : -1;
+}
+#else
+// macOS only has affinity hints, let the scheduler decide
+static int set_affinity(pthread_t handle, int cpu)
+{
+    (void)handle;
+    (void)cpu;
+    return -1;
+}
+
+// nothing was pinned, so there is nothing to put back
+int thread_get_affinity_self(ThreadAffinity *affinity)
+{
+    (void)affinity;
+    return -1;
+}
+
+int thread_restore_affinity_self(const ThreadAffinity *affinity)
+{
+    (void)affinity;
+    return -1;
+}
+#endif
+
+int thread_set_affinity(Thread *t, int cpu)
+{
+    return set_affinity(t->handle, cpu);
+}
+
+int thread_set_affinity_self(int cpu)
+{
+    return set_affinity(pthread_self(), cpu);
+}
+
+int get_cpu_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+
+int get_cpu_sibling(int cpu)
+{
+#if defined(__linux__)
+    char path[128];
+    char buffer[128] = {0};
+    int sibling = -1;
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", cpu);
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+        return -1;
+
+    // list looks like "0,4" or "0-1"
+    if (fgets(buffer, sizeof(buffer), fp)) {
+        char *p = buffer;
+        while (*p) {
+            char *end;
+            long v = strtol(p, &end, 10);
+            if (end == p)
+                break;
+            if (v != cpu) {
+                sibling = (int)v;
+                break;
+            }
+            p = (*end) ? end + 1 : end;
+        }
+    }
+    fclose(fp);
+    return sibling;
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef THREADS_H
+#define THREADS_H
+
+#if _WIN32
+#include <windows.h>
+typedef HANDLE thread_handle;
+#else
+#include <pthread.h>
+typedef pthread_t thread_handle;
+#endif
+
+typedef void (*thread_func)(void *arg);
+
+// a flag one thread sets while another polls it
+#if _WIN32
+typedef volatile LONG thread_flag;
+
+static inline void thread_flag_set(thread_flag *flag, int value)
+{
+    InterlockedExchange(flag, value);
+}
+
+static inline int thread_flag_get(thread_flag *flag)
+{
+    return (int)InterlockedCompareExchange(flag, 0, 0);
+}
+#else
+#include <stdatomic.h>
+typedef atomic_int thread_flag;
+
+static inline void thread_flag_set(thread_flag *flag, int value)
+{
+    atomic_store_explicit(flag, value, memory_order_release);
+}
+
+static inline int thread_flag_get(thread_flag *flag)
+{
+    return atomic_load_explicit(flag, memory_order_acquire);
+}
+#endif
+
+// the cpus a thread may run on, room for 1024 of them
+typedef struct ThreadAffinity {
+    unsigned long long mask[16];
+} ThreadAffinity;
+
+typedef struct Thread {
+    thread_handle handle;
+    thread_func func;
+    void *arg;
+} Thread;
+
+int thread_create(Thread *t, thread_func func, void *arg);
+void thread_join(Thread *t);
+
+// pins a thread to a single logical cpu, returns 0 on success
+int thread_set_affinity(Thread *t, int cpu);
+int thread_set_affinity_self(int cpu);
+
+// saves the calling thread's affinity before pinning it, and puts it back. return 0 on success
+int thread_get_affinity_self(ThreadAffinity *affinity);
+int thread_restore_affinity_self(const ThreadAffinity *affinity);
+
+int get_cpu_count(void);
+
+// logical cpu sharing a physical core with cpu, or -1 if unknown
+int get_cpu_sibling(int cpu);
+
+#endif // THREADS_H
@@ -1,5 +1,6 @@
 
 #include "tursa.h"
+#include "../target_clones.h"
 // https://www.corsix.org/content/converting-fp32-to-fp16
 // https://github.com/nomovok-opensource/wrath/blob/3a8d8ee92f845ed96e95b3736a2a9deef4ac5e4c/src/3rd_party/ieeehalfprecision/ieeehalfprecision.c#L118-L156
 
@@ -57,7 +58,7 @@ uint16_t f32_to_f16_tursa(float f)
     return tursa_floatbits_to_halfbits(value.i);
 }
 
-void f32_to_f16_buffer_tursa(uint32_t *data, uint16_t *result, int data_size)
+TARGET_CLONES void f32_to_f16_buffer_tursa(uint32_t *data, uint16_t *result, int data_size)
 {
     int_float value;
     for (int i =0; i < data_size; i++) {
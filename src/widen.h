@@ -0,0 +1,45 @@
+#ifndef WIDEN_H
+#define WIDEN_H
+
+#include <stdint.h>
+
+// half to int32 is value * scale rounded to nearest even, nan becomes 0 and
+// anything past the int32 range saturates. scale 1.0 gives plain integers,
+// 32767.0 or 65535.0 gives normalized 16 bit style values.
+static inline int32_t f32_to_i32_scaled(float f, float scale)
+{
+    float v = f * scale;
+    float a = v < 0.0f ? -v : v;
+
+    if (v != v)
+        return 0;
+    if (v >= 2147483648.0f)
+        return INT32_MAX;
+    if (v <= -2147483648.0f)
+        return INT32_MIN;
+
+    // below 2^23 adding 2^23 pushes the fraction out with nearest even rounding,
+    // above it every float is already an integer. avoids needing libm for lrintf
+    if (a < 8388608.0f)
+        a = (a + 8388608.0f) - 8388608.0f;
+
+    return (int32_t)(v < 0.0f ? -a : a);
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+
+static inline __m128i cvtps_epi32_scaled_sse2(__m128 ps, __m128 scale)
+{
+    __m128 v = _mm_mul_ps(ps, scale);
+    // out of range and nan lanes come back as 0x80000000
+    __m128i r = _mm_cvtps_epi32(v);
+    __m128i too_big = _mm_castps_si128(_mm_cmpge_ps(v, _mm_set1_ps(2147483648.0f)));
+    __m128i is_nan = _mm_castps_si128(_mm_cmpunord_ps(v, v));
+
+    r = _mm_xor_si128(r, too_big);
+    return _mm_andnot_si128(is_nan, r);
+}
+#endif
+
+#endif // WIDEN_H
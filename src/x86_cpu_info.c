@@ -29,20 +29,25 @@ static inline int64_t xgetbv()
 #endif
 }
 
-static inline void cpuid(int index, int *data)
+static inline void cpuid_subleaf(int index, int subleaf, int *data)
 {
 #if _MSC_VER
-    __cpuid(data, index);
+    __cpuidex(data, index, subleaf);
 #else
     __asm__ volatile (
         "mov    %%rbx, %%rsi \n\t"
         "cpuid               \n\t"
         "xchg   %%rbx, %%rsi"
         : "=a" (data[0]), "=S" (data[1]), "=c" (data[2]), "=d" (data[3])
-        : "0" (index), "2"(0));
+        : "0" (index), "2"(subleaf));
 #endif
 }
 
+static inline void cpuid(int index, int *data)
+{
+    cpuid_subleaf(index, 0, data);
+}
+
 
 #define ADD_FLAG_STR(ext_flag, name) \
 if (out->flags & ext_flag) {         \
@@ -63,6 +68,7 @@ static void make_extensions_string(CPUInfo *out)
     ADD_FLAG_STR(X86_CPU_FLAG_AVX,   "+avx")
     ADD_FLAG_STR(X86_CPU_FLAG_AVX2,  "+avx2")
     ADD_FLAG_STR(X86_CPU_FLAG_F16C,  "+f16c")
+    ADD_FLAG_STR(X86_CPU_FLAG_AVX512BF16, "+avx512bf16")
 }
 
 void get_cpu_info(CPUInfo *out)
@@ -130,6 +136,13 @@ void get_cpu_info(CPUInfo *out)
             if ((flags & X86_CPU_FLAG_AVX2) && (info.reg.ebx & 0xd0030000))
                 flags |= X86_CPU_FLAG_AVX512;
         }
+
+        /* subleaf 1 eax bit 5 is AVX512_BF16 */
+        if ((flags & X86_CPU_FLAG_AVX512) && info.reg.eax >= 1) {
+            cpuid_subleaf(7, 1, info.i);
+            if (info.reg.eax & 0x00000020)
+                flags |= X86_CPU_FLAG_AVX512BF16;
+        }
     }
 
     cpuid(0x80000000, info.i);
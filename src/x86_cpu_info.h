@@ -23,6 +23,8 @@
 
 #define X86_CPU_FLAG_F16C            (1 << 13) // CPU Has FP16C half float, AVX2 should always have this??
 
+#define X86_CPU_FLAG_AVX512BF16      (1 << 14) // AVX-512 bfloat16 conversions (vcvtneps2bf16)
+
 typedef struct CPUInfo
 {
     unsigned int flags;